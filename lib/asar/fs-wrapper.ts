@@ -611,11 +611,20 @@ export const wrapFsWithAsar = (fs: Record<string, any>) => {
     }
 
     const { encoding } = options;
+    logASARAccess(asarPath, filePath, info.offset);
+
+    if (encoding === 'utf8' || encoding === 'utf-8') {
+      const str = archive.readMappedFile(filePath, true);
+      if (str !== false) return str;
+    } else {
+      const mapped = archive.readMappedFile(filePath, false);
+      if (mapped !== false) return (encoding) ? mapped.toString(encoding) : mapped;
+    }
+
     const buffer = Buffer.alloc(info.size);
     const fd = archive.getFdAndValidateIntegrityLater();
     if (!(fd >= 0)) throw createError(AsarError.NOT_FOUND, { asarPath, filePath });
 
-    logASARAccess(asarPath, filePath, info.offset);
     fs.readSync(fd, buffer, 0, info.size, info.offset);
     validateBufferIntegrity(buffer, info.integrity);
     return (encoding) ? buffer.toString(encoding) : buffer;
@@ -730,11 +739,14 @@ export const wrapFsWithAsar = (fs: Record<string, any>) => {
       return [str, str.length > 0];
     }
 
+    logASARAccess(asarPath, filePath, info.offset);
+    const mapped = archive.readMappedFile(filePath, true);
+    if (mapped !== false) return [mapped, mapped.length > 0];
+
     const buffer = Buffer.alloc(info.size);
     const fd = archive.getFdAndValidateIntegrityLater();
     if (!(fd >= 0)) return [];
 
-    logASARAccess(asarPath, filePath, info.offset);
     fs.readSync(fd, buffer, 0, info.size, info.offset);
     validateBufferIntegrity(buffer, info.integrity);
     const str = buffer.toString('utf8');
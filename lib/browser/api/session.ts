@@ -1,10 +1,19 @@
 import { fetchWithSession } from '@electron/internal/browser/api/net-fetch';
+import { clearPreloadCodeCaches } from '@electron/internal/browser/preload-code-cache';
 const { fromPartition, fromPath, Session } = process._linkedBinding('electron_browser_session');
 
 Session.prototype.fetch = function (input: RequestInfo, init?: RequestInit) {
   return fetchWithSession(input, init, this);
 };
 
+const clearCodeCaches = Session.prototype.clearCodeCaches;
+Session.prototype.clearCodeCaches = async function (options: { urls?: string[] }) {
+  await clearCodeCaches.call(this, options);
+  // The code caches of preload scripts are not kept for URLs, so they only go
+  // when the whole cache does.
+  if (!options?.urls?.length) await clearPreloadCodeCaches(this);
+};
+
 export default {
   fromPartition,
   fromPath,
@@ -129,7 +129,7 @@ class ForkUtilityProcess extends EventEmitter {
     return this.#stderr;
   }
 
-  postMessage (message: any, transfer?: MessagePortMain[]) {
+  postMessage (message: any, transfer?: (MessagePortMain | ArrayBuffer)[]) {
     if (Array.isArray(transfer)) {
       transfer = transfer.map((o: any) => o instanceof MessagePortMain ? o._internalPort : o);
       return this.#handle?.postMessage(message, transfer);
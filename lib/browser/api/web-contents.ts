@@ -123,6 +123,15 @@ const binding = process._linkedBinding('electron_browser_web_contents');
 const printing = process._linkedBinding('electron_browser_printing');
 const { WebContents } = binding as { WebContents: { prototype: Electron.WebContents } };
 
+// Mirror the invoke handlers of the global ipc objects into the routing table
+// WebContents::Invoke looks channels up in.
+(ipcMain as unknown as IpcMainImpl)._observeInvokeHandlers((channel, registered) => {
+  binding._setGlobalInvokeHandlerRegistered(false, channel, registered);
+});
+(ipcMainInternal as unknown as IpcMainImpl)._observeInvokeHandlers((channel, registered) => {
+  binding._setGlobalInvokeHandlerRegistered(true, channel, registered);
+});
+
 WebContents.prototype.postMessage = function (...args) {
   return this.mainFrame.postMessage(...args);
 };
@@ -135,6 +144,10 @@ WebContents.prototype._sendInternal = function (channel, ...args) {
   return this.mainFrame._sendInternal(channel, ...args);
 };
 
+WebContents.prototype.forward = function (channel, message) {
+  return this.mainFrame.forward(channel, message);
+};
+
 function getWebFrame (contents: Electron.WebContents, frame: number | [number, number]) {
   if (typeof frame === 'number') {
     return webFrameMain.fromId(contents.mainFrame.processId, frame);
@@ -589,45 +602,101 @@ WebContents.prototype._init = function () {
   this._windowOpenHandler = null;
 
   const ipc = new IpcMainImpl();
+  ipc._observeInvokeHandlers((channel, registered) => {
+    if (!this.isDestroyed()) this._setInvokeHandlerRegistered(channel, registered);
+  });
   Object.defineProperty(this, 'ipc', {
     get () { return ipc; },
     enumerable: true
   });
 
   // Dispatch IPC messages to the ipc module.
-  this.on('-ipc-message' as any, function (this: Electron.WebContents, event: Electron.IpcMainEvent, internal: boolean, channel: string, args: any[]) {
-    addSenderToEvent(event, this);
+  // Large messages arrive still serialized. They are passed as they are to
+  // the listeners of channels with lazy deserialization, and only decoded when
+  // there is some other listener for them.
+  const dispatchMessage = (contents: Electron.WebContents, event: Electron.IpcMainEvent, internal: boolean, channel: string, args: any[] | Electron.SerializedMessage) => {
+    addSenderToEvent(event, contents);
+    const emitTo = (emitter: IpcMainImpl) => {
+      if (Array.isArray(args)) {
+        emitter.emit(channel, event, ...args);
+      } else if (emitter._isLazyDeserializationChannel(channel)) {
+        emitter.emit(channel, event, args);
+      } else if (emitter.listenerCount(channel) > 0) {
+        emitter.emit(channel, event, ...args.args);
+      }
+    };
     if (internal) {
-      ipcMainInternal.emit(channel, event, ...args);
+      ipcMainInternal.emit(channel, event, ...(Array.isArray(args) ? args : args.args));
     } else {
       addReplyToEvent(event);
-      this.emit('ipc-message', event, channel, ...args);
+      if (contents.listenerCount('ipc-message') > 0) {
+        contents.emit('ipc-message', event, channel, ...(Array.isArray(args) ? args : args.args));
+      }
       const maybeWebFrame = getWebFrameForEvent(event);
-      maybeWebFrame && maybeWebFrame.ipc.emit(channel, event, ...args);
-      ipc.emit(channel, event, ...args);
-      ipcMain.emit(channel, event, ...args);
+      maybeWebFrame && emitTo(maybeWebFrame.ipc as IpcMainImpl);
+      emitTo(ipc);
+      emitTo(ipcMain as IpcMainImpl);
+    }
+  };
+
+  this.on('-ipc-message' as any, function (this: Electron.WebContents, event: Electron.IpcMainEvent, internal: boolean, channel: string, args: any[] | Electron.SerializedMessage) {
+    dispatchMessage(this, event, internal, channel, args);
+  });
+
+  // Messages the renderer sent during one task arrive together, in order. A
+  // listener that throws must not keep the messages after it from being
+  // delivered, as it would not have had they arrived one by one.
+  this.on('-ipc-message-batch' as any, function (this: Electron.WebContents, messages: { event: Electron.IpcMainEvent, internal: boolean, channel: string, args: any[] | Electron.SerializedMessage }[]) {
+    for (const { event, internal, channel, args } of messages) {
+      try {
+        dispatchMessage(this, event, internal, channel, args);
+      } catch (error) {
+        process.nextTick(() => { throw error; });
+      }
     }
   });
 
-  this.on('-ipc-invoke' as any, async function (this: Electron.WebContents, event: Electron.IpcMainInvokeEvent, internal: boolean, channel: string, args: any[]) {
+  // WebContents::Invoke has already looked up which ipc object has a handler
+  // for |channel|, and answered calls of channels without one itself. The call
+  // is answered through _replyToInvoke(id), so the event is a plain object
+  // rather than a native Event with a reply channel.
+  this.on('-ipc-invoke' as any, async function (this: Electron.WebContents, id: number, processId: number, frameId: number, internal: boolean, channel: string, args: any[], target: 'internal' | 'frame' | 'contents' | 'main') {
+    const event = {
+      processId,
+      frameId,
+      defaultPrevented: false,
+      preventDefault () { this.defaultPrevented = true; }
+    } as Electron.IpcMainInvokeEvent;
     addSenderToEvent(event, this);
-    const replyWithResult = (result: any) => event._replyChannel.sendReply({ result });
+    const reply = (value: { result: any } | { error: string }) => {
+      if (!this.isDestroyed()) this._replyToInvoke(id, value);
+    };
     const replyWithError = (error: Error) => {
       console.error(`Error occurred in handler for '${channel}':`, error);
-      event._replyChannel.sendReply({ error: error.toString() });
+      reply({ error: error.toString() });
     };
-    const maybeWebFrame = getWebFrameForEvent(event);
-    const targets: (ElectronInternal.IpcMainInternal| undefined)[] = internal ? [ipcMainInternal] : [maybeWebFrame?.ipc, ipc, ipcMain];
-    const target = targets.find(target => target && (target as any)._invokeHandlers.has(channel));
-    if (target) {
-      const handler = (target as any)._invokeHandlers.get(channel);
-      try {
-        replyWithResult(await Promise.resolve(handler(event, ...args)));
-      } catch (err) {
-        replyWithError(err as Error);
-      }
-    } else {
+    const targets = {
+      internal: () => ipcMainInternal,
+      frame: () => getWebFrameForEvent(event)?.ipc,
+      contents: () => ipc,
+      main: () => ipcMain
+    };
+    const handler = (targets[target]?.() as any)?._invokeHandlers.get(channel);
+    if (!handler) {
       replyWithError(new Error(`No handler registered for '${channel}'`));
+      return;
+    }
+    let result;
+    try {
+      result = await Promise.resolve(handler(event, ...args));
+    } catch (err) {
+      replyWithError(err as Error);
+      return;
+    }
+    try {
+      reply({ result });
+    } catch (err) {
+      replyWithError(err as Error);
     }
   });
 
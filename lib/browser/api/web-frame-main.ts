@@ -6,6 +6,7 @@ const { WebFrameMain, fromId } = process._linkedBinding('electron_browser_web_fr
 Object.defineProperty(WebFrameMain.prototype, 'ipc', {
   get () {
     const ipc = new IpcMainImpl();
+    ipc._observeInvokeHandlers((channel, registered) => this._setInvokeHandlerRegistered(channel, registered));
     Object.defineProperty(this, 'ipc', { value: ipc });
     return ipc;
   }
@@ -1,8 +1,16 @@
 import { EventEmitter } from 'events';
 import { IpcMainInvokeEvent } from 'electron/main';
+import { createWorkerHandler } from '@electron/internal/browser/ipc-main-worker';
+
+const { _isSerializedMessage } = process._linkedBinding('electron_browser_web_contents');
+
+type InvokeHandlersObserver = (channel: string, registered: boolean) => void;
 
 export class IpcMainImpl extends EventEmitter {
   private _invokeHandlers: Map<string, (e: IpcMainInvokeEvent, ...args: any[]) => void> = new Map();
+  private _invokeHandlersObserver?: InvokeHandlersObserver;
+  private _workerHandlerReleases: Map<string, () => void> = new Map();
+  private _lazyDeserializationChannels: Set<string> = new Set();
 
   constructor () {
     super();
@@ -19,6 +27,7 @@ export class IpcMainImpl extends EventEmitter {
       throw new Error(`Expected handler to be a function, but found type '${typeof fn}'`);
     }
     this._invokeHandlers.set(method, fn);
+    this._invokeHandlersObserver?.(method, true);
   };
 
   handleOnce: Electron.IpcMain['handleOnce'] = (method, fn) => {
@@ -28,7 +37,49 @@ export class IpcMainImpl extends EventEmitter {
     });
   };
 
+  handleInWorker: Electron.IpcMain['handleInWorker'] = (method, modulePath) => {
+    if (typeof modulePath !== 'string') {
+      throw new Error(`Expected modulePath to be a string, but found type '${typeof modulePath}'`);
+    }
+    if (this._invokeHandlers.has(method)) {
+      throw new Error(`Attempted to register a second handler for '${method}'`);
+    }
+    const { handler, release } = createWorkerHandler(method, modulePath);
+    this._workerHandlerReleases.set(method, release);
+    this.handle(method, handler);
+  };
+
   removeHandler (method: string) {
-    this._invokeHandlers.delete(method);
+    this._workerHandlerReleases.get(method)?.();
+    this._workerHandlerReleases.delete(method);
+    if (this._invokeHandlers.delete(method)) {
+      this._invokeHandlersObserver?.(method, false);
+    }
+  }
+
+  setLazyDeserialization (channel: string, enabled: boolean) {
+    if (enabled) {
+      this._lazyDeserializationChannels.add(channel);
+    } else {
+      this._lazyDeserializationChannels.delete(channel);
+    }
+  }
+
+  isSerializedMessage (value: unknown): value is Electron.SerializedMessage {
+    return _isSerializedMessage(value);
+  }
+
+  _isLazyDeserializationChannel (channel: string) {
+    return this._lazyDeserializationChannels.has(channel);
+  }
+
+  // Tells |observer| about every channel a handler is registered for, now and
+  // whenever one is added or removed, so that the browser can route invoke()
+  // calls natively.
+  _observeInvokeHandlers (observer: InvokeHandlersObserver) {
+    this._invokeHandlersObserver = observer;
+    for (const channel of this._invokeHandlers.keys()) {
+      observer(channel, true);
+    }
   }
 }
@@ -0,0 +1,114 @@
+import * as path from 'path';
+import { Worker } from 'worker_threads';
+
+type InvokeEvent = {
+  channel: string;
+  processId: number;
+  frameId: number;
+  senderId?: number;
+};
+
+type PendingInvoke = {
+  resolve: (result: any) => void;
+  reject: (error: Error) => void;
+};
+
+// Runs in the worker, from its source text, so it can not refer to anything
+// outside of itself.
+function ipcWorkerMain () {
+  const { parentPort, workerData } = __non_webpack_require__('worker_threads');
+  const handlers = __non_webpack_require__(workerData.modulePath);
+  parentPort.on('message', async ({ id, event, args }: { id: number, event: InvokeEvent, args: any[] }) => {
+    try {
+      const handler = typeof handlers === 'function' ? handlers : handlers?.[event.channel];
+      if (typeof handler !== 'function') {
+        throw new Error(`'${workerData.modulePath}' exports no handler for '${event.channel}'`);
+      }
+      parentPort.postMessage({ id, result: await handler(event, ...args) });
+    } catch (error) {
+      parentPort.postMessage({ id, error: error instanceof Error ? error : new Error(String(error)) });
+    }
+  });
+}
+
+class IpcWorker {
+  private worker: Worker | null = null;
+  private pending = new Map<number, PendingInvoke>();
+  private nextId = 0;
+  refCount = 0;
+
+  constructor (private modulePath: string) {
+    this.start();
+  }
+
+  private start () {
+    const worker = new Worker(`(${ipcWorkerMain})()`, { eval: true, workerData: { modulePath: this.modulePath } });
+    // Handlers must not keep the app from quitting.
+    worker.unref();
+    worker.on('message', ({ id, result, error }) => {
+      const pending = this.pending.get(id);
+      if (!pending) return;
+      this.pending.delete(id);
+      if (error) pending.reject(error);
+      else pending.resolve(result);
+    });
+    worker.on('error', (error) => this.rejectAll(error));
+    worker.on('exit', (code) => {
+      if (this.worker === worker) this.worker = null;
+      this.rejectAll(new Error(`The worker running '${this.modulePath}' exited with code ${code}`));
+    });
+    this.worker = worker;
+  }
+
+  private rejectAll (error: Error) {
+    for (const { reject } of this.pending.values()) reject(error);
+    this.pending.clear();
+  }
+
+  invoke (event: InvokeEvent, args: any[]) {
+    // A worker that exited, e.g. after an uncaught exception, is replaced on
+    // the next call.
+    if (!this.worker) this.start();
+    const id = this.nextId++;
+    return new Promise<any>((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+      this.worker!.postMessage({ id, event, args });
+    });
+  }
+
+  terminate () {
+    this.worker?.terminate();
+  }
+}
+
+// Handlers from the same module share a worker.
+const workers = new Map<string, IpcWorker>();
+
+// Returns a handler that runs invoke() calls in a worker thread which loads
+// |modulePath|, along with a function that releases it. The worker is
+// terminated once every handler using it has been released.
+export function createWorkerHandler (channel: string, modulePath: string) {
+  modulePath = path.resolve(modulePath);
+  const worker = workers.get(modulePath) ?? new IpcWorker(modulePath);
+  workers.set(modulePath, worker);
+  worker.refCount++;
+
+  const handler = (event: Electron.IpcMainInvokeEvent, ...args: any[]) => {
+    return worker.invoke({
+      channel,
+      processId: event.processId,
+      frameId: event.frameId,
+      senderId: event.sender?.id
+    }, args);
+  };
+  let released = false;
+  const release = () => {
+    if (released) return;
+    released = true;
+    if (--worker.refCount === 0) {
+      workers.delete(modulePath);
+      worker.terminate();
+    }
+  };
+  return { handler, release };
+}
@@ -0,0 +1,59 @@
+import * as crypto from 'crypto';
+import * as fs from 'fs';
+import * as path from 'path';
+
+// V8 code caches of sandboxed preload scripts, stored next to the session's
+// code cache, or in memory for in-memory sessions. The caches are produced by
+// renderers, which are not trusted, so they are keyed by the site the renderer
+// is locked to as well as by a hash of the script and the V8 version: a cache
+// is only ever handed to renderers of the site that produced it. V8 itself
+// rejects caches that do not match the flags of the renderer.
+const inMemoryPreloadCodeCaches = new WeakMap<Electron.Session, Map<string, Buffer>>();
+
+const getPreloadCodeCacheDir = (session: Electron.Session) => {
+  const codeCachePath = session._getCodeCachePath();
+  return codeCachePath ? path.join(codeCachePath, 'preload') : null;
+};
+
+export const getPreloadCodeCacheKey = (processLock: string, preloadSrc: string) => {
+  return crypto.createHash('sha256')
+    .update(process.versions.v8).update('\0')
+    .update(processLock).update('\0')
+    .update(preloadSrc)
+    .digest('hex');
+};
+
+export const readPreloadCodeCache = async (session: Electron.Session, key: string) => {
+  const dir = getPreloadCodeCacheDir(session);
+  if (!dir) return inMemoryPreloadCodeCaches.get(session)?.get(key) ?? null;
+  try {
+    return await fs.promises.readFile(path.join(dir, key));
+  } catch {
+    return null;
+  }
+};
+
+export const writePreloadCodeCache = async (session: Electron.Session, key: string, codeCache: Buffer) => {
+  const dir = getPreloadCodeCacheDir(session);
+  if (!dir) {
+    if (!inMemoryPreloadCodeCaches.has(session)) inMemoryPreloadCodeCaches.set(session, new Map());
+    inMemoryPreloadCodeCaches.get(session)!.set(key, codeCache);
+    return;
+  }
+  // Write to a temporary file first so that concurrent readers never see a
+  // partial cache.
+  const tmpPath = path.join(dir, `${key}.${process.pid}.${crypto.randomUUID()}.tmp`);
+  try {
+    await fs.promises.mkdir(dir, { recursive: true });
+    await fs.promises.writeFile(tmpPath, codeCache);
+    await fs.promises.rename(tmpPath, path.join(dir, key));
+  } catch {
+    await fs.promises.rm(tmpPath, { force: true });
+  }
+};
+
+export const clearPreloadCodeCaches = async (session: Electron.Session) => {
+  inMemoryPreloadCodeCaches.delete(session);
+  const dir = getPreloadCodeCacheDir(session);
+  if (dir) await fs.promises.rm(dir, { recursive: true, force: true });
+};
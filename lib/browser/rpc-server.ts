@@ -3,6 +3,7 @@ import * as fs from 'fs';
 import { ipcMainInternal } from '@electron/internal/browser/ipc-main-internal';
 import * as ipcMainUtils from '@electron/internal/browser/ipc-main-internal-utils';
 import { IPC_MESSAGES } from '@electron/internal/common/ipc-messages';
+import { getPreloadCodeCacheKey, readPreloadCodeCache, writePreloadCodeCache } from '@electron/internal/browser/preload-code-cache';
 
 // Implements window.close()
 ipcMainInternal.on(IPC_MESSAGES.BROWSER_WINDOW_CLOSE, function (event) {
@@ -41,22 +42,37 @@ ipcMainUtils.handleSync(IPC_MESSAGES.BROWSER_CLIPBOARD_SYNC, function (event, me
   return (clipboard as any)[method](...args);
 });
 
-const getPreloadScript = async function (preloadPath: string) {
+// The cache keys handed out to each frame for scripts that it has to produce a
+// code cache for, along with the process lock they were made for. Caches are
+// only accepted for these, from a frame whose process still has that lock.
+const pendingPreloadCodeCaches = new WeakMap<Electron.WebFrameMain, Map<string, { processLock: string | null, key: string | null }>>();
+
+const getPreloadScript = async function (contents: Electron.WebContents, frame: Electron.WebFrameMain | null, preloadPath: string) {
   let preloadSrc = null;
   let preloadError = null;
+  let preloadCodeCache = null;
   try {
     preloadSrc = await fs.promises.readFile(preloadPath, 'utf8');
+    if (frame) {
+      // Renderers whose process may host other sites as well do not use the
+      // cache, as their caches could end up in renderers of any of those sites.
+      const processLock = frame._getProcessLock();
+      const key = processLock ? getPreloadCodeCacheKey(processLock, preloadSrc) : null;
+      if (key) preloadCodeCache = await readPreloadCodeCache(contents.session, key);
+      if (!pendingPreloadCodeCaches.has(frame)) pendingPreloadCodeCaches.set(frame, new Map());
+      pendingPreloadCodeCaches.get(frame)!.set(preloadPath, { processLock, key });
+    }
   } catch (error) {
     preloadError = error;
   }
-  return { preloadPath, preloadSrc, preloadError };
+  return { preloadPath, preloadSrc, preloadError, preloadCodeCache };
 };
 
 ipcMainUtils.handleSync(IPC_MESSAGES.BROWSER_SANDBOX_LOAD, async function (event) {
   const preloadPaths = event.sender._getPreloadPaths();
 
   return {
-    preloadScripts: await Promise.all(preloadPaths.map(path => getPreloadScript(path))),
+    preloadScripts: await Promise.all(preloadPaths.map(preloadPath => getPreloadScript(event.sender, event.senderFrame, preloadPath))),
     process: {
       arch: process.arch,
       platform: process.platform,
@@ -75,3 +91,15 @@ ipcMainUtils.handleSync(IPC_MESSAGES.BROWSER_NONSANDBOX_LOAD, function (event) {
 ipcMainInternal.on(IPC_MESSAGES.BROWSER_PRELOAD_ERROR, function (event, preloadPath: string, error: Error) {
   event.sender.emit('preload-error', event, preloadPath, error);
 });
+
+ipcMainInternal.on(IPC_MESSAGES.BROWSER_PRELOAD_CODE_CACHE, function (event, preloadPath: string, result: string, codeCache: Uint8Array | null) {
+  const frame = event.senderFrame;
+  const pending = frame && pendingPreloadCodeCaches.get(frame)?.get(preloadPath);
+  if (!frame || !pending) return;
+  pendingPreloadCodeCaches.get(frame)!.delete(preloadPath);
+  if (pending.key && codeCache instanceof Uint8Array && codeCache.length > 0 &&
+      frame._getProcessLock() === pending.processLock) {
+    writePreloadCodeCache(event.sender.session, pending.key, Buffer.from(codeCache));
+  }
+  event.sender.emit('preload-code-cache', event, preloadPath, result);
+});
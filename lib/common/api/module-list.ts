@@ -1,5 +1,6 @@
 // Common modules, please sort alphabetically
 export const commonModuleList: ElectronInternal.ModuleEntry[] = [
   { name: 'nativeImage', loader: () => require('./native-image') },
+  { name: 'sharedRingBuffer', loader: () => require('./shared-ring-buffer') },
   { name: 'shell', loader: () => require('./shell') }
 ];
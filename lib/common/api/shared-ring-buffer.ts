@@ -0,0 +1,3 @@
+const { sharedRingBuffer } = process._linkedBinding('electron_common_shared_ring_buffer');
+
+export default sharedRingBuffer;
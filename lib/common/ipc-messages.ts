@@ -2,6 +2,7 @@ export const enum IPC_MESSAGES {
   BROWSER_CLIPBOARD_SYNC = 'BROWSER_CLIPBOARD_SYNC',
   BROWSER_GET_LAST_WEB_PREFERENCES = 'BROWSER_GET_LAST_WEB_PREFERENCES',
   BROWSER_PRELOAD_ERROR = 'BROWSER_PRELOAD_ERROR',
+  BROWSER_PRELOAD_CODE_CACHE = 'BROWSER_PRELOAD_CODE_CACHE',
   BROWSER_SANDBOX_LOAD = 'BROWSER_SANDBOX_LOAD',
   BROWSER_NONSANDBOX_LOAD = 'BROWSER_NONSANDBOX_LOAD',
   BROWSER_WINDOW_CLOSE = 'BROWSER_WINDOW_CLOSE',
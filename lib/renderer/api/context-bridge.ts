@@ -12,6 +12,14 @@ const contextBridge: Electron.ContextBridge = {
   exposeInIsolatedWorld: (worldId: number, key: string, api: any) => {
     checkContextIsolationEnabled();
     return binding.exposeAPIInWorld(worldId, key, api);
+  },
+  shareArrayBuffer: <T extends ArrayBuffer | ArrayBufferView>(buffer: T): T => {
+    binding.setArrayBufferMode(buffer, 'share');
+    return buffer;
+  },
+  transferArrayBuffer: <T extends ArrayBuffer | ArrayBufferView>(buffer: T): T => {
+    binding.setArrayBufferMode(buffer, 'transfer');
+    return buffer;
   }
 };
 
@@ -13,6 +13,10 @@ ipcRenderer.sendSync = function (channel, ...args) {
   return ipc.sendSync(internal, channel, args);
 };
 
+ipcRenderer.sendSyncWithOptions = function (channel, options, ...args) {
+  return ipc.sendSync(internal, channel, args, options);
+};
+
 ipcRenderer.sendToHost = function (channel, ...args) {
   return ipc.sendToHost(channel, args);
 };
@@ -7,7 +7,8 @@ import type * as ipcRendererInternalModule from '@electron/internal/renderer/ipc
 declare const binding: {
   get: (name: string) => any;
   process: NodeJS.Process;
-  createPreloadScript: (src: string) => Function
+  createPreloadScript: (src: string, params: string[], codeCache?: Uint8Array) => { fn: Function, codeCache: 'hit' | 'miss' | 'rejected' };
+  createPreloadCodeCache: (fn: Function) => Uint8Array | null;
 };
 
 const { EventEmitter } = events;
@@ -38,6 +39,7 @@ const {
     preloadPath: string;
     preloadSrc: string | null;
     preloadError: null | Error;
+    preloadCodeCache: Uint8Array | null;
   }[];
   process: NodeJS.Process;
 }>(IPC_MESSAGES.BROWSER_SANDBOX_LOAD);
@@ -119,22 +121,27 @@ require('@electron/internal/renderer/common-init');
 // - `process`: The `preloadProcess` object
 // - `Buffer`: Shim of `Buffer` implementation
 // - `global`: The window object, which is aliased to `global` by webpack.
-function runPreloadScript (preloadSrc: string) {
-  const preloadWrapperSrc = `(function(require, process, Buffer, global, setImmediate, clearImmediate, exports) {
-  ${preloadSrc}
-  })`;
+function runPreloadScript (preloadPath: string, preloadSrc: string, preloadCodeCache: Uint8Array | null) {
+  const params = ['require', 'process', 'Buffer', 'global', 'setImmediate', 'clearImmediate', 'exports'];
 
   // eval in window scope
-  const preloadFn = binding.createPreloadScript(preloadWrapperSrc);
+  const { fn: preloadFn, codeCache } = binding.createPreloadScript(preloadSrc, params, preloadCodeCache ?? undefined);
   const { setImmediate, clearImmediate } = require('timers');
 
-  preloadFn(preloadRequire, preloadProcess, Buffer, global, setImmediate, clearImmediate, {});
+  try {
+    preloadFn(preloadRequire, preloadProcess, Buffer, global, setImmediate, clearImmediate, {});
+  } finally {
+    // Produce the cache after the script ran, so that it also covers the
+    // functions compiled while running it.
+    const newCodeCache = codeCache === 'hit' ? null : binding.createPreloadCodeCache(preloadFn);
+    ipcRendererInternal.send(IPC_MESSAGES.BROWSER_PRELOAD_CODE_CACHE, preloadPath, codeCache, newCodeCache);
+  }
 }
 
-for (const { preloadPath, preloadSrc, preloadError } of preloadScripts) {
+for (const { preloadPath, preloadSrc, preloadError, preloadCodeCache } of preloadScripts) {
   try {
     if (preloadSrc) {
-      runPreloadScript(preloadSrc);
+      runPreloadScript(preloadPath, preloadSrc, preloadCodeCache);
     } else if (preloadError) {
       throw preloadError;
     }
@@ -24,7 +24,7 @@ export class ParentPort extends EventEmitter {
     this.#port.pause();
   }
 
-  postMessage (message: any) : void {
-    this.#port.postMessage(message);
+  postMessage (message: any, transfer?: ArrayBuffer[]) : void {
+    this.#port.postMessage(message, transfer);
   }
 }
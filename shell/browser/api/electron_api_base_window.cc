@@ -17,6 +17,7 @@
 #include "shell/browser/api/electron_api_view.h"
 #include "shell/browser/api/electron_api_web_contents.h"
 #include "shell/browser/javascript_environment.h"
+#include "shell/browser/osr/osr_options.h"
 #include "shell/common/color_util.h"
 #include "shell/common/gin_converters/callback_converter.h"
 #include "shell/common/gin_converters/file_path_converter.h"
@@ -85,9 +86,8 @@ BaseWindow::BaseWindow(v8::Isolate* isolate,
 
   // Offscreen windows are always created frameless.
   gin_helper::Dictionary web_preferences;
-  bool offscreen;
   if (options.Get(options::kWebPreferences, &web_preferences) &&
-      web_preferences.Get(options::kOffscreen, &offscreen) && offscreen) {
+      GetOffScreenOptions(web_preferences, nullptr)) {
     const_cast<gin_helper::Dictionary&>(options).Set(options::kFrame, false);
   }
 
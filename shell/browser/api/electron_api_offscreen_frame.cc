@@ -0,0 +1,133 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/api/electron_api_offscreen_frame.h"
+
+#include <cstring>
+#include <utility>
+
+#include "gin/object_template_builder.h"
+#include "gin/per_isolate_data.h"
+#include "shell/common/gin_converters/gfx_converter.h"
+#include "shell/common/gin_helper/error_thrower.h"
+#include "shell/common/node_includes.h"
+#include "v8/include/v8.h"
+
+namespace electron::api {
+
+OffscreenFrame::OffscreenFrame(const SkBitmap& bitmap,
+                               base::OnceClosure on_release)
+    : bitmap_(bitmap),
+      on_release_(std::move(on_release)),
+      width_(bitmap.width()),
+      height_(bitmap.height()),
+      row_bytes_(bitmap.rowBytes()),
+      color_type_(bitmap.colorType()) {}
+
+OffscreenFrame::~OffscreenFrame() = default;
+
+// static
+gin::Handle<OffscreenFrame> OffscreenFrame::Create(
+    v8::Isolate* isolate,
+    const SkBitmap& bitmap,
+    base::OnceClosure on_release) {
+  return gin::CreateHandle(isolate,
+                           new OffscreenFrame(bitmap, std::move(on_release)));
+}
+
+bool OffscreenFrame::CheckNotReleased(gin_helper::ErrorThrower thrower) const {
+  if (bitmap_.isNull()) {
+    thrower.ThrowError("The frame has been released");
+    return false;
+  }
+  return true;
+}
+
+v8::Local<v8::Value> OffscreenFrame::GetNativeHandle(
+    gin_helper::ErrorThrower thrower) {
+  if (!CheckNotReleased(thrower))
+    return v8::Local<v8::Value>();
+  void* pixels = bitmap_.getPixels();
+  return node::Buffer::Copy(thrower.isolate(), reinterpret_cast<char*>(&pixels),
+                            sizeof(pixels))
+      .ToLocalChecked();
+}
+
+void OffscreenFrame::CopyTo(gin_helper::ErrorThrower thrower,
+                            v8::Local<v8::Value> target,
+                            absl::optional<gfx::Rect> rect) {
+  if (!target->IsArrayBufferView()) {
+    thrower.ThrowTypeError("target must be an ArrayBufferView");
+    return;
+  }
+  if (!CheckNotReleased(thrower))
+    return;
+  auto view = target.As<v8::ArrayBufferView>();
+  uint8_t* data =
+      static_cast<uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+
+  if (!rect) {
+    // The last row of the capturer's frames may not be padded to
+    // |row_bytes_|.
+    const size_t size = bitmap_.computeByteSize();
+    if (view->ByteLength() < size) {
+      thrower.ThrowRangeError("target is smaller than the frame");
+      return;
+    }
+    memcpy(data, bitmap_.getPixels(), size);
+    return;
+  }
+
+  if (rect->IsEmpty() || !gfx::Rect(width_, height_).Contains(*rect)) {
+    thrower.ThrowRangeError("rect must be a non-empty area within the frame");
+    return;
+  }
+  SkPixmap pixmap(bitmap_.info().makeWH(rect->width(), rect->height()), data,
+                  bitmap_.bytesPerPixel() * rect->width());
+  if (view->ByteLength() < pixmap.computeByteSize()) {
+    thrower.ThrowRangeError("target is smaller than rect");
+    return;
+  }
+  bitmap_.readPixels(pixmap, rect->x(), rect->y());
+}
+
+void OffscreenFrame::Release() {
+  bitmap_.reset();
+  on_release_.RunAndReset();
+}
+
+std::string OffscreenFrame::GetPixelFormat() const {
+  return color_type_ == kBGRA_8888_SkColorType ? "bgra" : "rgba";
+}
+
+gin::ObjectTemplateBuilder OffscreenFrame::GetObjectTemplateBuilder(
+    v8::Isolate* isolate) {
+  gin::PerIsolateData* data = gin::PerIsolateData::From(isolate);
+  auto* wrapper_info = &kWrapperInfo;
+  v8::Local<v8::FunctionTemplate> constructor =
+      data->GetFunctionTemplate(wrapper_info);
+  if (constructor.IsEmpty()) {
+    constructor = v8::FunctionTemplate::New(isolate);
+    constructor->SetClassName(gin::StringToV8(isolate, GetTypeName()));
+    data->SetFunctionTemplate(wrapper_info, constructor);
+  }
+  return gin::ObjectTemplateBuilder(isolate, GetTypeName(),
+                                    constructor->InstanceTemplate())
+      .SetMethod("getNativeHandle", &OffscreenFrame::GetNativeHandle)
+      .SetMethod("copyTo", &OffscreenFrame::CopyTo)
+      .SetMethod("release", &OffscreenFrame::Release)
+      .SetProperty("width", &OffscreenFrame::GetWidth)
+      .SetProperty("height", &OffscreenFrame::GetHeight)
+      .SetProperty("rowBytes", &OffscreenFrame::GetRowBytes)
+      .SetProperty("pixelFormat", &OffscreenFrame::GetPixelFormat);
+}
+
+const char* OffscreenFrame::GetTypeName() {
+  return "OffscreenFrame";
+}
+
+// static
+gin::WrapperInfo OffscreenFrame::kWrapperInfo = {gin::kEmbedderNativeGin};
+
+}  // namespace electron::api
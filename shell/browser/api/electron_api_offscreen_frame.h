@@ -0,0 +1,77 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_BROWSER_API_ELECTRON_API_OFFSCREEN_FRAME_H_
+#define ELECTRON_SHELL_BROWSER_API_ELECTRON_API_OFFSCREEN_FRAME_H_
+
+#include <cstddef>
+#include <string>
+
+#include "base/functional/callback.h"
+#include "base/functional/callback_helpers.h"
+#include "gin/handle.h"
+#include "gin/wrappable.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/geometry/rect.h"
+#include "v8/include/v8-forward.h"
+
+namespace gin_helper {
+class ErrorThrower;
+}
+
+namespace electron::api {
+
+// A frame painted by an offscreen WebContents, in the memory it was captured
+// into. JS reads it without it being copied into a NativeImage first, and
+// hands the memory back to the capturer with release().
+class OffscreenFrame : public gin::Wrappable<OffscreenFrame> {
+ public:
+  // |on_release| is run when JS releases the frame, or when it is garbage
+  // collected.
+  static gin::Handle<OffscreenFrame> Create(v8::Isolate* isolate,
+                                            const SkBitmap& bitmap,
+                                            base::OnceClosure on_release);
+
+  // gin::Wrappable
+  static gin::WrapperInfo kWrapperInfo;
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override;
+  const char* GetTypeName() override;
+
+  // disable copy
+  OffscreenFrame(const OffscreenFrame&) = delete;
+  OffscreenFrame& operator=(const OffscreenFrame&) = delete;
+
+ private:
+  OffscreenFrame(const SkBitmap& bitmap, base::OnceClosure on_release);
+  ~OffscreenFrame() override;
+
+  // Throws and returns false once the frame has been released.
+  bool CheckNotReleased(gin_helper::ErrorThrower thrower) const;
+
+  v8::Local<v8::Value> GetNativeHandle(gin_helper::ErrorThrower thrower);
+  // Copies the whole frame, or only |rect| with its rows packed.
+  void CopyTo(gin_helper::ErrorThrower thrower,
+              v8::Local<v8::Value> target,
+              absl::optional<gfx::Rect> rect);
+  void Release();
+  int GetWidth() const { return width_; }
+  int GetHeight() const { return height_; }
+  size_t GetRowBytes() const { return row_bytes_; }
+  std::string GetPixelFormat() const;
+
+  // Holds on to the pixels until the frame is released; the capturer does not
+  // reuse the memory before then.
+  SkBitmap bitmap_;
+  base::ScopedClosureRunner on_release_;
+  const int width_;
+  const int height_;
+  const size_t row_bytes_;
+  const SkColorType color_type_;
+};
+
+}  // namespace electron::api
+
+#endif  // ELECTRON_SHELL_BROWSER_API_ELECTRON_API_OFFSCREEN_FRAME_H_
@@ -1059,9 +1059,22 @@ void Session::SetCodeCachePath(gin::Arguments* args) {
     }
     code_cache_context->Initialize(
         code_cache_path, 0 /* allows disk_cache to choose the size */);
+    code_cache_path_ = code_cache_path;
   }
 }
 
+v8::Local<v8::Value> Session::GetCodeCachePath(v8::Isolate* isolate) {
+  if (!code_cache_path_.empty())
+    return gin::ConvertToV8(isolate, code_cache_path_);
+  // In-memory sessions keep their code cache in memory too.
+  if (browser_context_->IsOffTheRecord())
+    return v8::Null(isolate);
+  // Matches where the storage partition puts the code cache by default, see
+  // ElectronBrowserClient::GetGeneratedCodeCacheSettings.
+  return gin::ConvertToV8(isolate, browser_context_->GetPath().Append(
+                                       FILE_PATH_LITERAL("Code Cache")));
+}
+
 v8::Local<v8::Promise> Session::ClearCodeCaches(
     const gin_helper::Dictionary& options) {
   auto* isolate = JavascriptEnvironment::GetIsolate();
@@ -1355,6 +1368,7 @@ void Session::FillObjectTemplate(v8::Isolate* isolate,
       .SetMethod("getStoragePath", &Session::GetPath)
       .SetMethod("setCodeCachePath", &Session::SetCodeCachePath)
       .SetMethod("clearCodeCaches", &Session::ClearCodeCaches)
+      .SetMethod("_getCodeCachePath", &Session::GetCodeCachePath)
       .SetProperty("cookies", &Session::Cookies)
       .SetProperty("netLog", &Session::NetLog)
       .SetProperty("protocol", &Session::Protocol)
@@ -144,6 +144,7 @@ class Session : public gin::Wrappable<Session>,
   v8::Local<v8::Promise> CloseAllConnections();
   v8::Local<v8::Value> GetPath(v8::Isolate* isolate);
   void SetCodeCachePath(gin::Arguments* args);
+  v8::Local<v8::Value> GetCodeCachePath(v8::Isolate* isolate);
   v8::Local<v8::Promise> ClearCodeCaches(const gin_helper::Dictionary& options);
 #if BUILDFLAG(ENABLE_BUILTIN_SPELLCHECKER)
   base::Value GetSpellCheckerLanguages();
@@ -211,6 +212,9 @@ class Session : public gin::Wrappable<Session>,
   // The client id to enable the network throttler.
   base::UnguessableToken network_emulation_token_;
 
+  // Set by setCodeCachePath(), empty for the default location.
+  base::FilePath code_cache_path_;
+
   raw_ptr<ElectronBrowserContext> browser_context_;
 };
 
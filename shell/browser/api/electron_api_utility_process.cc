@@ -22,6 +22,7 @@
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "shell/browser/api/message_port.h"
 #include "shell/browser/javascript_environment.h"
+#include "shell/common/asar/asar_util.h"
 #include "shell/common/gin_converters/callback_converter.h"
 #include "shell/common/gin_converters/file_path_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
@@ -184,6 +185,7 @@ UtilityProcessWrapper::UtilityProcessWrapper(
   blink::MessagePortDescriptorPair pipe;
   host_port_ = pipe.TakePort0();
   params->port = pipe.TakePort1();
+  params->asar_indexes = asar::GetSharedArchiveIndexes();
   connector_ = std::make_unique<mojo::Connector>(
       host_port_.TakeHandleToEntangleWithEmbedder(),
       mojo::Connector::SINGLE_THREADED_SEND,
@@ -248,24 +250,28 @@ void UtilityProcessWrapper::PostMessage(gin::Arguments* args) {
 
   blink::TransferableMessage transferable_message;
   v8::Local<v8::Value> message_value;
-  if (args->GetNext(&message_value)) {
-    if (!electron::SerializeV8Value(args->isolate(), message_value,
-                                    &transferable_message)) {
-      // SerializeV8Value sets an exception.
-      return;
-    }
-  }
+  bool has_message_value = args->GetNext(&message_value);
 
   v8::Local<v8::Value> transferables;
   std::vector<gin::Handle<MessagePort>> wrapped_ports;
+  std::vector<v8::Local<v8::ArrayBuffer>> array_buffers;
   if (args->GetNext(&transferables)) {
-    if (!gin::ConvertFromV8(args->isolate(), transferables, &wrapped_ports)) {
+    if (!MessagePort::GetTransferables(args->isolate(), transferables,
+                                       &wrapped_ports, &array_buffers)) {
       gin_helper::ErrorThrower(args->isolate())
           .ThrowTypeError("Invalid value for transfer");
       return;
     }
   }
 
+  if (has_message_value) {
+    if (!electron::SerializeV8Value(args->isolate(), message_value,
+                                    array_buffers, &transferable_message)) {
+      // SerializeV8Value sets an exception.
+      return;
+    }
+  }
+
   bool threw_exception = false;
   transferable_message.ports = MessagePort::DisentanglePorts(
       args->isolate(), wrapped_ports, &threw_exception);
@@ -275,6 +281,7 @@ void UtilityProcessWrapper::PostMessage(gin::Arguments* args) {
   mojo::Message mojo_message = blink::mojom::TransferableMessage::WrapAsMessage(
       std::move(transferable_message));
   connector_->Accept(&mojo_message);
+  electron::DetachArrayBuffers(args->isolate(), array_buffers);
 }
 
 bool UtilityProcessWrapper::Kill() const {
@@ -12,9 +12,11 @@
 #include <vector>
 
 #include "base/containers/contains.h"
+#include "base/containers/cxx20_erase.h"
 #include "base/containers/id_map.h"
 #include "base/files/file_util.h"
 #include "base/json/json_reader.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/no_destructor.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/current_thread.h"
@@ -68,6 +70,7 @@
 #include "media/base/mime_util.h"
 #include "mojo/public/cpp/bindings/associated_remote.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
 #include "mojo/public/cpp/bindings/remote.h"
 #include "mojo/public/cpp/system/platform_handle.h"
 #include "ppapi/buildflags/buildflags.h"
@@ -77,6 +80,7 @@
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "shell/browser/api/electron_api_browser_window.h"
 #include "shell/browser/api/electron_api_debugger.h"
+#include "shell/browser/api/electron_api_offscreen_frame.h"
 #include "shell/browser/api/electron_api_session.h"
 #include "shell/browser/api/electron_api_web_frame_main.h"
 #include "shell/browser/api/message_port.h"
@@ -102,7 +106,9 @@
 #include "shell/browser/web_contents_zoom_controller.h"
 #include "shell/browser/web_view_guest_delegate.h"
 #include "shell/browser/web_view_manager.h"
+#include "shell/browser/yuv_frame.h"
 #include "shell/common/api/electron_api_native_image.h"
+#include "shell/common/api/electron_api_serialized_message.h"
 #include "shell/common/api/electron_bindings.h"
 #include "shell/common/color_util.h"
 #include "shell/common/electron_constants.h"
@@ -496,6 +502,39 @@ base::IDMap<WebContents*>& GetAllWebContents() {
   return *s_all_web_contents;
 }
 
+// Channels ipcMain (or ipcMainInternal, for |internal|) has invoke handlers
+// for.
+base::flat_set<std::string>& GetGlobalInvokeChannels(bool internal) {
+  static base::NoDestructor<base::flat_set<std::string>> s_channels;
+  static base::NoDestructor<base::flat_set<std::string>> s_internal_channels;
+  return internal ? *s_internal_channels : *s_channels;
+}
+
+// Answers an invoke() call that no handler will reply to with |error|.
+void RejectInvoke(electron::mojom::ElectronApiIPC::InvokeCallback callback,
+                  const std::string& error) {
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope scope(isolate);
+  blink::CloneableMessage message;
+  // Without a current context we're shutting down, and the renderer only
+  // needs the call to be answered.
+  if (!isolate->GetCurrentContext().IsEmpty()) {
+    gin::ConvertFromV8(
+        isolate, gin::DataObjectBuilder(isolate).Set("error", error).Build(),
+        &message);
+  }
+  std::move(callback).Run(std::move(message));
+}
+
+void SetInvokeChannelRegistered(base::flat_set<std::string>& channels,
+                                const std::string& channel,
+                                bool registered) {
+  if (registered)
+    channels.insert(channel);
+  else
+    channels.erase(channel);
+}
+
 void OnCapturePageDone(gin_helper::Promise<gfx::Image> promise,
                        base::ScopedClosureRunner capture_handle,
                        const SkBitmap& bitmap) {
@@ -749,6 +788,59 @@ content::RenderFrameHost* GetRenderFrameHost(
   return frame_host;
 }
 
+// How many batched messages are emitted before the other tasks on the UI
+// thread, such as sync calls in the priority lane, get a turn.
+constexpr size_t kMaxIPCMessagesPerTask = 64;
+
+// Arguments of at least this size are handed to JS still serialized, and only
+// decoded for the listeners that need them.
+constexpr size_t kLazyDeserializationThreshold = 64 * 1024;
+
+v8::Local<v8::Value> IPCArgumentsToV8(v8::Isolate* isolate,
+                                      blink::CloneableMessage arguments) {
+  if (arguments.encoded_message.size() < kLazyDeserializationThreshold)
+    return gin::ConvertToV8(isolate, arguments);
+  return electron::api::SerializedMessage::Create(isolate,
+                                                  std::move(arguments))
+      .ToV8();
+}
+
+// Replies to a MessageSync call, unless the renderer has given up on it
+// because its timeout passed first.
+class SyncReply : public base::RefCounted<SyncReply> {
+ public:
+  explicit SyncReply(
+      electron::mojom::ElectronApiIPC::MessageSyncCallback callback)
+      : callback_(std::move(callback)) {}
+
+  // disable copy
+  SyncReply(const SyncReply&) = delete;
+  SyncReply& operator=(const SyncReply&) = delete;
+
+  // Returns false when the reply was already sent, or the call timed out.
+  bool Run(blink::CloneableMessage result) {
+    if (!callback_)
+      return false;
+    std::move(callback_).Run(std::move(result));
+    return true;
+  }
+
+  // Drops the reply once the renderer has stopped waiting for it. Returns
+  // false when the reply was already sent.
+  bool TimeOut() {
+    if (!callback_)
+      return false;
+    callback_.Reset();
+    return true;
+  }
+
+ private:
+  friend class base::RefCounted<SyncReply>;
+  ~SyncReply() = default;
+
+  electron::mojom::ElectronApiIPC::MessageSyncCallback callback_;
+};
+
 }  // namespace
 
 #if BUILDFLAG(ENABLE_ELECTRON_EXTENSIONS)
@@ -839,8 +931,7 @@ WebContents::WebContents(v8::Isolate* isolate,
   // Get type
   options.Get("type", &type_);
 
-  bool b = false;
-  if (options.Get(options::kOffscreen, &b) && b)
+  if (GetOffScreenOptions(options, &offscreen_options_))
     type_ = Type::kOffScreen;
 
   // Init embedder earlier
@@ -879,9 +970,12 @@ WebContents::WebContents(v8::Isolate* isolate,
     params.guest_delegate = guest_delegate_.get();
 
     if (embedder_ && embedder_->IsOffScreen()) {
+      offscreen_options_ = embedder_->offscreen_options_;
       auto* view = new OffScreenWebContentsView(
-          false,
-          base::BindRepeating(&WebContents::OnPaint, base::Unretained(this)));
+          false, offscreen_options_,
+          base::BindRepeating(&WebContents::OnPaint, base::Unretained(this)),
+          base::BindRepeating(&WebContents::OnPaintYUV,
+                              base::Unretained(this)));
       params.view = view;
       params.delegate_view = view;
 
@@ -900,8 +994,9 @@ WebContents::WebContents(v8::Isolate* isolate,
 
     content::WebContents::CreateParams params(session->browser_context());
     auto* view = new OffScreenWebContentsView(
-        transparent,
-        base::BindRepeating(&WebContents::OnPaint, base::Unretained(this)));
+        transparent, offscreen_options_,
+        base::BindRepeating(&WebContents::OnPaint, base::Unretained(this)),
+        base::BindRepeating(&WebContents::OnPaintYUV, base::Unretained(this)));
     params.view = view;
     params.delegate_view = view;
 
@@ -1723,6 +1818,18 @@ void WebContents::RenderFrameHostChanged(content::RenderFrameHost* old_host,
       old_host->GetRenderWidgetHost()->RemoveInputEventObserver(this);
     if (new_host)
       new_host->GetRenderWidgetHost()->AddInputEventObserver(this);
+
+    // Renderers sending directly to the old main frame connect to the new one
+    // with their next message.
+    if (old_host) {
+      base::EraseIf(direct_ipc_senders_,
+                    [old_host](DirectIPCSender& direct_ipc_sender) {
+                      if (direct_ipc_sender.frame_id != old_host->GetGlobalId())
+                        return false;
+                      direct_ipc_sender.remote->Close();
+                      return true;
+                    });
+    }
   }
 
   // During cross-origin navigation, a FrameTreeNode will swap out its RFH.
@@ -1921,12 +2028,92 @@ void WebContents::Message(bool internal,
                           const std::string& channel,
                           blink::CloneableMessage arguments,
                           content::RenderFrameHost* render_frame_host) {
-  TRACE_EVENT1("electron", "WebContents::Message", "channel", channel);
+  TRACE_EVENT2("electron", "WebContents::Message", "channel", channel, "bytes",
+               arguments.encoded_message.size());
+  RecordIPCMessage(internal, channel, arguments.encoded_message.size());
+  // Messages must not overtake the batched ones sent before them.
+  if (!queued_ipc_messages_.empty()) {
+    queued_ipc_messages_.emplace_back(
+        render_frame_host->GetGlobalId(),
+        mojom::IPCMessage::New(internal, channel, std::move(arguments)));
+    return;
+  }
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
   // webContents.emit('-ipc-message', new Event(), internal, channel,
   // arguments);
   EmitWithSender("-ipc-message", render_frame_host,
                  electron::mojom::ElectronApiIPC::InvokeCallback(), internal,
-                 channel, std::move(arguments));
+                 channel, IPCArgumentsToV8(isolate, std::move(arguments)));
+}
+
+void WebContents::MessageBatch(std::vector<mojom::IPCMessagePtr> messages,
+                               content::RenderFrameHost* render_frame_host) {
+  TRACE_EVENT1("electron", "WebContents::MessageBatch", "count",
+               messages.size());
+  const content::GlobalRenderFrameHostId frame_id =
+      render_frame_host->GetGlobalId();
+  for (auto& message : messages) {
+    RecordIPCMessage(message->internal, message->channel,
+                     message->arguments.encoded_message.size());
+    queued_ipc_messages_.emplace_back(frame_id, std::move(message));
+  }
+  DispatchQueuedIPCMessages(kMaxIPCMessagesPerTask);
+}
+
+void WebContents::DispatchQueuedIPCMessages(size_t max_count) {
+  if (queued_ipc_messages_.empty())
+    return;
+  TRACE_EVENT1("electron", "WebContents::DispatchQueuedIPCMessages", "queued",
+               queued_ipc_messages_.size());
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+
+  // Every message still gets an event of its own, so that listeners of one
+  // message can not observe what listeners of another did to theirs.
+  std::vector<v8::Local<v8::Value>> batch;
+  batch.reserve(std::min(max_count, queued_ipc_messages_.size()));
+  while (batch.size() < max_count && !queued_ipc_messages_.empty()) {
+    auto [frame_id, message] = std::move(queued_ipc_messages_.front());
+    queued_ipc_messages_.pop_front();
+    // Messages of a frame that went away while they were queued are dropped,
+    // like the ones still in its pipe.
+    content::RenderFrameHost* frame =
+        content::RenderFrameHost::FromID(frame_id);
+    if (!frame)
+      continue;
+    gin::Handle<gin_helper::internal::Event> event = MakeEventWithSender(
+        isolate, frame, electron::mojom::ElectronApiIPC::InvokeCallback());
+    if (event.IsEmpty())
+      continue;
+    batch.push_back(gin::DataObjectBuilder(isolate)
+                        .Set("event", event)
+                        .Set("internal", message->internal)
+                        .Set("channel", message->channel)
+                        .Set("args", IPCArgumentsToV8(
+                                         isolate, std::move(message->arguments)))
+                        .Build());
+  }
+  if (!queued_ipc_messages_.empty() && !ipc_dispatch_scheduled_) {
+    ipc_dispatch_scheduled_ = true;
+    content::GetUIThreadTaskRunner({})->PostTask(
+        FROM_HERE,
+        base::BindOnce(&WebContents::OnDispatchQueuedIPCMessagesTask,
+                       GetWeakPtr()));
+  }
+  if (batch.empty())
+    return;
+  // webContents.emit('-ipc-message-batch', [{event, internal, channel, args}]);
+  EmitWithoutEvent("-ipc-message-batch", batch);
+}
+
+void WebContents::OnDispatchQueuedIPCMessagesTask() {
+  ipc_dispatch_scheduled_ = false;
+  DispatchQueuedIPCMessages(kMaxIPCMessagesPerTask);
+}
+
+void WebContents::FlushQueuedIPCMessages() {
+  DispatchQueuedIPCMessages(std::numeric_limits<size_t>::max());
 }
 
 void WebContents::Invoke(
@@ -1935,10 +2122,99 @@ void WebContents::Invoke(
     blink::CloneableMessage arguments,
     electron::mojom::ElectronApiIPC::InvokeCallback callback,
     content::RenderFrameHost* render_frame_host) {
-  TRACE_EVENT1("electron", "WebContents::Invoke", "channel", channel);
-  // webContents.emit('-ipc-invoke', new Event(), internal, channel, arguments);
-  EmitWithSender("-ipc-invoke", render_frame_host, std::move(callback),
-                 internal, channel, std::move(arguments));
+  TRACE_EVENT2("electron", "WebContents::Invoke", "channel", channel, "bytes",
+               arguments.encoded_message.size());
+  RecordIPCMessage(internal, channel, arguments.encoded_message.size());
+  FlushQueuedIPCMessages();
+  callback = ipc_metrics_.TimeReply(IPCMetrics::ReplyType::kInvoke, internal,
+                                    channel, std::move(callback));
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Object> wrapper;
+  if (!GetWrapper(isolate).ToLocal(&wrapper)) {
+    RejectInvoke(std::move(callback), "WebContents was destroyed");
+    return;
+  }
+  // Calls of channels without a handler are answered here, without entering
+  // JavaScript.
+  const char* target = GetInvokeTarget(internal, channel, render_frame_host);
+  if (!target) {
+    const std::string error = "No handler registered for '" + channel + "'";
+    LOG(ERROR) << "Error occurred in handler for '" << channel
+               << "': " << error;
+    RejectInvoke(std::move(callback), "Error: " + error);
+    return;
+  }
+  // The handler is called without an Event or a ReplyChannel being made for
+  // it. It answers through webContents._replyToInvoke(id, reply) instead, and
+  // calls that are still waiting for their reply are rejected when the
+  // WebContents goes away.
+  const int32_t id = ++last_invoke_id_;
+  pending_invokes_.emplace(id, std::move(callback));
+  // webContents.emit('-ipc-invoke', id, processId, frameId, internal, channel,
+  // arguments, target);
+  EmitWithoutEvent("-ipc-invoke", id, render_frame_host->GetProcess()->GetID(),
+                   render_frame_host->GetRoutingID(), internal, channel,
+                   std::move(arguments), target);
+}
+
+bool WebContents::ReplyToInvoke(v8::Isolate* isolate,
+                                int32_t id,
+                                v8::Local<v8::Value> reply) {
+  auto it = pending_invokes_.find(id);
+  if (it == pending_invokes_.end())
+    return false;
+  // A reply that can not be cloned throws, and leaves the call waiting for
+  // the error that is sent instead.
+  blink::CloneableMessage message;
+  if (!gin::ConvertFromV8(isolate, reply, &message))
+    return false;
+  electron::mojom::ElectronApiIPC::InvokeCallback callback =
+      std::move(it->second);
+  pending_invokes_.erase(it);
+  std::move(callback).Run(std::move(message));
+  return true;
+}
+
+// static
+void WebContents::SetGlobalInvokeHandlerRegistered(bool internal,
+                                                   const std::string& channel,
+                                                   bool registered) {
+  SetInvokeChannelRegistered(GetGlobalInvokeChannels(internal), channel,
+                             registered);
+}
+
+void WebContents::SetInvokeHandlerRegistered(const std::string& channel,
+                                             bool registered) {
+  SetInvokeChannelRegistered(invoke_channels_, channel, registered);
+}
+
+void WebContents::RecordIPCMessage(bool internal,
+                                   const std::string& channel,
+                                   size_t bytes) {
+  ipc_metrics_.RecordMessage(internal, channel, bytes);
+  TRACE_COUNTER_ID2("electron", "WebContents::IPC", ID(), "count",
+                    ipc_metrics_.total_count(), "bytes",
+                    ipc_metrics_.total_bytes());
+}
+
+const char* WebContents::GetInvokeTarget(
+    bool internal,
+    const std::string& channel,
+    content::RenderFrameHost* render_frame_host) {
+  if (internal)
+    return GetGlobalInvokeChannels(true).contains(channel) ? "internal"
+                                                           : nullptr;
+  // Same order as the ipc objects receive messages in: the frame's, the
+  // WebContents' and then ipcMain.
+  WebFrameMain* web_frame = WebFrameMain::FromRenderFrameHost(render_frame_host);
+  if (web_frame && web_frame->HasInvokeHandler(channel))
+    return "frame";
+  if (invoke_channels_.contains(channel))
+    return "contents";
+  if (GetGlobalInvokeChannels(false).contains(channel))
+    return "main";
+  return nullptr;
 }
 
 void WebContents::OnFirstNonEmptyLayout(
@@ -2034,6 +2310,11 @@ void WebContents::ReceivePostMessage(
     const std::string& channel,
     blink::TransferableMessage message,
     content::RenderFrameHost* render_frame_host) {
+  size_t bytes = message.encoded_message.size();
+  for (const auto& contents : message.array_buffer_contents_array)
+    bytes += contents->contents.size();
+  RecordIPCMessage(false, channel, bytes);
+  FlushQueuedIPCMessages();
   v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
   v8::HandleScope handle_scope(isolate);
   auto wrapped_ports =
@@ -2049,19 +2330,88 @@ void WebContents::MessageSync(
     bool internal,
     const std::string& channel,
     blink::CloneableMessage arguments,
+    mojom::SyncMessageOptionsPtr options,
     electron::mojom::ElectronApiIPC::MessageSyncCallback callback,
     content::RenderFrameHost* render_frame_host) {
-  TRACE_EVENT1("electron", "WebContents::MessageSync", "channel", channel);
+  TRACE_EVENT2("electron", "WebContents::MessageSync", "channel", channel,
+               "bytes", arguments.encoded_message.size());
+  RecordIPCMessage(internal, channel, arguments.encoded_message.size());
+  // High priority calls are handled ahead of the batched messages that are
+  // still queued; the others wait for them, as they would have before.
+  if (!options->high_priority)
+    FlushQueuedIPCMessages();
+
+  auto reply = base::MakeRefCounted<SyncReply>(std::move(callback));
+  const base::TimeTicks send_time = options->send_time;
+  if (options->timeout.is_positive()) {
+    // The renderer keeps the timeout itself, as this task is held up for as
+    // long as the main process is busy. It only reports the call, and drops
+    // the reply the renderer no longer waits for.
+    content::GetUIThreadTaskRunner({})->PostDelayedTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](base::WeakPtr<WebContents> self, scoped_refptr<SyncReply> reply,
+               const std::string& channel, base::TimeDelta timeout) {
+              if (reply->TimeOut() && self && !channel.empty())
+                self->ReportSyncMessageBlocked(channel, timeout, true);
+            },
+            GetWeakPtr(), reply, internal ? std::string() : channel,
+            options->timeout),
+        std::max(send_time + options->timeout - base::TimeTicks::Now(),
+                 base::TimeDelta()));
+  }
+  electron::mojom::ElectronApiIPC::InvokeCallback on_result = base::BindOnce(
+      [](base::WeakPtr<WebContents> self, scoped_refptr<SyncReply> reply,
+         const std::string& channel, base::TimeTicks send_time,
+         blink::CloneableMessage result) {
+        if (reply->Run(std::move(result)) && self && !channel.empty()) {
+          self->ReportSyncMessageBlocked(
+              channel, base::TimeTicks::Now() - send_time, false);
+        }
+      },
+      GetWeakPtr(), reply, internal ? std::string() : channel, send_time);
+  on_result = ipc_metrics_.TimeReply(IPCMetrics::ReplyType::kSync, internal,
+                                     channel, std::move(on_result));
   // webContents.emit('-ipc-message-sync', new Event(sender, message), internal,
   // channel, arguments);
-  EmitWithSender("-ipc-message-sync", render_frame_host, std::move(callback),
+  EmitWithSender("-ipc-message-sync", render_frame_host, std::move(on_result),
                  internal, channel, std::move(arguments));
 }
 
+void WebContents::ReportSyncMessageBlocked(const std::string& channel,
+                                           base::TimeDelta blocked,
+                                           bool timed_out) {
+  blocked = std::max(blocked, base::TimeDelta());
+  if (!sync_ipc_warning_threshold_.is_positive() ||
+      blocked < sync_ipc_warning_threshold_)
+    return;
+  // The reply may be sent from inside a listener, so the event is emitted once
+  // that has returned.
+  content::GetUIThreadTaskRunner({})->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](base::WeakPtr<WebContents> self, const std::string& channel,
+             base::TimeDelta blocked, bool timed_out) {
+            if (!self)
+              return;
+            v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+            v8::HandleScope handle_scope(isolate);
+            self->Emit("ipc-message-sync-slow",
+                       gin::DataObjectBuilder(isolate)
+                           .Set("channel", channel)
+                           .Set("blockedTime", blocked.InMillisecondsF())
+                           .Set("timedOut", timed_out)
+                           .Build());
+          },
+          GetWeakPtr(), channel, blocked, timed_out));
+}
+
 void WebContents::MessageTo(int32_t web_contents_id,
                             const std::string& channel,
                             blink::CloneableMessage arguments) {
   TRACE_EVENT1("electron", "WebContents::MessageTo", "channel", channel);
+  RecordIPCMessage(false, channel, arguments.encoded_message.size());
+  FlushQueuedIPCMessages();
   auto* target_web_contents = FromID(web_contents_id);
 
   if (target_web_contents) {
@@ -2081,10 +2431,75 @@ void WebContents::MessageTo(int32_t web_contents_id,
   }
 }
 
+void WebContents::ConnectTo(
+    int32_t web_contents_id,
+    mojo::PendingRemote<mojom::ElectronDirectIPCSender> sender,
+    electron::mojom::ElectronApiIPC::ConnectToCallback callback) {
+  TRACE_EVENT1("electron", "WebContents::ConnectTo", "web_contents_id",
+               web_contents_id);
+  auto* target_web_contents = FromID(web_contents_id);
+  if (!direct_send_to_ || !target_web_contents) {
+    std::move(callback).Run(mojo::NullRemote());
+    return;
+  }
+  content::RenderFrameHost* frame = target_web_contents->MainFrame();
+  DCHECK(frame);
+
+  v8::HandleScope handle_scope(JavascriptEnvironment::GetIsolate());
+  gin::Handle<WebFrameMain> web_frame_main =
+      WebFrameMain::From(JavascriptEnvironment::GetIsolate(), frame);
+  if (!web_frame_main->CheckRenderFrame()) {
+    std::move(callback).Run(mojo::NullRemote());
+    return;
+  }
+
+  // The MessageTo calls the renderer made before this one have already been
+  // passed on to the target, ahead of the connection, so the messages sent
+  // over it can not overtake them.
+  mojo::PendingRemote<mojom::ElectronDirectIPC> remote;
+  web_frame_main->GetRendererApi()->BindDirectIPC(
+      ID(), remote.InitWithNewPipeAndPassReceiver());
+  std::move(callback).Run(std::move(remote));
+
+  auto& senders = target_web_contents->direct_ipc_senders_;
+  base::EraseIf(senders, [](const DirectIPCSender& direct_ipc_sender) {
+    return !direct_ipc_sender.remote.is_connected();
+  });
+  DirectIPCSender& direct_ipc_sender = senders.emplace_back();
+  direct_ipc_sender.sender_id = ID();
+  direct_ipc_sender.frame_id = frame->GetGlobalId();
+  direct_ipc_sender.remote.Bind(std::move(sender));
+}
+
+void WebContents::SetDirectSendTo(bool enabled) {
+  direct_send_to_ = enabled;
+  if (enabled)
+    return;
+  // The connections this WebContents already sends over are closed too.
+  for (auto iter = base::IDMap<WebContents*>::iterator(&GetAllWebContents());
+       !iter.IsAtEnd(); iter.Advance()) {
+    base::EraseIf(iter.GetCurrentValue()->direct_ipc_senders_,
+                  [this](DirectIPCSender& direct_ipc_sender) {
+                    if (direct_ipc_sender.sender_id != ID())
+                      return false;
+                    direct_ipc_sender.remote->Close();
+                    return true;
+                  });
+  }
+}
+
+WebContents::DirectIPCSender::DirectIPCSender() = default;
+WebContents::DirectIPCSender::DirectIPCSender(DirectIPCSender&&) = default;
+WebContents::DirectIPCSender& WebContents::DirectIPCSender::operator=(
+    DirectIPCSender&&) = default;
+WebContents::DirectIPCSender::~DirectIPCSender() = default;
+
 void WebContents::MessageHost(const std::string& channel,
                               blink::CloneableMessage arguments,
                               content::RenderFrameHost* render_frame_host) {
   TRACE_EVENT1("electron", "WebContents::MessageHost", "channel", channel);
+  RecordIPCMessage(false, channel, arguments.encoded_message.size());
+  FlushQueuedIPCMessages();
   // webContents.emit('ipc-message-host', new Event(), channel, args);
   EmitWithSender("ipc-message-host", render_frame_host,
                  electron::mojom::ElectronApiIPC::InvokeCallback(), channel,
@@ -2313,6 +2728,9 @@ void WebContents::WebContentsDestroyed() {
   // Clear the pointer stored in wrapper.
   if (GetAllWebContents().Lookup(id_))
     GetAllWebContents().Remove(id_);
+  // Mojo requires every invoke() call to be answered.
+  for (auto& [id, callback] : std::exchange(pending_invokes_, {}))
+    RejectInvoke(std::move(callback), "WebContents was destroyed");
   v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
   v8::HandleScope scope(isolate);
   v8::Local<v8::Object> wrapper;
@@ -3366,14 +3784,67 @@ void WebContents::SendInputEvent(v8::Isolate* isolate,
 
 void WebContents::BeginFrameSubscription(gin::Arguments* args) {
   bool only_dirty = false;
-  FrameSubscriber::FrameCaptureCallback callback;
+  media::VideoPixelFormat format = media::PIXEL_FORMAT_ARGB;
+  absl::optional<media::VideoCodec> codec;
+  uint32_t bitrate = 0;
 
   if (args->Length() > 1) {
-    if (!args->GetNext(&only_dirty)) {
+    gin_helper::Dictionary options;
+    if (args->PeekNext()->IsObject() && args->GetNext(&options)) {
+      options.Get("onlyDirty", &only_dirty);
+      std::string codec_name;
+      if (options.Get("codec", &codec_name)) {
+        codec = FrameEncoder::ParseCodec(codec_name);
+        if (!codec) {
+          args->ThrowTypeError("Invalid codec: " + codec_name);
+          return;
+        }
+        if (!FrameEncoder::IsSupported()) {
+          gin_helper::ErrorThrower(args->isolate())
+              .ThrowError("Encoding is not supported in this build");
+          return;
+        }
+        options.Get("bitrate", &bitrate);
+      }
+      std::string pixel_format;
+      if (options.Get("pixelFormat", &pixel_format)) {
+        absl::optional<media::VideoPixelFormat> parsed =
+            ParseCapturePixelFormat(pixel_format);
+        if (!parsed) {
+          args->ThrowTypeError("Invalid pixelFormat: " + pixel_format);
+          return;
+        }
+        format = *parsed;
+      }
+    } else if (!args->GetNext(&only_dirty)) {
       args->ThrowError();
       return;
     }
   }
+
+  if (codec) {
+    FrameEncoder::ChunkCallback callback;
+    if (!args->GetNext(&callback)) {
+      args->ThrowError();
+      return;
+    }
+    frame_subscriber_ = std::make_unique<FrameSubscriber>(
+        web_contents(), callback, *codec, bitrate);
+    return;
+  }
+
+  if (format != media::PIXEL_FORMAT_ARGB) {
+    FrameSubscriber::YUVFrameCaptureCallback callback;
+    if (!args->GetNext(&callback)) {
+      args->ThrowError();
+      return;
+    }
+    frame_subscriber_ =
+        std::make_unique<FrameSubscriber>(web_contents(), callback, format);
+    return;
+  }
+
+  FrameSubscriber::FrameCaptureCallback callback;
   if (!args->GetNext(&callback)) {
     args->ThrowError();
     return;
@@ -3510,7 +3981,37 @@ bool WebContents::IsOffScreen() const {
 }
 
 void WebContents::OnPaint(const gfx::Rect& dirty_rect, const SkBitmap& bitmap) {
-  Emit("paint", dirty_rect, gfx::Image::CreateFrom1xBitmap(bitmap));
+  if (!offscreen_options_.use_shared_memory) {
+    if (!offscreen_options_.dirty_region_only) {
+      Emit("paint", dirty_rect, gfx::Image::CreateFrom1xBitmap(bitmap));
+      return;
+    }
+    // Only the dirty pixels are copied, packed, so that mostly static pages
+    // cost in proportion to what changed rather than to their size.
+    const gfx::Rect rect = gfx::IntersectRects(
+        dirty_rect, gfx::Rect(bitmap.width(), bitmap.height()));
+    SkBitmap dirty;
+    if (!rect.IsEmpty() &&
+        dirty.tryAllocPixels(bitmap.info().makeWH(rect.width(), rect.height())))
+      bitmap.readPixels(dirty.pixmap(), rect.x(), rect.y());
+    Emit("paint", rect, gfx::Image::CreateFrom1xBitmap(dirty));
+    return;
+  }
+  // The frame takes the place of the image, which would keep the capturer's
+  // memory alive after release() for as long as the image is reachable.
+  // It is held until JS releases it, which is what adaptive pacing goes by.
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  auto* osr_rwhv = GetOffScreenRenderWidgetHostView();
+  Emit("paint", dirty_rect, gfx::Image(),
+       OffscreenFrame::Create(isolate, bitmap,
+                              osr_rwhv ? osr_rwhv->TakeFrameReleaseCallback()
+                                       : base::OnceClosure()));
+}
+
+void WebContents::OnPaintYUV(const gfx::Rect& dirty_rect,
+                             const YUVFrame& frame) {
+  Emit("paint", dirty_rect, gfx::Image(), frame);
 }
 
 void WebContents::StartPainting() {
@@ -3541,6 +4042,23 @@ int WebContents::GetFrameRate() const {
   return osr_wcv ? osr_wcv->GetFrameRate() : 0;
 }
 
+v8::Local<v8::Value> WebContents::GetFrameStats(v8::Isolate* isolate) {
+  auto* osr_rwhv = IsOffScreen() ? GetOffScreenRenderWidgetHostView() : nullptr;
+  if (!osr_rwhv)
+    return v8::Null(isolate);
+
+  const OffScreenFrameStats stats = osr_rwhv->GetFrameStats();
+  gin_helper::Dictionary result = gin::Dictionary::CreateEmpty(isolate);
+  result.Set("framesCaptured", stats.captured);
+  result.Set("framesDelivered", stats.delivered);
+  result.Set("framesDropped", stats.dropped);
+  result.Set("consumerLatency", stats.consumer_latency.InMillisecondsF());
+  result.Set("frameRate", stats.capture_period.is_positive()
+                              ? base::Seconds(1) / stats.capture_period
+                              : 0.0);
+  return result.GetHandle();
+}
+
 void WebContents::Invalidate() {
   if (IsOffScreen()) {
     auto* osr_rwhv = GetOffScreenRenderWidgetHostView();
@@ -3712,6 +4230,22 @@ void WebContents::OnInputEvent(const blink::WebInputEvent& event) {
   Emit("input-event", event);
 }
 
+v8::Local<v8::Value> WebContents::GetIPCMetrics(v8::Isolate* isolate) const {
+  return ipc_metrics_.ToV8(isolate);
+}
+
+void WebContents::ClearIPCMetrics() {
+  ipc_metrics_.Clear();
+}
+
+int WebContents::GetSyncIPCWarningThreshold() const {
+  return sync_ipc_warning_threshold_.InMilliseconds();
+}
+
+void WebContents::SetSyncIPCWarningThreshold(int threshold) {
+  sync_ipc_warning_threshold_ = base::Milliseconds(std::max(threshold, 0));
+}
+
 v8::Local<v8::Promise> WebContents::GetProcessMemoryInfo(v8::Isolate* isolate) {
   gin_helper::Promise<gin_helper::Dictionary> promise(isolate);
   v8::Local<v8::Promise> handle = promise.GetHandle();
@@ -4280,6 +4814,7 @@ void WebContents::FillObjectTemplate(v8::Isolate* isolate,
       .SetMethod("isPainting", &WebContents::IsPainting)
       .SetMethod("setFrameRate", &WebContents::SetFrameRate)
       .SetMethod("getFrameRate", &WebContents::GetFrameRate)
+      .SetMethod("getFrameStats", &WebContents::GetFrameStats)
       .SetMethod("invalidate", &WebContents::Invalidate)
       .SetMethod("setZoomLevel", &WebContents::SetZoomLevel)
       .SetMethod("getZoomLevel", &WebContents::GetZoomLevel)
@@ -4287,6 +4822,9 @@ void WebContents::FillObjectTemplate(v8::Isolate* isolate,
       .SetMethod("getZoomFactor", &WebContents::GetZoomFactor)
       .SetMethod("getType", &WebContents::GetType)
       .SetMethod("_getPreloadPaths", &WebContents::GetPreloadPaths)
+      .SetMethod("_setInvokeHandlerRegistered",
+                 &WebContents::SetInvokeHandlerRegistered)
+      .SetMethod("_replyToInvoke", &WebContents::ReplyToInvoke)
       .SetMethod("getLastWebPreferences", &WebContents::GetLastWebPreferences)
       .SetMethod("getOwnerBrowserWindow", &WebContents::GetOwnerBrowserWindow)
       .SetMethod("inspectServiceWorker", &WebContents::InspectServiceWorker)
@@ -4319,6 +4857,13 @@ void WebContents::FillObjectTemplate(v8::Isolate* isolate,
       .SetMethod("setImageAnimationPolicy",
                  &WebContents::SetImageAnimationPolicy)
       .SetMethod("_getProcessMemoryInfo", &WebContents::GetProcessMemoryInfo)
+      .SetMethod("getIPCMetrics", &WebContents::GetIPCMetrics)
+      .SetMethod("clearIPCMetrics", &WebContents::ClearIPCMetrics)
+      .SetProperty("syncIPCWarningThreshold",
+                   &WebContents::GetSyncIPCWarningThreshold,
+                   &WebContents::SetSyncIPCWarningThreshold)
+      .SetProperty("directSendTo", &WebContents::GetDirectSendTo,
+                   &WebContents::SetDirectSendTo)
       .SetProperty("id", &WebContents::ID)
       .SetProperty("session", &WebContents::Session)
       .SetProperty("hostWebContents", &WebContents::HostWebContents)
@@ -4477,6 +5022,11 @@ std::vector<gin::Handle<WebContents>> GetAllWebContentsAsV8(
   return list;
 }
 
+bool IsSerializedMessage(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  electron::api::SerializedMessage* message = nullptr;
+  return gin::ConvertFromV8(isolate, value, &message);
+}
+
 void Initialize(v8::Local<v8::Object> exports,
                 v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context,
@@ -4488,6 +5038,9 @@ void Initialize(v8::Local<v8::Object> exports,
   dict.SetMethod("fromFrame", &WebContentsFromFrame);
   dict.SetMethod("fromDevToolsTargetId", &WebContentsFromDevToolsTargetID);
   dict.SetMethod("getAllWebContents", &GetAllWebContentsAsV8);
+  dict.SetMethod("_setGlobalInvokeHandlerRegistered",
+                 &WebContents::SetGlobalInvokeHandlerRegistered);
+  dict.SetMethod("_isSerializedMessage", &IsSerializedMessage);
 }
 
 }  // namespace
@@ -11,6 +11,9 @@
 #include <utility>
 #include <vector>
 
+#include "base/containers/circular_deque.h"
+#include "base/containers/flat_map.h"
+#include "base/containers/flat_set.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/raw_ptr_exclusion.h"
 #include "base/memory/weak_ptr.h"
@@ -23,6 +26,7 @@
 #include "chrome/browser/ui/exclusive_access/exclusive_access_manager.h"
 #include "content/common/frame.mojom.h"
 #include "content/public/browser/devtools_agent_host.h"
+#include "content/public/browser/global_routing_id.h"
 #include "content/public/browser/keyboard_event_processing_result.h"
 #include "content/public/browser/render_widget_host.h"
 #include "content/public/browser/web_contents.h"
@@ -32,12 +36,16 @@
 #include "electron/shell/common/api/api.mojom.h"
 #include "gin/handle.h"
 #include "gin/wrappable.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
 #include "mojo/public/cpp/bindings/receiver_set.h"
+#include "mojo/public/cpp/bindings/remote.h"
 #include "printing/buildflags/buildflags.h"
 #include "shell/browser/api/frame_subscriber.h"
+#include "shell/browser/api/ipc_metrics.h"
 #include "shell/browser/api/save_page_handler.h"
 #include "shell/browser/event_emitter_mixin.h"
 #include "shell/browser/extended_web_contents_observer.h"
+#include "shell/browser/osr/osr_options.h"
 #include "shell/browser/ui/inspectable_web_contents.h"
 #include "shell/browser/ui/inspectable_web_contents_delegate.h"
 #include "shell/browser/ui/inspectable_web_contents_view_delegate.h"
@@ -93,6 +101,7 @@ class WebDialogHelper;
 class NativeWindow;
 class OffScreenRenderWidgetHostView;
 class OffScreenWebContentsView;
+class YUVFrame;
 
 namespace api {
 
@@ -283,11 +292,13 @@ class WebContents : public ExclusiveAccessContext,
   // Methods for offscreen rendering
   bool IsOffScreen() const;
   void OnPaint(const gfx::Rect& dirty_rect, const SkBitmap& bitmap);
+  void OnPaintYUV(const gfx::Rect& dirty_rect, const YUVFrame& frame);
   void StartPainting();
   void StopPainting();
   bool IsPainting() const;
   void SetFrameRate(int frame_rate);
   int GetFrameRate() const;
+  v8::Local<v8::Value> GetFrameStats(v8::Isolate* isolate);
   void Invalidate();
   gfx::Size GetSizeForNewRenderView(content::WebContents*) override;
 
@@ -327,6 +338,20 @@ class WebContents : public ExclusiveAccessContext,
                                           const base::FilePath& file_path);
   v8::Local<v8::Promise> GetProcessMemoryInfo(v8::Isolate* isolate);
 
+  // Per-channel metrics of the IPC received from this WebContents' frames.
+  v8::Local<v8::Value> GetIPCMetrics(v8::Isolate* isolate) const;
+  void ClearIPCMetrics();
+
+  // Sync IPC calls that block their renderer for at least this many
+  // milliseconds emit 'ipc-message-sync-slow'. Zero disables the event.
+  int GetSyncIPCWarningThreshold() const;
+  void SetSyncIPCWarningThreshold(int threshold);
+
+  // Whether ipcRenderer.sendTo messages from this WebContents may go straight
+  // to the renderer of their target, instead of through the browser.
+  bool GetDirectSendTo() const { return direct_send_to_; }
+  void SetDirectSendTo(bool enabled);
+
   bool HandleContextMenu(content::RenderFrameHost& render_frame_host,
                          const content::ContextMenuParams& params) override;
 
@@ -412,6 +437,8 @@ class WebContents : public ExclusiveAccessContext,
                const std::string& channel,
                blink::CloneableMessage arguments,
                content::RenderFrameHost* render_frame_host);
+  void MessageBatch(std::vector<mojom::IPCMessagePtr> messages,
+                    content::RenderFrameHost* render_frame_host);
   void Invoke(bool internal,
               const std::string& channel,
               blink::CloneableMessage arguments,
@@ -424,6 +451,7 @@ class WebContents : public ExclusiveAccessContext,
       bool internal,
       const std::string& channel,
       blink::CloneableMessage arguments,
+      mojom::SyncMessageOptionsPtr options,
       electron::mojom::ElectronApiIPC::MessageSyncCallback callback,
       content::RenderFrameHost* render_frame_host);
   void MessageTo(int32_t web_contents_id,
@@ -432,6 +460,21 @@ class WebContents : public ExclusiveAccessContext,
   void MessageHost(const std::string& channel,
                    blink::CloneableMessage arguments,
                    content::RenderFrameHost* render_frame_host);
+  void ConnectTo(int32_t web_contents_id,
+                 mojo::PendingRemote<mojom::ElectronDirectIPCSender> sender,
+                 electron::mojom::ElectronApiIPC::ConnectToCallback callback);
+
+  // Mirror the channels ipcMain, ipcMainInternal and webContents.ipc have
+  // invoke handlers for, which lets Invoke pick the handling ipc object, or
+  // reject the call, without searching for it in JavaScript.
+  static void SetGlobalInvokeHandlerRegistered(bool internal,
+                                               const std::string& channel,
+                                               bool registered);
+  void SetInvokeHandlerRegistered(const std::string& channel, bool registered);
+  // Answers the invoke() call |id| that was emitted as '-ipc-invoke'.
+  bool ReplyToInvoke(v8::Isolate* isolate,
+                     int32_t id,
+                     v8::Local<v8::Value> reply);
 
   // mojom::ElectronWebContentsUtility
   void OnFirstNonEmptyLayout(content::RenderFrameHost* render_frame_host);
@@ -472,6 +515,30 @@ class WebContents : public ExclusiveAccessContext,
   // Delete this if garbage collection has not started.
   void DeleteThisIfAlive();
 
+  // Returns which ipc object handles invoke() calls on |channel| from
+  // |render_frame_host|, or nullptr when none does.
+  const char* GetInvokeTarget(bool internal,
+                              const std::string& channel,
+                              content::RenderFrameHost* render_frame_host);
+
+  // Counts a message received on |channel| in |ipc_metrics_|, and updates
+  // the trace counters of the totals.
+  void RecordIPCMessage(bool internal, const std::string& channel, size_t bytes);
+
+  // Emits up to |max_count| of |queued_ipc_messages_|, and schedules a task to
+  // emit the rest, if any.
+  void DispatchQueuedIPCMessages(size_t max_count);
+  void OnDispatchQueuedIPCMessagesTask();
+  // Emits every queued message right away, before a message that has to be
+  // handled after them.
+  void FlushQueuedIPCMessages();
+
+  // Emits 'ipc-message-sync-slow' when a MessageSync call blocked its
+  // renderer for longer than |sync_ipc_warning_threshold_|.
+  void ReportSyncMessageBlocked(const std::string& channel,
+                                base::TimeDelta blocked,
+                                bool timed_out);
+
   // Creates a InspectableWebContents object and takes ownership of
   // |web_contents|.
   void InitWithWebContents(std::unique_ptr<content::WebContents> web_contents,
@@ -790,6 +857,8 @@ class WebContents : public ExclusiveAccessContext,
 
   bool offscreen_ = false;
 
+  OffScreenOptions offscreen_options_;
+
   // Whether window is fullscreened by HTML5 api.
   bool html_fullscreen_ = false;
 
@@ -833,6 +902,44 @@ class WebContents : public ExclusiveAccessContext,
   const scoped_refptr<base::TaskRunner> print_task_runner_;
 #endif
 
+  // Channels webContents.ipc has invoke handlers for.
+  base::flat_set<std::string> invoke_channels_;
+
+  // invoke() calls whose handler has not replied yet, by the id they were
+  // emitted with.
+  base::flat_map<int32_t, electron::mojom::ElectronApiIPC::InvokeCallback>
+      pending_invokes_;
+  int32_t last_invoke_id_ = 0;
+
+  IPCMetrics ipc_metrics_;
+
+  // Messages that arrived in batches and have not been emitted yet. They are
+  // emitted a few at a time, so that sync calls in the priority lane, input
+  // and painting do not have to wait for all of them.
+  base::circular_deque<
+      std::pair<content::GlobalRenderFrameHostId, mojom::IPCMessagePtr>>
+      queued_ipc_messages_;
+  bool ipc_dispatch_scheduled_ = false;
+
+  base::TimeDelta sync_ipc_warning_threshold_ = base::Milliseconds(100);
+
+  bool direct_send_to_ = false;
+
+  // The renderers sending directly to a main frame of this WebContents, by the
+  // ID of their WebContents. They are closed when the frame is replaced, or
+  // when the sender turns directSendTo off.
+  struct DirectIPCSender {
+    DirectIPCSender();
+    DirectIPCSender(DirectIPCSender&&);
+    DirectIPCSender& operator=(DirectIPCSender&&);
+    ~DirectIPCSender();
+
+    int32_t sender_id;
+    content::GlobalRenderFrameHostId frame_id;
+    mojo::Remote<mojom::ElectronDirectIPCSender> remote;
+  };
+  std::vector<DirectIPCSender> direct_ipc_senders_;
+
   // Stores the frame thats currently in fullscreen, nullptr if there is none.
   raw_ptr<content::RenderFrameHost> fullscreen_frame_ = nullptr;
 
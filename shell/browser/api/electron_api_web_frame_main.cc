@@ -11,8 +11,11 @@
 
 #include "base/logging.h"
 #include "base/no_destructor.h"
+#include "content/browser/child_process_security_policy_impl.h"  // nogncheck
+#include "content/browser/process_lock.h"  // nogncheck
 #include "content/browser/renderer_host/render_frame_host_impl.h"  // nogncheck
 #include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/render_process_host.h"
 #include "content/public/common/isolated_world_ids.h"
 #include "electron/shell/common/api/api.mojom.h"
 #include "gin/object_template_builder.h"
@@ -20,6 +23,7 @@
 #include "shell/browser/api/message_port.h"
 #include "shell/browser/browser.h"
 #include "shell/browser/javascript_environment.h"
+#include "shell/common/api/electron_api_serialized_message.h"
 #include "shell/common/gin_converters/blink_converter.h"
 #include "shell/common/gin_converters/frame_converter.h"
 #include "shell/common/gin_converters/gurl_converter.h"
@@ -188,6 +192,22 @@ void WebFrameMain::Send(v8::Isolate* isolate,
                             0 /* sender_id */);
 }
 
+void WebFrameMain::Forward(gin_helper::ErrorThrower thrower,
+                           const std::string& channel,
+                           v8::Local<v8::Value> message) {
+  SerializedMessage* serialized_message = nullptr;
+  if (!gin::ConvertFromV8(thrower.isolate(), message, &serialized_message)) {
+    thrower.ThrowTypeError("Expected a SerializedMessage");
+    return;
+  }
+
+  if (!CheckRenderFrame())
+    return;
+
+  GetRendererApi()->Message(false /* internal */, channel,
+                            serialized_message->Clone(), 0 /* sender_id */);
+}
+
 const mojo::Remote<mojom::ElectronRenderer>& WebFrameMain::GetRendererApi() {
   MaybeSetupMojoConnection();
   return renderer_api_;
@@ -231,22 +251,24 @@ void WebFrameMain::PostMessage(v8::Isolate* isolate,
                                const std::string& channel,
                                v8::Local<v8::Value> message_value,
                                absl::optional<v8::Local<v8::Value>> transfer) {
-  blink::TransferableMessage transferable_message;
-  if (!electron::SerializeV8Value(isolate, message_value,
-                                  &transferable_message)) {
-    // SerializeV8Value sets an exception.
-    return;
-  }
-
   std::vector<gin::Handle<MessagePort>> wrapped_ports;
+  std::vector<v8::Local<v8::ArrayBuffer>> array_buffers;
   if (transfer && !transfer.value()->IsUndefined()) {
-    if (!gin::ConvertFromV8(isolate, *transfer, &wrapped_ports)) {
+    if (!MessagePort::GetTransferables(isolate, *transfer, &wrapped_ports,
+                                       &array_buffers)) {
       isolate->ThrowException(v8::Exception::Error(
           gin::StringToV8(isolate, "Invalid value for transfer")));
       return;
     }
   }
 
+  blink::TransferableMessage transferable_message;
+  if (!electron::SerializeV8Value(isolate, message_value, array_buffers,
+                                  &transferable_message)) {
+    // SerializeV8Value sets an exception.
+    return;
+  }
+
   bool threw_exception = false;
   transferable_message.ports =
       MessagePort::DisentanglePorts(isolate, wrapped_ports, &threw_exception);
@@ -258,6 +280,15 @@ void WebFrameMain::PostMessage(v8::Isolate* isolate,
 
   GetRendererApi()->ReceivePostMessage(channel,
                                        std::move(transferable_message));
+  electron::DetachArrayBuffers(isolate, array_buffers);
+}
+
+void WebFrameMain::SetInvokeHandlerRegistered(const std::string& channel,
+                                              bool registered) {
+  if (registered)
+    invoke_channels_.insert(channel);
+  else
+    invoke_channels_.erase(channel);
 }
 
 int WebFrameMain::FrameTreeNodeID() const {
@@ -302,6 +333,17 @@ std::string WebFrameMain::Origin() const {
   return render_frame_->GetLastCommittedOrigin().Serialize();
 }
 
+absl::optional<std::string> WebFrameMain::GetProcessLock() const {
+  if (!CheckRenderFrame())
+    return absl::nullopt;
+  const content::ProcessLock process_lock =
+      content::ChildProcessSecurityPolicyImpl::GetInstance()->GetProcessLock(
+          render_frame_->GetProcess()->GetID());
+  if (!process_lock.is_locked_to_site())
+    return absl::nullopt;
+  return process_lock.ToString();
+}
+
 blink::mojom::PageVisibilityState WebFrameMain::VisibilityState() const {
   if (!CheckRenderFrame())
     return blink::mojom::PageVisibilityState::kHidden;
@@ -392,7 +434,11 @@ void WebFrameMain::FillObjectTemplate(v8::Isolate* isolate,
       .SetMethod("executeJavaScript", &WebFrameMain::ExecuteJavaScript)
       .SetMethod("reload", &WebFrameMain::Reload)
       .SetMethod("_send", &WebFrameMain::Send)
+      .SetMethod("forward", &WebFrameMain::Forward)
       .SetMethod("_postMessage", &WebFrameMain::PostMessage)
+      .SetMethod("_setInvokeHandlerRegistered",
+                 &WebFrameMain::SetInvokeHandlerRegistered)
+      .SetMethod("_getProcessLock", &WebFrameMain::GetProcessLock)
       .SetProperty("frameTreeNodeId", &WebFrameMain::FrameTreeNodeID)
       .SetProperty("name", &WebFrameMain::Name)
       .SetProperty("osProcessId", &WebFrameMain::OSProcessID)
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/flat_set.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/process/process.h"
@@ -17,6 +18,7 @@
 #include "shell/browser/event_emitter_mixin.h"
 #include "shell/common/gin_helper/constructible.h"
 #include "shell/common/gin_helper/pinnable.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/blink/public/mojom/page/page_visibility_state.mojom-forward.h"
 
 class GURL;
@@ -29,6 +31,10 @@ namespace gin {
 class Arguments;
 }
 
+namespace gin_helper {
+class ErrorThrower;
+}
+
 namespace electron::api {
 
 class WebContents;
@@ -97,11 +103,22 @@ class WebFrameMain : public gin::Wrappable<WebFrameMain>,
             bool internal,
             const std::string& channel,
             v8::Local<v8::Value> args);
+  // Sends the arguments a SerializedMessage holds, as they were received.
+  void Forward(gin_helper::ErrorThrower thrower,
+               const std::string& channel,
+               v8::Local<v8::Value> message);
   void PostMessage(v8::Isolate* isolate,
                    const std::string& channel,
                    v8::Local<v8::Value> message_value,
                    absl::optional<v8::Local<v8::Value>> transfer);
 
+  // Mirrors the channels webFrameMain.ipc has handlers for, which lets
+  // WebContents::Invoke route invoke() calls without entering JavaScript.
+  void SetInvokeHandlerRegistered(const std::string& channel, bool registered);
+  bool HasInvokeHandler(const std::string& channel) const {
+    return invoke_channels_.contains(channel);
+  }
+
   int FrameTreeNodeID() const;
   std::string Name() const;
   base::ProcessId OSProcessID() const;
@@ -109,6 +126,10 @@ class WebFrameMain : public gin::Wrappable<WebFrameMain>,
   int RoutingID() const;
   GURL URL() const;
   std::string Origin() const;
+  // Describes the site the frame's process is locked to, or returns null when
+  // the process may host other sites too. Data a renderer hands back is only
+  // trusted for the renderers that share its lock.
+  absl::optional<std::string> GetProcessLock() const;
   blink::mojom::PageVisibilityState VisibilityState() const;
 
   content::RenderFrameHost* Top() const;
@@ -123,6 +144,8 @@ class WebFrameMain : public gin::Wrappable<WebFrameMain>,
 
   int frame_tree_node_id_;
 
+  base::flat_set<std::string> invoke_channels_;
+
   raw_ptr<content::RenderFrameHost> render_frame_ = nullptr;
 
   // Whether the RenderFrameHost has been removed and that it should no longer
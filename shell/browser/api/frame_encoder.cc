@@ -0,0 +1,133 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/api/frame_encoder.h"
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "base/functional/callback_helpers.h"
+#include "base/logging.h"
+#include "media/base/bitrate.h"
+#include "media/base/video_frame.h"
+#include "media/media_buildflags.h"
+#include "media/video/offloading_video_encoder.h"
+#include "shell/common/gin_helper/dictionary.h"
+#include "shell/common/node_includes.h"
+
+#if BUILDFLAG(ENABLE_LIBVPX)
+#include "media/video/vpx_video_encoder.h"
+#endif
+
+namespace electron::api {
+
+namespace {
+
+// Frames are only captured when the page changes, so the interval is counted
+// in frames rather than in time.
+constexpr int kKeyFrameInterval = 60;
+
+}  // namespace
+
+// static
+absl::optional<media::VideoCodec> FrameEncoder::ParseCodec(
+    const std::string& name) {
+  if (name == "vp8")
+    return media::VideoCodec::kVP8;
+  if (name == "vp9")
+    return media::VideoCodec::kVP9;
+  return absl::nullopt;
+}
+
+// static
+bool FrameEncoder::IsSupported() {
+#if BUILDFLAG(ENABLE_LIBVPX)
+  return true;
+#else
+  return false;
+#endif
+}
+
+FrameEncoder::FrameEncoder(media::VideoCodec codec,
+                           const gfx::Size& frame_size,
+                           uint32_t bitrate,
+                           const ChunkCallback& callback)
+    : callback_(callback) {
+  DCHECK(IsSupported());
+#if BUILDFLAG(ENABLE_LIBVPX)
+  // The offloading encoder runs the libvpx encoder on a worker sequence, and
+  // posts its callbacks back to this one.
+  encoder_ = std::make_unique<media::OffloadingVideoEncoder>(
+      std::make_unique<media::VpxVideoEncoder>());
+
+  media::VideoEncoder::Options options;
+  options.frame_size = frame_size;
+  options.keyframe_interval = kKeyFrameInterval;
+  if (bitrate)
+    options.bitrate = media::Bitrate::ConstantBitrate(bitrate);
+
+  encoder_->Initialize(
+      codec == media::VideoCodec::kVP9 ? media::VP9PROFILE_PROFILE0
+                                       : media::VP8PROFILE_ANY,
+      options, base::DoNothing(),
+      base::BindRepeating(&FrameEncoder::OnOutput,
+                          weak_ptr_factory_.GetWeakPtr()),
+      base::BindOnce(&FrameEncoder::OnDone, weak_ptr_factory_.GetWeakPtr()));
+#endif
+}
+
+FrameEncoder::~FrameEncoder() = default;
+
+void FrameEncoder::Encode(scoped_refptr<media::VideoFrame> frame) {
+  if (!encoder_ || failed_)
+    return;
+  // The capturer does not reuse the memory of frames that are waiting to be
+  // encoded, so it drops frames on its own when the encoder falls behind.
+  encoder_->Encode(
+      std::move(frame), media::VideoEncoder::EncodeOptions(false),
+      base::BindOnce(&FrameEncoder::OnDone, weak_ptr_factory_.GetWeakPtr()));
+}
+
+// static
+void FrameEncoder::FlushAndDelete(std::unique_ptr<FrameEncoder> encoder) {
+  media::VideoEncoder* video_encoder = encoder->encoder_.get();
+  if (!video_encoder)
+    return;
+  video_encoder->Flush(base::BindOnce(
+      [](std::unique_ptr<FrameEncoder> encoder, media::EncoderStatus status) {},
+      std::move(encoder)));
+}
+
+void FrameEncoder::OnOutput(
+    media::VideoEncoderOutput output,
+    absl::optional<media::VideoEncoder::CodecDescription> description) {
+  callback_.Run(output);
+}
+
+void FrameEncoder::OnDone(media::EncoderStatus status) {
+  if (status.is_ok() || failed_)
+    return;
+  LOG(ERROR) << "Failed to encode frames: " << status.message();
+  failed_ = true;
+}
+
+}  // namespace electron::api
+
+namespace gin {
+
+// static
+v8::Local<v8::Value> Converter<media::VideoEncoderOutput>::ToV8(
+    v8::Isolate* isolate,
+    const media::VideoEncoderOutput& output) {
+  gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+  dict.Set("data", node::Buffer::Copy(isolate,
+                                      reinterpret_cast<char*>(output.data.get()),
+                                      output.size)
+                       .ToLocalChecked());
+  dict.Set("keyFrame", output.key_frame);
+  dict.Set("timestamp", output.timestamp.InMillisecondsF());
+  return dict.GetHandle();
+}
+
+}  // namespace gin
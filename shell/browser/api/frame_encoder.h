@@ -0,0 +1,86 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_BROWSER_API_FRAME_ENCODER_H_
+#define ELECTRON_SHELL_BROWSER_API_FRAME_ENCODER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "base/functional/callback.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "gin/converter.h"
+#include "media/base/video_codecs.h"
+#include "media/base/video_encoder.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "ui/gfx/geometry/size.h"
+
+namespace media {
+class VideoFrame;
+}
+
+namespace electron::api {
+
+// Encodes the frames of a FrameSubscriber with a software video encoder. The
+// encoder runs on a worker sequence; the encoded chunks are passed back on the
+// sequence the FrameEncoder was created on.
+class FrameEncoder {
+ public:
+  using ChunkCallback =
+      base::RepeatingCallback<void(const media::VideoEncoderOutput&)>;
+
+  // Parses the name of a codec frames can be encoded with: "vp8" or "vp9".
+  static absl::optional<media::VideoCodec> ParseCodec(const std::string& name);
+
+  // Whether this build has the software encoders.
+  static bool IsSupported();
+
+  // A |bitrate| of 0 leaves it to the encoder.
+  FrameEncoder(media::VideoCodec codec,
+               const gfx::Size& frame_size,
+               uint32_t bitrate,
+               const ChunkCallback& callback);
+  ~FrameEncoder();
+
+  // disable copy
+  FrameEncoder(const FrameEncoder&) = delete;
+  FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+  // Queues |frame| to be encoded. It is released once the encoder is done
+  // with it.
+  void Encode(scoped_refptr<media::VideoFrame> frame);
+
+  // Encodes the frames that are still queued, passes their chunks on, and
+  // then deletes |encoder|.
+  static void FlushAndDelete(std::unique_ptr<FrameEncoder> encoder);
+
+ private:
+  void OnOutput(
+      media::VideoEncoderOutput output,
+      absl::optional<media::VideoEncoder::CodecDescription> description);
+  void OnDone(media::EncoderStatus status);
+
+  ChunkCallback callback_;
+  std::unique_ptr<media::VideoEncoder> encoder_;
+  // Set once the encoder has failed, after which frames are dropped.
+  bool failed_ = false;
+
+  base::WeakPtrFactory<FrameEncoder> weak_ptr_factory_{this};
+};
+
+}  // namespace electron::api
+
+namespace gin {
+
+template <>
+struct Converter<media::VideoEncoderOutput> {
+  static v8::Local<v8::Value> ToV8(v8::Isolate* isolate,
+                                   const media::VideoEncoderOutput& output);
+};
+
+}  // namespace gin
+
+#endif  // ELECTRON_SHELL_BROWSER_API_FRAME_ENCODER_H_
@@ -6,13 +6,17 @@
 
 #include <utility>
 
+#include "base/functional/callback_helpers.h"
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/render_widget_host.h"
 #include "content/public/browser/render_widget_host_view.h"
+#include "media/base/video_frame.h"
 #include "media/capture/mojom/video_capture_buffer.mojom.h"
 #include "media/capture/mojom/video_capture_types.mojom.h"
 #include "mojo/public/cpp/bindings/remote.h"
 #include "services/viz/privileged/mojom/compositing/frame_sink_video_capture.mojom-shared.h"
+#include "shell/browser/yuv_frame.h"
+#include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size_conversions.h"
 #include "ui/gfx/image/image.h"
 #include "ui/gfx/skbitmap_operations.h"
@@ -30,7 +34,33 @@ FrameSubscriber::FrameSubscriber(content::WebContents* web_contents,
   AttachToHost(web_contents->GetPrimaryMainFrame()->GetRenderWidgetHost());
 }
 
-FrameSubscriber::~FrameSubscriber() = default;
+FrameSubscriber::FrameSubscriber(content::WebContents* web_contents,
+                                 const YUVFrameCaptureCallback& callback,
+                                 media::VideoPixelFormat format)
+    : content::WebContentsObserver(web_contents),
+      yuv_callback_(callback),
+      format_(format) {
+  AttachToHost(web_contents->GetPrimaryMainFrame()->GetRenderWidgetHost());
+}
+
+FrameSubscriber::FrameSubscriber(content::WebContents* web_contents,
+                                 const FrameEncoder::ChunkCallback& callback,
+                                 media::VideoCodec codec,
+                                 uint32_t bitrate)
+    : content::WebContentsObserver(web_contents),
+      format_(media::PIXEL_FORMAT_I420),
+      chunk_callback_(callback),
+      codec_(codec),
+      bitrate_(bitrate) {
+  AttachToHost(web_contents->GetPrimaryMainFrame()->GetRenderWidgetHost());
+}
+
+FrameSubscriber::~FrameSubscriber() {
+  // The frames that are still being encoded are passed on before the encoder
+  // goes away.
+  if (encoder_)
+    FrameEncoder::FlushAndDelete(std::move(encoder_));
+}
 
 void FrameSubscriber::AttachToHost(content::RenderWidgetHost* host) {
   host_ = host;
@@ -42,11 +72,25 @@ void FrameSubscriber::AttachToHost(content::RenderWidgetHost* host) {
 
   // Create and configure the video capturer.
   gfx::Size size = GetRenderViewSize();
+  if (codec_ != media::VideoCodec::kUnknown) {
+    if (!encoder_) {
+      // I420 frames have their chroma subsampled by two.
+      encode_size_ =
+          gfx::Size((size.width() + 1) & ~1, (size.height() + 1) & ~1);
+      encoder_ = std::make_unique<FrameEncoder>(codec_, encode_size_, bitrate_,
+                                                chunk_callback_);
+    }
+    size = encode_size_;
+  }
   video_capturer_ = host_->GetView()->CreateVideoCapturer();
   video_capturer_->SetResolutionConstraints(size, size, true);
   video_capturer_->SetAutoThrottlingEnabled(false);
   video_capturer_->SetMinSizeChangePeriod(base::TimeDelta());
-  video_capturer_->SetFormat(media::PIXEL_FORMAT_ARGB);
+  // NV12 frames are captured in I420, and have their chroma planes
+  // interleaved when they are copied out for JS.
+  video_capturer_->SetFormat(format_ == media::PIXEL_FORMAT_ARGB
+                                 ? media::PIXEL_FORMAT_ARGB
+                                 : media::PIXEL_FORMAT_I420);
   video_capturer_->SetMinCapturePeriod(base::Seconds(1) / kMaxFrameRate);
   video_capturer_->Start(this, viz::mojom::BufferFormatPreference::kDefault);
 }
@@ -86,8 +130,9 @@ void FrameSubscriber::OnFrameCaptured(
         callbacks) {
   auto& data_region = data->get_read_only_shmem_region();
 
+  // Encoded frames keep their size, and have the page scaled to fit them.
   gfx::Size size = GetRenderViewSize();
-  if (size != content_rect.size()) {
+  if (!encoder_ && size != content_rect.size()) {
     video_capturer_->SetResolutionConstraints(size, size, true);
     video_capturer_->RequestRefreshFrame();
     return;
@@ -110,6 +155,37 @@ void FrameSubscriber::OnFrameCaptured(
     return;
   }
 
+  if (encoder_) {
+    if (!gfx::Rect(info->coded_size).Contains(gfx::Rect(encode_size_))) {
+      callbacks_remote->Done();
+      return;
+    }
+    scoped_refptr<media::VideoFrame> frame =
+        media::VideoFrame::WrapExternalData(
+            media::PIXEL_FORMAT_I420, info->coded_size, gfx::Rect(encode_size_),
+            encode_size_, static_cast<const uint8_t*>(mapping.memory()),
+            mapping.size(), info->timestamp);
+    if (!frame) {
+      callbacks_remote->Done();
+      return;
+    }
+    frame->set_color_space(info->color_space);
+    // The frame is encoded straight out of the capturer's memory, which is
+    // handed back once the encoder is done with it, on the encoder's
+    // sequence.
+    frame->AddDestructionObserver(base::DoNothingWithBoundArgs(
+        std::move(mapping), callbacks_remote.Unbind()));
+    encoder_->Encode(std::move(frame));
+    return;
+  }
+
+  if (format_ != media::PIXEL_FORMAT_ARGB) {
+    yuv_callback_.Run(YUVFrame(format_, std::move(mapping), *info, content_rect,
+                               callbacks_remote.Unbind()),
+                      content_rect);
+    return;
+  }
+
   // The SkBitmap's pixels will be marked as immutable, but the installPixels()
   // API requires a non-const pointer. So, cast away the const.
   void* const pixels = const_cast<void*>(mapping.memory());
@@ -14,8 +14,11 @@
 #include "components/viz/host/client_frame_sink_video_capturer.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/browser/web_contents_observer.h"
+#include "media/base/video_codecs.h"
+#include "media/base/video_types.h"
 #include "media/capture/mojom/video_capture_buffer.mojom-forward.h"
 #include "mojo/public/cpp/bindings/pending_remote.h"
+#include "shell/browser/api/frame_encoder.h"
 #include "v8/include/v8.h"
 
 namespace gfx {
@@ -23,6 +26,10 @@ class Image;
 class Rect;
 }  // namespace gfx
 
+namespace electron {
+class YUVFrame;
+}
+
 namespace electron::api {
 
 class WebContents;
@@ -32,10 +39,22 @@ class FrameSubscriber : public content::WebContentsObserver,
  public:
   using FrameCaptureCallback =
       base::RepeatingCallback<void(const gfx::Image&, const gfx::Rect&)>;
+  using YUVFrameCaptureCallback =
+      base::RepeatingCallback<void(const YUVFrame&, const gfx::Rect&)>;
 
   FrameSubscriber(content::WebContents* web_contents,
                   const FrameCaptureCallback& callback,
                   bool only_dirty);
+  // Captures whole frames in |format|, either I420 or NV12.
+  FrameSubscriber(content::WebContents* web_contents,
+                  const YUVFrameCaptureCallback& callback,
+                  media::VideoPixelFormat format);
+  // Encodes the frames with |codec|, at the size the page has when the
+  // subscription starts. A |bitrate| of 0 leaves it to the encoder.
+  FrameSubscriber(content::WebContents* web_contents,
+                  const FrameEncoder::ChunkCallback& callback,
+                  media::VideoCodec codec,
+                  uint32_t bitrate);
   ~FrameSubscriber() override;
 
   // disable copy
@@ -68,7 +87,17 @@ class FrameSubscriber : public content::WebContentsObserver,
   gfx::Size GetRenderViewSize() const;
 
   FrameCaptureCallback callback_;
-  bool only_dirty_;
+  YUVFrameCaptureCallback yuv_callback_;
+  bool only_dirty_ = false;
+  const media::VideoPixelFormat format_ = media::PIXEL_FORMAT_ARGB;
+
+  FrameEncoder::ChunkCallback chunk_callback_;
+  const media::VideoCodec codec_ = media::VideoCodec::kUnknown;
+  const uint32_t bitrate_ = 0;
+  // The size frames are encoded at, which stays the same when the page is
+  // resized so the stream does not need a new key frame.
+  gfx::Size encode_size_;
+  std::unique_ptr<FrameEncoder> encoder_;
 
   raw_ptr<content::RenderWidgetHost> host_;
   std::unique_ptr<viz::ClientFrameSinkVideoCapturer> video_capturer_;
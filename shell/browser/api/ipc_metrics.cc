@@ -0,0 +1,141 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/api/ipc_metrics.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "base/functional/bind.h"
+#include "base/ranges/algorithm.h"
+#include "gin/converter.h"
+#include "gin/data_object_builder.h"
+
+namespace electron {
+
+namespace {
+
+constexpr char kOverflowChannel[] = "*";
+
+}  // namespace
+
+void IPCMetrics::Histogram::Add(base::TimeDelta sample) {
+  const int64_t micros = sample.InMicroseconds();
+  const size_t bucket =
+      base::ranges::lower_bound(kBucketBounds, micros) - kBucketBounds.begin();
+  ++buckets[bucket];
+  ++count;
+  total += sample;
+  max = std::max(max, sample);
+}
+
+v8::Local<v8::Value> IPCMetrics::Histogram::ToV8(v8::Isolate* isolate) const {
+  std::vector<v8::Local<v8::Value>> bucket_objects;
+  bucket_objects.reserve(buckets.size());
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    const double bound = i < kBucketBounds.size()
+                             ? kBucketBounds[i] / 1000.0
+                             : std::numeric_limits<double>::infinity();
+    bucket_objects.push_back(gin::DataObjectBuilder(isolate)
+                                 .Set("max", bound)
+                                 .Set("count", buckets[i])
+                                 .Build());
+  }
+  return gin::DataObjectBuilder(isolate)
+      .Set("count", count)
+      .Set("total", total.InMillisecondsF())
+      .Set("max", max.InMillisecondsF())
+      .Set("buckets", bucket_objects)
+      .Build();
+}
+
+IPCMetrics::IPCMetrics() = default;
+
+IPCMetrics::~IPCMetrics() = default;
+
+void IPCMetrics::RecordMessage(bool internal,
+                               const std::string& channel,
+                               size_t bytes) {
+  ChannelMetrics& metrics = GetChannelMetrics(internal, channel);
+  ++metrics.count;
+  metrics.bytes += bytes;
+  ++total_count_;
+  total_bytes_ += bytes;
+}
+
+IPCMetrics::ReplyCallback IPCMetrics::TimeReply(ReplyType type,
+                                                bool internal,
+                                                const std::string& channel,
+                                                ReplyCallback callback) {
+  // The reply has to be sent even when the metrics are gone by then, so this
+  // can not be bound to the weak pointer directly.
+  return base::BindOnce(
+      [](base::WeakPtr<IPCMetrics> metrics, ReplyType type,
+         const ChannelKey& key, base::TimeTicks start, ReplyCallback callback,
+         blink::CloneableMessage result) {
+        if (metrics)
+          metrics->RecordReply(type, key, start);
+        std::move(callback).Run(std::move(result));
+      },
+      weak_factory_.GetWeakPtr(), type, ChannelKey(internal, channel),
+      base::TimeTicks::Now(), std::move(callback));
+}
+
+void IPCMetrics::Clear() {
+  channels_.clear();
+  overflow_ = ChannelMetrics();
+  internal_overflow_ = ChannelMetrics();
+  total_count_ = 0;
+  total_bytes_ = 0;
+  // Replies to messages received before now are not counted either.
+  weak_factory_.InvalidateWeakPtrs();
+}
+
+v8::Local<v8::Value> IPCMetrics::ToV8(v8::Isolate* isolate) const {
+  auto to_v8 = [isolate](bool internal, const std::string& channel,
+                         const ChannelMetrics& metrics) {
+    return gin::DataObjectBuilder(isolate)
+        .Set("channel", channel)
+        .Set("internal", internal)
+        .Set("count", metrics.count)
+        .Set("bytes", metrics.bytes)
+        .Set("invoke", metrics.invoke.ToV8(isolate))
+        .Set("sync", metrics.sync.ToV8(isolate))
+        .Build();
+  };
+  std::vector<v8::Local<v8::Value>> result;
+  result.reserve(channels_.size() + 2);
+  for (const auto& [key, metrics] : channels_)
+    result.push_back(to_v8(key.first, key.second, metrics));
+  if (overflow_.count)
+    result.push_back(to_v8(false, kOverflowChannel, overflow_));
+  if (internal_overflow_.count)
+    result.push_back(to_v8(true, kOverflowChannel, internal_overflow_));
+  return gin::ConvertToV8(isolate, result);
+}
+
+IPCMetrics::ChannelMetrics& IPCMetrics::GetChannelMetrics(
+    bool internal,
+    base::StringPiece channel) {
+  auto it = channels_.find(std::make_pair(internal, channel));
+  if (it != channels_.end())
+    return it->second;
+  if (channels_.size() >= kMaxChannels)
+    return internal ? internal_overflow_ : overflow_;
+  return channels_
+      .emplace(ChannelKey(internal, std::string(channel)), ChannelMetrics())
+      .first->second;
+}
+
+void IPCMetrics::RecordReply(ReplyType type,
+                             const ChannelKey& key,
+                             base::TimeTicks start) {
+  ChannelMetrics& metrics = GetChannelMetrics(key.first, key.second);
+  Histogram& histogram =
+      type == ReplyType::kInvoke ? metrics.invoke : metrics.sync;
+  histogram.Add(base::TimeTicks::Now() - start);
+}
+
+}  // namespace electron
@@ -0,0 +1,113 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_BROWSER_API_IPC_METRICS_H_
+#define ELECTRON_SHELL_BROWSER_API_IPC_METRICS_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "base/containers/flat_map.h"
+#include "base/functional/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "third_party/blink/public/common/messaging/cloneable_message.h"
+#include "v8/include/v8-forward.h"
+
+namespace electron {
+
+// Per-channel counters for the IPC a WebContents receives from its frames.
+// Recording costs a map lookup and a few additions, so it is always on.
+class IPCMetrics {
+ public:
+  enum class ReplyType { kInvoke, kSync };
+  using ReplyCallback = base::OnceCallback<void(blink::CloneableMessage)>;
+
+  // Channels seen after this many are counted together under "*", separately
+  // for internal and other channels, so that a renderer making up channel
+  // names can not grow the table without bound.
+  static constexpr size_t kMaxChannels = 1000;
+
+  IPCMetrics();
+  ~IPCMetrics();
+
+  // disable copy
+  IPCMetrics(const IPCMetrics&) = delete;
+  IPCMetrics& operator=(const IPCMetrics&) = delete;
+
+  // Counts a message on |channel| whose arguments serialized to |bytes|.
+  void RecordMessage(bool internal, const std::string& channel, size_t bytes);
+
+  // Returns a callback that records how long |callback| took to be run, from
+  // now, before running it.
+  ReplyCallback TimeReply(ReplyType type,
+                          bool internal,
+                          const std::string& channel,
+                          ReplyCallback callback);
+
+  void Clear();
+
+  // Returns an IPCChannelMetrics object for every channel.
+  v8::Local<v8::Value> ToV8(v8::Isolate* isolate) const;
+
+  uint64_t total_count() const { return total_count_; }
+  uint64_t total_bytes() const { return total_bytes_; }
+
+ private:
+  // Upper bounds of the latency buckets, in microseconds. The last bucket has
+  // no upper bound.
+  static constexpr std::array<int64_t, 10> kBucketBounds = {
+      100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000};
+
+  struct Histogram {
+    void Add(base::TimeDelta sample);
+    v8::Local<v8::Value> ToV8(v8::Isolate* isolate) const;
+
+    std::array<uint64_t, kBucketBounds.size() + 1> buckets = {};
+    uint64_t count = 0;
+    base::TimeDelta total;
+    base::TimeDelta max;
+  };
+
+  struct ChannelMetrics {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    Histogram invoke;
+    Histogram sync;
+  };
+
+  using ChannelKey = std::pair<bool, std::string>;
+
+  // Lets channels be looked up without copying their name into a ChannelKey.
+  struct ChannelKeyLess {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+      return std::tie(a.first, a.second) < std::tie(b.first, b.second);
+    }
+  };
+
+  ChannelMetrics& GetChannelMetrics(bool internal, base::StringPiece channel);
+
+  void RecordReply(ReplyType type,
+                   const ChannelKey& key,
+                   base::TimeTicks start);
+
+  base::flat_map<ChannelKey, ChannelMetrics, ChannelKeyLess> channels_;
+  ChannelMetrics overflow_;
+  ChannelMetrics internal_overflow_;
+  uint64_t total_count_ = 0;
+  uint64_t total_bytes_ = 0;
+
+  base::WeakPtrFactory<IPCMetrics> weak_factory_{this};
+};
+
+}  // namespace electron
+
+#endif  // ELECTRON_SHELL_BROWSER_API_IPC_METRICS_H_
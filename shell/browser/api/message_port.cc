@@ -76,30 +76,32 @@ void MessagePort::PostMessage(gin::Arguments* args) {
     return;
   }
 
-  electron::SerializeV8Value(args->isolate(), message_value,
-                             &transferable_message);
-
   v8::Local<v8::Value> transferables;
   std::vector<gin::Handle<MessagePort>> wrapped_ports;
+  std::vector<v8::Local<v8::ArrayBuffer>> array_buffers;
   if (args->GetNext(&transferables)) {
-    std::vector<v8::Local<v8::Value>> wrapped_port_values;
+    std::vector<v8::Local<v8::Value>> transferable_values;
     if (!gin::ConvertFromV8(args->isolate(), transferables,
-                            &wrapped_port_values)) {
-      thrower.ThrowTypeError("transferables must be an array of MessagePorts");
+                            &transferable_values)) {
+      thrower.ThrowTypeError(
+          "transferables must be an array of MessagePorts and ArrayBuffers");
       return;
     }
 
-    for (unsigned i = 0; i < wrapped_port_values.size(); ++i) {
-      if (!IsValidWrappable(wrapped_port_values[i])) {
+    for (unsigned i = 0; i < transferable_values.size(); ++i) {
+      if (transferable_values[i]->IsArrayBuffer()) {
+        array_buffers.push_back(transferable_values[i].As<v8::ArrayBuffer>());
+        continue;
+      }
+      gin::Handle<MessagePort> port;
+      if (!IsValidWrappable(transferable_values[i]) ||
+          !gin::ConvertFromV8(args->isolate(), transferable_values[i],
+                              &port)) {
         thrower.ThrowTypeError("Port at index " + base::NumberToString(i) +
                                " is not a valid port");
         return;
       }
-    }
-
-    if (!gin::ConvertFromV8(args->isolate(), transferables, &wrapped_ports)) {
-      thrower.ThrowTypeError("Passed an invalid MessagePort");
-      return;
+      wrapped_ports.push_back(port);
     }
   }
 
@@ -112,6 +114,12 @@ void MessagePort::PostMessage(gin::Arguments* args) {
     }
   }
 
+  if (!electron::SerializeV8Value(args->isolate(), message_value,
+                                  array_buffers, &transferable_message)) {
+    // SerializeV8Value sets an exception.
+    return;
+  }
+
   bool threw_exception = false;
   transferable_message.ports = MessagePort::DisentanglePorts(
       args->isolate(), wrapped_ports, &threw_exception);
@@ -121,6 +129,7 @@ void MessagePort::PostMessage(gin::Arguments* args) {
   mojo::Message mojo_message = blink::mojom::TransferableMessage::WrapAsMessage(
       std::move(transferable_message));
   connector_->Accept(&mojo_message);
+  electron::DetachArrayBuffers(args->isolate(), array_buffers);
 }
 
 void MessagePort::Start() {
@@ -246,6 +255,28 @@ std::vector<blink::MessagePortChannel> MessagePort::DisentanglePorts(
   return channels;
 }
 
+// static
+bool MessagePort::GetTransferables(
+    v8::Isolate* isolate,
+    v8::Local<v8::Value> transfer,
+    std::vector<gin::Handle<MessagePort>>* ports,
+    std::vector<v8::Local<v8::ArrayBuffer>>* array_buffers) {
+  std::vector<v8::Local<v8::Value>> values;
+  if (!gin::ConvertFromV8(isolate, transfer, &values))
+    return false;
+  for (v8::Local<v8::Value> value : values) {
+    if (value->IsArrayBuffer()) {
+      array_buffers->push_back(value.As<v8::ArrayBuffer>());
+      continue;
+    }
+    gin::Handle<MessagePort> port;
+    if (!gin::ConvertFromV8(isolate, value, &port))
+      return false;
+    ports->push_back(port);
+  }
+  return true;
+}
+
 void MessagePort::Pin() {
   if (!pinned_.IsEmpty())
     return;
@@ -49,6 +49,14 @@ class MessagePort : public gin::Wrappable<MessagePort>, mojo::MessageReceiver {
       const std::vector<gin::Handle<MessagePort>>& ports,
       bool* threw_exception);
 
+  // Splits the transfer list |transfer| into the MessagePorts and the
+  // ArrayBuffers in it. Returns false if it holds anything else.
+  static bool GetTransferables(
+      v8::Isolate* isolate,
+      v8::Local<v8::Value> transfer,
+      std::vector<gin::Handle<MessagePort>>* ports,
+      std::vector<v8::Local<v8::ArrayBuffer>>* array_buffers);
+
   // gin::Wrappable
   gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
       v8::Isolate* isolate) override;
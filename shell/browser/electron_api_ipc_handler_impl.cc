@@ -8,6 +8,8 @@
 
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/remote.h"
 #include "mojo/public/cpp/bindings/self_owned_receiver.h"
 
 namespace electron {
@@ -45,6 +47,15 @@ void ElectronApiIPCHandlerImpl::Message(bool internal,
                               GetRenderFrameHost());
   }
 }
+
+void ElectronApiIPCHandlerImpl::MessageBatch(
+    std::vector<mojom::IPCMessagePtr> messages) {
+  api::WebContents* api_web_contents = api::WebContents::From(web_contents());
+  if (api_web_contents) {
+    api_web_contents->MessageBatch(std::move(messages), GetRenderFrameHost());
+  }
+}
+
 void ElectronApiIPCHandlerImpl::Invoke(bool internal,
                                        const std::string& channel,
                                        blink::CloneableMessage arguments,
@@ -66,17 +77,35 @@ void ElectronApiIPCHandlerImpl::ReceivePostMessage(
   }
 }
 
-void ElectronApiIPCHandlerImpl::MessageSync(bool internal,
-                                            const std::string& channel,
-                                            blink::CloneableMessage arguments,
-                                            MessageSyncCallback callback) {
+void ElectronApiIPCHandlerImpl::MessageSync(
+    bool internal,
+    const std::string& channel,
+    blink::CloneableMessage arguments,
+    mojom::SyncMessageOptionsPtr options,
+    MessageSyncCallback callback) {
   api::WebContents* api_web_contents = api::WebContents::From(web_contents());
   if (api_web_contents) {
     api_web_contents->MessageSync(internal, channel, std::move(arguments),
-                                  std::move(callback), GetRenderFrameHost());
+                                  std::move(options), std::move(callback),
+                                  GetRenderFrameHost());
   }
 }
 
+void ElectronApiIPCHandlerImpl::MessageSyncWithTimeout(
+    bool internal,
+    const std::string& channel,
+    blink::CloneableMessage arguments,
+    mojom::SyncMessageOptionsPtr options,
+    mojo::PendingRemote<mojom::SyncMessageReply> reply) {
+  MessageSync(internal, channel, std::move(arguments), std::move(options),
+              base::BindOnce(
+                  [](mojo::Remote<mojom::SyncMessageReply> reply,
+                     blink::CloneableMessage result) {
+                    reply->Reply(std::move(result));
+                  },
+                  mojo::Remote<mojom::SyncMessageReply>(std::move(reply))));
+}
+
 void ElectronApiIPCHandlerImpl::MessageTo(int32_t web_contents_id,
                                           const std::string& channel,
                                           blink::CloneableMessage arguments) {
@@ -95,6 +124,19 @@ void ElectronApiIPCHandlerImpl::MessageHost(const std::string& channel,
   }
 }
 
+void ElectronApiIPCHandlerImpl::ConnectTo(
+    int32_t web_contents_id,
+    mojo::PendingRemote<mojom::ElectronDirectIPCSender> sender,
+    ConnectToCallback callback) {
+  api::WebContents* api_web_contents = api::WebContents::From(web_contents());
+  if (api_web_contents) {
+    api_web_contents->ConnectTo(web_contents_id, std::move(sender),
+                                std::move(callback));
+  } else {
+    std::move(callback).Run(mojo::NullRemote());
+  }
+}
+
 content::RenderFrameHost* ElectronApiIPCHandlerImpl::GetRenderFrameHost() {
   return content::RenderFrameHost::FromID(render_process_id_, render_frame_id_);
 }
@@ -6,6 +6,7 @@
 #define ELECTRON_SHELL_BROWSER_ELECTRON_API_IPC_HANDLER_IMPL_H_
 
 #include <string>
+#include <vector>
 
 #include "base/memory/weak_ptr.h"
 #include "content/public/browser/web_contents_observer.h"
@@ -38,6 +39,7 @@ class ElectronApiIPCHandlerImpl : public mojom::ElectronApiIPC,
   void Message(bool internal,
                const std::string& channel,
                blink::CloneableMessage arguments) override;
+  void MessageBatch(std::vector<mojom::IPCMessagePtr> messages) override;
   void Invoke(bool internal,
               const std::string& channel,
               blink::CloneableMessage arguments,
@@ -47,12 +49,22 @@ class ElectronApiIPCHandlerImpl : public mojom::ElectronApiIPC,
   void MessageSync(bool internal,
                    const std::string& channel,
                    blink::CloneableMessage arguments,
+                   mojom::SyncMessageOptionsPtr options,
                    MessageSyncCallback callback) override;
+  void MessageSyncWithTimeout(
+      bool internal,
+      const std::string& channel,
+      blink::CloneableMessage arguments,
+      mojom::SyncMessageOptionsPtr options,
+      mojo::PendingRemote<mojom::SyncMessageReply> reply) override;
   void MessageTo(int32_t web_contents_id,
                  const std::string& channel,
                  blink::CloneableMessage arguments) override;
   void MessageHost(const std::string& channel,
                    blink::CloneableMessage arguments) override;
+  void ConnectTo(int32_t web_contents_id,
+                 mojo::PendingRemote<mojom::ElectronDirectIPCSender> sender,
+                 ConnectToCallback callback) override;
 
   base::WeakPtr<ElectronApiIPCHandlerImpl> GetWeakPtr() {
     return weak_factory_.GetWeakPtr();
@@ -5,11 +5,15 @@
 #include "shell/browser/net/asar/asar_url_loader.h"
 
 #include <algorithm>
+#include <cinttypes>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/command_line.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/task/thread_pool.h"
 #include "content/public/browser/file_url_loader.h"
@@ -22,11 +26,13 @@
 #include "net/base/mime_sniffer.h"
 #include "net/base/mime_util.h"
 #include "net/http/http_byte_range.h"
+#include "net/http/http_response_headers.h"
 #include "net/http/http_util.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
 #include "shell/browser/net/asar/asar_file_validator.h"
 #include "shell/common/asar/archive.h"
 #include "shell/common/asar/asar_util.h"
+#include "shell/common/options_switches.h"
 
 namespace asar {
 
@@ -50,12 +56,228 @@ net::Error ConvertMojoResultToNetError(MojoResult result) {
 }
 
 constexpr size_t kDefaultFileUrlPipeSize = 65536;
+constexpr size_t kMaxFileUrlPipeSize = 16 * 1024 * 1024;
 
 // Because this makes things simpler.
 static_assert(kDefaultFileUrlPipeSize >= net::kMaxBytesToSniff,
               "Default file data pipe size must be at least as large as a MIME-"
               "type sniffing buffer.");
 
+// Upper bound on the parts of a multipart/byteranges response, so that a
+// short request can not ask for an arbitrarily large one.
+constexpr size_t kMaxByteRanges = 64;
+
+// Returns the size of the data pipes responses are streamed through, which
+// can be raised with --asar-pipe-size for media and other large files.
+uint32_t GetFileUrlPipeSize() {
+  static const uint32_t pipe_size = [] {
+    std::string value =
+        base::CommandLine::ForCurrentProcess()->GetSwitchValueASCII(
+            electron::switches::kAsarPipeSize);
+    unsigned size;
+    if (value.empty() || !base::StringToUint(value, &size))
+      return static_cast<uint32_t>(kDefaultFileUrlPipeSize);
+    return static_cast<uint32_t>(std::clamp<size_t>(
+        size, net::kMaxBytesToSniff, kMaxFileUrlPipeSize));
+  }();
+  return pipe_size;
+}
+
+// Serves a range of a memory-mapped archive. Mirrors the offset semantics of
+// |mojo::FileDataSource|, with offsets relative to the start of the archive,
+// and keeps the archive (and so the mapping) alive until the producer is done.
+class MappedDataSource : public mojo::DataPipeProducer::DataSource {
+ public:
+  explicit MappedDataSource(std::shared_ptr<Archive> archive)
+      : archive_(std::move(archive)),
+        data_(archive_->GetMappedData()),
+        end_(data_.size()) {}
+  ~MappedDataSource() override = default;
+
+  // disable copy
+  MappedDataSource(const MappedDataSource&) = delete;
+  MappedDataSource& operator=(const MappedDataSource&) = delete;
+
+  void SetRange(uint64_t start, uint64_t end) {
+    start_ = std::min(start, static_cast<uint64_t>(data_.size()));
+    end_ = std::clamp(end, start_, static_cast<uint64_t>(data_.size()));
+  }
+
+  // mojo::DataPipeProducer::DataSource:
+  uint64_t GetLength() const override { return end_ - start_; }
+
+  ReadResult Read(uint64_t offset, base::span<char> buffer) override {
+    ReadResult result;
+    uint64_t position = start_ + offset;
+    if (position > end_) {
+      result.result = MOJO_RESULT_OUT_OF_RANGE;
+      return result;
+    }
+    size_t bytes_to_copy = static_cast<size_t>(
+        std::min(static_cast<uint64_t>(buffer.size()), end_ - position));
+    memcpy(buffer.data(), data_.data() + position, bytes_to_copy);
+    result.bytes_read = bytes_to_copy;
+    return result;
+  }
+
+ private:
+  std::shared_ptr<Archive> archive_;
+  base::span<const uint8_t> data_;
+  uint64_t start_ = 0;
+  uint64_t end_;
+};
+
+// Serves bytes of the archive that were read into memory and validated, with
+// offsets relative to the start of the archive. Serving them from the very
+// memory they were hashed in keeps the file from being changed in between.
+class ValidatedDataSource : public mojo::DataPipeProducer::DataSource {
+ public:
+  ValidatedDataSource() = default;
+  ~ValidatedDataSource() override = default;
+
+  // disable copy
+  ValidatedDataSource(const ValidatedDataSource&) = delete;
+  ValidatedDataSource& operator=(const ValidatedDataSource&) = delete;
+
+  bool Contains(uint64_t start, uint64_t end) const {
+    return std::any_of(chunks_.begin(), chunks_.end(), [&](const Chunk& chunk) {
+      return chunk.offset <= start && end <= chunk.offset + chunk.data.size();
+    });
+  }
+
+  void AddChunk(uint64_t offset, std::vector<char> data) {
+    length_ += data.size();
+    chunks_.push_back({offset, std::move(data)});
+  }
+
+  // mojo::DataPipeProducer::DataSource:
+  uint64_t GetLength() const override { return length_; }
+
+  ReadResult Read(uint64_t offset, base::span<char> buffer) override {
+    ReadResult result;
+    for (const Chunk& chunk : chunks_) {
+      if (offset < chunk.offset || offset >= chunk.offset + chunk.data.size())
+        continue;
+      uint64_t within = offset - chunk.offset;
+      size_t bytes_to_copy = static_cast<size_t>(std::min<uint64_t>(
+          buffer.size(), chunk.data.size() - within));
+      memcpy(buffer.data(), chunk.data.data() + within, bytes_to_copy);
+      result.bytes_read = bytes_to_copy;
+      return result;
+    }
+    result.result = MOJO_RESULT_OUT_OF_RANGE;
+    return result;
+  }
+
+ private:
+  struct Chunk {
+    uint64_t offset;
+    std::vector<char> data;
+  };
+
+  std::vector<Chunk> chunks_;
+  uint64_t length_ = 0;
+};
+
+// Serves several ranges of a file as the body of a multipart/byteranges
+// response. Each part is read from |source|, which must span the whole archive,
+// between the part headers and the closing delimiter that are generated here.
+class MultipartRangeDataSource : public mojo::DataPipeProducer::DataSource {
+ public:
+  MultipartRangeDataSource(
+      std::unique_ptr<mojo::DataPipeProducer::DataSource> source,
+      uint64_t file_offset,
+      uint64_t file_size,
+      const std::vector<net::HttpByteRange>& ranges,
+      const std::string& boundary,
+      const std::string& mime_type)
+      : source_(std::move(source)) {
+    for (const auto& range : ranges) {
+      AddText(base::StringPrintf(
+          "--%s\r\nContent-Type: %s\r\nContent-Range: bytes %" PRId64
+          "-%" PRId64 "/%" PRIu64 "\r\n\r\n",
+          boundary.c_str(), mime_type.c_str(), range.first_byte_position(),
+          range.last_byte_position(), file_size));
+      uint64_t length =
+          range.last_byte_position() - range.first_byte_position() + 1;
+      segments_.push_back(
+          {length_, length, file_offset + range.first_byte_position(), {}});
+      length_ += length;
+      AddText("\r\n");
+    }
+    AddText(base::StringPrintf("--%s--\r\n", boundary.c_str()));
+  }
+  ~MultipartRangeDataSource() override = default;
+
+  // disable copy
+  MultipartRangeDataSource(const MultipartRangeDataSource&) = delete;
+  MultipartRangeDataSource& operator=(const MultipartRangeDataSource&) = delete;
+
+  // mojo::DataPipeProducer::DataSource:
+  uint64_t GetLength() const override { return length_; }
+
+  ReadResult Read(uint64_t offset, base::span<char> buffer) override {
+    ReadResult result;
+    if (offset > length_) {
+      result.result = MOJO_RESULT_OUT_OF_RANGE;
+      return result;
+    }
+
+    // Find the segment |offset| falls into, then fill |buffer| from it and
+    // the segments after it.
+    auto it = std::upper_bound(
+        segments_.begin(), segments_.end(), offset,
+        [](uint64_t value, const Segment& segment) {
+          return value < segment.start;
+        });
+    if (it != segments_.begin())
+      --it;
+    size_t written = 0;
+    for (; it != segments_.end() && written < buffer.size(); ++it) {
+      uint64_t within = offset + written - it->start;
+      if (within >= it->length)
+        continue;
+      size_t count = static_cast<size_t>(
+          std::min<uint64_t>(buffer.size() - written, it->length - within));
+      base::span<char> out = buffer.subspan(written, count);
+      if (it->source_offset.has_value()) {
+        ReadResult part = source_->Read(*it->source_offset + within, out);
+        if (part.result != MOJO_RESULT_OK) {
+          result.result = part.result;
+          return result;
+        }
+        written += part.bytes_read;
+        if (part.bytes_read < count)
+          break;
+      } else {
+        memcpy(out.data(), it->text.data() + within, count);
+        written += count;
+      }
+    }
+    result.bytes_read = written;
+    return result;
+  }
+
+ private:
+  // A run of the body, either generated text or bytes of the source.
+  struct Segment {
+    uint64_t start;
+    uint64_t length;
+    absl::optional<uint64_t> source_offset;
+    std::string text;
+  };
+
+  void AddText(std::string text) {
+    uint64_t length = text.size();
+    segments_.push_back({length_, length, absl::nullopt, std::move(text)});
+    length_ += length;
+  }
+
+  std::unique_ptr<mojo::DataPipeProducer::DataSource> source_;
+  std::vector<Segment> segments_;
+  uint64_t length_ = 0;
+};
+
 // Modified from the |FileURLLoader| in |file_url_loader_factory.cc|, to serve
 // asar files instead of normal files.
 class AsarURLLoader : public network::mojom::URLLoader {
@@ -142,23 +364,65 @@ class AsarURLLoader : public network::mojom::URLLoader {
       info.offset = 0;
     }
 
+    std::string range_header;
+    std::vector<net::HttpByteRange> ranges;
+    if (request.headers.GetHeader(net::HttpRequestHeaders::kRange,
+                                  &range_header)) {
+      bool fail = !net::HttpUtil::ParseRangeHeader(range_header, &ranges) ||
+                  ranges.empty() || ranges.size() > kMaxByteRanges;
+      for (auto& range : ranges)
+        fail = fail || !range.ComputeBounds(info.size);
+
+      if (fail) {
+        OnClientComplete(net::ERR_REQUEST_RANGE_NOT_SATISFIABLE);
+        return;
+      }
+    }
+
     mojo::ScopedDataPipeProducerHandle producer_handle;
     mojo::ScopedDataPipeConsumerHandle consumer_handle;
-    if (mojo::CreateDataPipe(kDefaultFileUrlPipeSize, producer_handle,
+    if (mojo::CreateDataPipe(GetFileUrlPipeSize(), producer_handle,
                              consumer_handle) != MOJO_RESULT_OK) {
       OnClientComplete(net::ERR_FAILED);
       return;
     }
 
-    // Note that while the |Archive| already opens a |base::File|, we still need
-    // to create a new |base::File| here, as it might be accessed by multiple
-    // requests at the same time.
-    base::File file(info.unpacked ? real_path : archive->path(),
-                    base::File::FLAG_OPEN | base::File::FLAG_READ);
-    auto file_data_source =
-        std::make_unique<mojo::FileDataSource>(file.Duplicate());
+    // Packed files of a memory-mapped archive are served straight out of the
+    // mapping. Otherwise, note that while the |Archive| already opens a
+    // |base::File|, we still need to create a new |base::File| here, as it
+    // might be accessed by multiple requests at the same time.
+    bool use_mapping = archive->GetMappedContents(info).has_value();
+    base::File file;
+    if (!use_mapping || (is_verifying_file && ranges.size() <= 1)) {
+      file = base::File(info.unpacked ? real_path : archive->path(),
+                        base::File::FLAG_OPEN | base::File::FLAG_READ);
+    }
+
+    if (ranges.size() > 1) {
+      std::unique_ptr<mojo::DataPipeProducer::DataSource> source;
+      if (use_mapping)
+        source = std::make_unique<MappedDataSource>(archive);
+      else
+        source = std::make_unique<mojo::FileDataSource>(std::move(file));
+      StartMultipartResponse(request, path, info, std::move(source), ranges,
+                             std::move(head), std::move(producer_handle),
+                             std::move(consumer_handle));
+      return;
+    }
+    std::unique_ptr<mojo::DataPipeProducer::DataSource> source_data_source;
+    mojo::FileDataSource* file_data_source_raw = nullptr;
+    MappedDataSource* mapped_data_source_raw = nullptr;
+    if (use_mapping) {
+      auto mapped_data_source = std::make_unique<MappedDataSource>(archive);
+      mapped_data_source_raw = mapped_data_source.get();
+      source_data_source = std::move(mapped_data_source);
+    } else {
+      auto file_data_source =
+          std::make_unique<mojo::FileDataSource>(file.Duplicate());
+      file_data_source_raw = file_data_source.get();
+      source_data_source = std::move(file_data_source);
+    }
     std::unique_ptr<mojo::DataPipeProducer::DataSource> readable_data_source;
-    mojo::FileDataSource* file_data_source_raw = file_data_source.get();
     AsarFileValidator* file_validator_raw = nullptr;
     uint32_t block_size = 0;
     if (info.integrity.has_value()) {
@@ -167,42 +431,34 @@ class AsarURLLoader : public network::mojom::URLLoader {
           std::move(info.integrity.value()), std::move(file));
       file_validator_raw = asar_validator.get();
       readable_data_source = std::make_unique<mojo::FilteredDataSource>(
-          std::move(file_data_source), std::move(asar_validator));
+          std::move(source_data_source), std::move(asar_validator));
     } else {
-      readable_data_source = std::move(file_data_source);
+      readable_data_source = std::move(source_data_source);
     }
 
-    std::vector<char> initial_read_buffer(
-        std::min(static_cast<uint32_t>(net::kMaxBytesToSniff), info.size));
-    auto read_result = readable_data_source.get()->Read(
-        info.offset, base::span<char>(initial_read_buffer));
-    if (read_result.result != MOJO_RESULT_OK) {
-      OnClientComplete(ConvertMojoResultToNetError(read_result.result));
-      return;
+    // The head of the file is only read up front when its extension does not
+    // give the MIME type away, or to start validating it from the first
+    // block. Otherwise a range request starts streaming right at its range.
+    bool has_mime_type = net::GetMimeTypeFromFile(path, &head->mime_type);
+    std::vector<char> initial_read_buffer;
+    if (!has_mime_type || is_verifying_file) {
+      initial_read_buffer.resize(
+          std::min(static_cast<uint32_t>(net::kMaxBytesToSniff), info.size));
     }
-
-    std::string range_header;
-    net::HttpByteRange byte_range;
-    if (request.headers.GetHeader(net::HttpRequestHeaders::kRange,
-                                  &range_header)) {
-      // Handle a simple Range header for a single range.
-      std::vector<net::HttpByteRange> ranges;
-      bool fail = false;
-      if (net::HttpUtil::ParseRangeHeader(range_header, &ranges) &&
-          ranges.size() == 1) {
-        byte_range = ranges[0];
-        if (!byte_range.ComputeBounds(info.size))
-          fail = true;
-      } else {
-        fail = true;
-      }
-
-      if (fail) {
-        OnClientComplete(net::ERR_REQUEST_RANGE_NOT_SATISFIABLE);
+    mojo::DataPipeProducer::DataSource::ReadResult read_result;
+    if (!initial_read_buffer.empty()) {
+      read_result = readable_data_source.get()->Read(
+          info.offset, base::span<char>(initial_read_buffer));
+      if (read_result.result != MOJO_RESULT_OK) {
+        OnClientComplete(ConvertMojoResultToNetError(read_result.result));
         return;
       }
     }
 
+    net::HttpByteRange byte_range;
+    if (!ranges.empty())
+      byte_range = ranges[0];
+
     uint64_t first_byte_to_send = 0;
     uint64_t total_bytes_dropped_from_head = initial_read_buffer.size();
     uint64_t total_bytes_to_send = info.size;
@@ -220,7 +476,7 @@ class AsarURLLoader : public network::mojom::URLLoader {
     if (first_byte_to_send < read_result.bytes_read) {
       // Write any data we read for MIME sniffing, constraining by range where
       // applicable. This will always fit in the pipe (see assertion near
-      // |kDefaultFileUrlPipeSize| definition).
+      // |kDefaultFileUrlPipeSize| definition, and |GetFileUrlPipeSize|).
       uint32_t write_size = std::min(
           static_cast<uint32_t>(read_result.bytes_read - first_byte_to_send),
           static_cast<uint32_t>(total_bytes_to_send));
@@ -256,7 +512,7 @@ class AsarURLLoader : public network::mojom::URLLoader {
       }
     }
 
-    if (!net::GetMimeTypeFromFile(path, &head->mime_type)) {
+    if (!has_mime_type) {
       std::string new_type;
       net::SniffMimeType(
           base::StringPiece(initial_read_buffer.data(), read_result.bytes_read),
@@ -323,9 +579,15 @@ class AsarURLLoader : public network::mojom::URLLoader {
     // (i.e., no range request) this Seek is effectively a no-op.
     //
     // Note that in Electron we also need to add file offset.
-    file_data_source_raw->SetRange(
-        first_byte_to_send + info.offset,
-        first_byte_to_send + info.offset + total_bytes_to_send);
+    if (mapped_data_source_raw) {
+      mapped_data_source_raw->SetRange(
+          first_byte_to_send + info.offset,
+          first_byte_to_send + info.offset + total_bytes_to_send);
+    } else {
+      file_data_source_raw->SetRange(
+          first_byte_to_send + info.offset,
+          first_byte_to_send + info.offset + total_bytes_to_send);
+    }
     if (file_validator_raw)
       file_validator_raw->SetRange(info.offset + first_byte_to_send,
                                    total_bytes_dropped_from_head,
@@ -338,6 +600,106 @@ class AsarURLLoader : public network::mojom::URLLoader {
         base::BindOnce(&AsarURLLoader::OnFileWritten, base::Unretained(this)));
   }
 
+  // Responds to a request for several ranges of a packed or unpacked file with
+  // a multipart/byteranges body, reading the parts from |source|. Only the
+  // blocks covering the requested ranges are read and validated, before any
+  // of them is sent.
+  void StartMultipartResponse(
+      const network::ResourceRequest& request,
+      const base::FilePath& path,
+      const Archive::FileInfo& info,
+      std::unique_ptr<mojo::DataPipeProducer::DataSource> source,
+      const std::vector<net::HttpByteRange>& ranges,
+      network::mojom::URLResponseHeadPtr head,
+      mojo::ScopedDataPipeProducerHandle producer_handle,
+      mojo::ScopedDataPipeConsumerHandle consumer_handle) {
+    std::string mime_type;
+    bool has_mime_type = net::GetMimeTypeFromFile(path, &mime_type);
+    if (info.integrity.has_value()) {
+      // Read the blocks covering the requested ranges, and the head of the
+      // file for sniffing, into memory once. The parts are served from there
+      // after being validated, rather than read from the file again.
+      std::vector<std::pair<uint64_t, uint64_t>> needed;
+      if (!has_mime_type) {
+        needed.emplace_back(
+            0, std::min<uint64_t>(net::kMaxBytesToSniff, info.size));
+      }
+      for (const auto& range : ranges) {
+        needed.emplace_back(range.first_byte_position(),
+                            range.last_byte_position() + 1);
+      }
+      auto validated_source = std::make_unique<ValidatedDataSource>();
+      for (const auto& [start, end] : needed) {
+        auto [read_start, read_end] = GetFileValidationRange(info, start, end);
+        if (validated_source->Contains(info.offset + read_start,
+                                       info.offset + read_end)) {
+          continue;
+        }
+        std::vector<char> contents(read_end - read_start);
+        auto read_result = source->Read(info.offset + read_start,
+                                        base::span<char>(contents));
+        if (read_result.result != MOJO_RESULT_OK) {
+          OnClientComplete(ConvertMojoResultToNetError(read_result.result));
+          return;
+        }
+        if (read_result.bytes_read != contents.size()) {
+          OnClientComplete(net::ERR_FAILED);
+          return;
+        }
+        ValidateFileRangeOrDie(info, read_start,
+                               base::as_bytes(base::make_span(contents)));
+        validated_source->AddChunk(info.offset + read_start,
+                                   std::move(contents));
+      }
+      source = std::move(validated_source);
+    }
+
+    if (!has_mime_type) {
+      std::vector<char> sniff_buffer(
+          std::min(static_cast<uint32_t>(net::kMaxBytesToSniff), info.size));
+      auto read_result =
+          source->Read(info.offset, base::span<char>(sniff_buffer));
+      if (read_result.result != MOJO_RESULT_OK) {
+        OnClientComplete(ConvertMojoResultToNetError(read_result.result));
+        return;
+      }
+      net::SniffMimeType(
+          base::StringPiece(sniff_buffer.data(), read_result.bytes_read),
+          request.url, std::string(), net::ForceSniffFileUrlsForHtml::kDisabled,
+          &mime_type);
+    }
+
+    const std::string boundary = net::GenerateMimeMultipartBoundary();
+    auto body = std::make_unique<MultipartRangeDataSource>(
+        std::move(source), info.offset, info.size, ranges, boundary,
+        mime_type);
+    total_bytes_written_ = body->GetLength();
+
+    // The boundary only travels in the Content-Type header, so make sure
+    // there is one to carry it.
+    head->mime_type = "multipart/byteranges";
+    head->content_length = base::saturated_cast<int64_t>(body->GetLength());
+    // Extra response headers carry their own status line, which must not
+    // claim a full response for a body made of parts.
+    if (!head->headers) {
+      head->headers =
+          base::MakeRefCounted<net::HttpResponseHeaders>("HTTP/1.1 200 OK");
+    }
+    head->headers->ReplaceStatusLine("HTTP/1.1 206 Partial Content");
+    head->headers->SetHeader(
+        net::HttpRequestHeaders::kContentType,
+        base::StringPrintf("multipart/byteranges; boundary=%s",
+                           boundary.c_str()));
+    client_->OnReceiveResponse(std::move(head), std::move(consumer_handle),
+                               absl::nullopt);
+
+    data_producer_ =
+        std::make_unique<mojo::DataPipeProducer>(std::move(producer_handle));
+    data_producer_->Write(
+        std::move(body),
+        base::BindOnce(&AsarURLLoader::OnFileWritten, base::Unretained(this)));
+  }
+
   void OnConnectionError() {
     receiver_.reset();
     MaybeDeleteSelf();
@@ -0,0 +1,36 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/osr/osr_options.h"
+
+#include <string>
+
+#include "shell/browser/yuv_frame.h"
+#include "shell/common/gin_helper/dictionary.h"
+#include "shell/common/options_switches.h"
+
+namespace electron {
+
+bool GetOffScreenOptions(const gin_helper::Dictionary& web_preferences,
+                         OffScreenOptions* options) {
+  gin_helper::Dictionary offscreen;
+  if (!web_preferences.Get(options::kOffscreen, &offscreen)) {
+    bool enabled = false;
+    return web_preferences.Get(options::kOffscreen, &enabled) && enabled;
+  }
+
+  if (options) {
+    offscreen.Get("useSharedMemory", &options->use_shared_memory);
+    offscreen.Get("dirtyRegionOnly", &options->dirty_region_only);
+    offscreen.Get("adaptiveFrameRate", &options->adaptive_frame_rate);
+    std::string pixel_format;
+    if (offscreen.Get("pixelFormat", &pixel_format)) {
+      options->pixel_format = ParseCapturePixelFormat(pixel_format)
+                                  .value_or(media::PIXEL_FORMAT_ARGB);
+    }
+  }
+  return true;
+}
+
+}  // namespace electron
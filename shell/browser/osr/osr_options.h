@@ -0,0 +1,40 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_BROWSER_OSR_OSR_OPTIONS_H_
+#define ELECTRON_SHELL_BROWSER_OSR_OSR_OPTIONS_H_
+
+#include "media/base/video_types.h"
+
+namespace gin_helper {
+class Dictionary;
+}
+
+namespace electron {
+
+// Options of offscreen rendering, from webPreferences.offscreen.
+struct OffScreenOptions {
+  // Whether frames are passed to the paint callback in the capturer's shared
+  // memory, instead of in a copy, when they are captured from the GPU.
+  bool use_shared_memory = false;
+  // Whether the paint event's image only holds the pixels of the dirty rect,
+  // instead of the whole frame.
+  bool dirty_region_only = false;
+  // Whether frames are captured less often than the frame rate asks for while
+  // the paint callback holds on to them for longer than a frame.
+  bool adaptive_frame_rate = false;
+  // The format frames are captured in from the GPU. Frames in I420 or NV12
+  // are passed to the YUV paint callback instead of the paint callback.
+  media::VideoPixelFormat pixel_format = media::PIXEL_FORMAT_ARGB;
+};
+
+// Returns whether |web_preferences| turn offscreen rendering on. Its
+// "offscreen" is either a boolean, or an object of options that turns it on,
+// which are read into |options| when it is not null.
+bool GetOffScreenOptions(const gin_helper::Dictionary& web_preferences,
+                         OffScreenOptions* options);
+
+}  // namespace electron
+
+#endif  // ELECTRON_SHELL_BROWSER_OSR_OSR_OPTIONS_H_
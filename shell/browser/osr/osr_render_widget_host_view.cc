@@ -31,6 +31,7 @@
 #include "content/public/browser/render_process_host.h"
 #include "gpu/command_buffer/client/gl_helper.h"
 #include "media/base/video_frame.h"
+#include "shell/browser/yuv_frame.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/blink/public/common/input/web_input_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -46,6 +47,7 @@
 #include "ui/gfx/image/image_skia.h"
 #include "ui/gfx/native_widget_types.h"
 #include "ui/gfx/skbitmap_operations.h"
+#include "ui/gfx/skia_util.h"
 #include "ui/latency/latency_info.h"
 
 namespace electron {
@@ -173,9 +175,11 @@ class ElectronDelegatedFrameHostClient
 
 OffScreenRenderWidgetHostView::OffScreenRenderWidgetHostView(
     bool transparent,
+    const OffScreenOptions& options,
     bool painting,
     int frame_rate,
     const OnPaintCallback& callback,
+    const OnYUVPaintCallback& yuv_callback,
     content::RenderWidgetHost* host,
     OffScreenRenderWidgetHostView* parent_host_view,
     gfx::Size initial_size)
@@ -183,7 +187,9 @@ OffScreenRenderWidgetHostView::OffScreenRenderWidgetHostView(
       render_widget_host_(content::RenderWidgetHostImpl::From(host)),
       parent_host_view_(parent_host_view),
       transparent_(transparent),
+      options_(options),
       callback_(callback),
+      yuv_callback_(yuv_callback),
       frame_rate_(frame_rate),
       size_(initial_size),
       painting_(painting),
@@ -232,8 +238,11 @@ OffScreenRenderWidgetHostView::OffScreenRenderWidgetHostView(
 
   if (content::GpuDataManager::GetInstance()->HardwareAccelerationEnabled()) {
     video_consumer_ = std::make_unique<OffScreenVideoConsumer>(
-        this, base::BindRepeating(&OffScreenRenderWidgetHostView::OnPaint,
-                                  weak_ptr_factory_.GetWeakPtr()));
+        this, options_,
+        base::BindRepeating(&OffScreenRenderWidgetHostView::OnPaint,
+                            weak_ptr_factory_.GetWeakPtr()),
+        base::BindRepeating(&OffScreenRenderWidgetHostView::OnYUVPaint,
+                            weak_ptr_factory_.GetWeakPtr()));
     video_consumer_->SetActive(IsPainting());
     video_consumer_->SetFrameRate(GetFrameRate());
   }
@@ -548,8 +557,9 @@ OffScreenRenderWidgetHostView::CreateViewForWidget(
   }
 
   return new OffScreenRenderWidgetHostView(
-      transparent_, true, embedder_host_view->GetFrameRate(), callback_,
-      render_widget_host, embedder_host_view, size());
+      transparent_, options_, true, embedder_host_view->GetFrameRate(),
+      callback_, yuv_callback_, render_widget_host, embedder_host_view,
+      size());
 }
 
 const viz::FrameSinkId& OffScreenRenderWidgetHostView::GetFrameSinkId() const {
@@ -672,9 +682,39 @@ bool OffScreenRenderWidgetHostView::UpdateNSViewAndDisplay() {
 
 void OffScreenRenderWidgetHostView::OnPaint(const gfx::Rect& damage_rect,
                                             const SkBitmap& bitmap) {
-  backing_ = std::make_unique<SkBitmap>();
-  backing_->allocN32Pixels(bitmap.width(), bitmap.height(), !transparent_);
-  bitmap.readPixels(backing_->pixmap());
+  if (!video_consumer_)
+    software_frames_++;
+
+  if (options_.use_shared_memory && video_consumer_) {
+    // Frames from the capturer are in its shared memory, which it does not
+    // reuse while the bitmap referring to it is alive, so they need no copy.
+    // The software output device draws every frame into the same memory.
+    backing_ = std::make_unique<SkBitmap>(bitmap);
+    backing_has_previous_frame_ = false;
+  } else {
+    // The backing is kept from frame to frame, so only the damaged pixels
+    // need to be copied into it. It is replaced instead while anything else,
+    // like an image passed to the app, still refers to its pixels, which must
+    // not change underneath it.
+    const SkImageInfo info = SkImageInfo::MakeN32(
+        bitmap.width(), bitmap.height(),
+        transparent_ ? kPremul_SkAlphaType : kOpaque_SkAlphaType);
+    if (backing_has_previous_frame_ && backing_->info() == info &&
+        backing_->pixelRef() && backing_->pixelRef()->unique()) {
+      const gfx::Rect rect = gfx::IntersectRects(
+          damage_rect, gfx::Rect(bitmap.width(), bitmap.height()));
+      SkPixmap damaged;
+      if (!rect.IsEmpty() && backing_->pixmap().extractSubset(
+                                 &damaged, gfx::RectToSkIRect(rect))) {
+        bitmap.readPixels(damaged, rect.x(), rect.y());
+      }
+    } else {
+      backing_ = std::make_unique<SkBitmap>();
+      backing_->allocPixels(info);
+      bitmap.readPixels(backing_->pixmap());
+      backing_has_previous_frame_ = true;
+    }
+  }
 
   if (IsPopupWidget() && parent_callback_) {
     parent_callback_.Run(this->popup_position_);
@@ -683,6 +723,17 @@ void OffScreenRenderWidgetHostView::OnPaint(const gfx::Rect& damage_rect,
   }
 }
 
+void OffScreenRenderWidgetHostView::OnYUVPaint(const gfx::Rect& damage_rect,
+                                               const YUVFrame& frame) {
+  // YUV frames can not have popups drawn over them, so only the frames of the
+  // page itself are passed on.
+  if (IsPopupWidget())
+    return;
+
+  yuv_callback_.Run(
+      gfx::IntersectRects(gfx::Rect(frame.size()), damage_rect), frame);
+}
+
 gfx::Size OffScreenRenderWidgetHostView::SizeInPixels() {
   float sf = GetDeviceScaleFactor();
   return gfx::ToFlooredSize(
@@ -896,6 +947,8 @@ void OffScreenRenderWidgetHostView::SendMouseWheelEvent(
 
 void OffScreenRenderWidgetHostView::SetPainting(bool painting) {
   painting_ = painting;
+  // The damage of the frames that are not painted is lost.
+  backing_has_previous_frame_ = false;
 
   if (popup_host_view_) {
     popup_host_view_->SetPainting(painting);
@@ -944,6 +997,23 @@ int OffScreenRenderWidgetHostView::GetFrameRate() const {
   return frame_rate_;
 }
 
+OffScreenFrameStats OffScreenRenderWidgetHostView::GetFrameStats() const {
+  if (video_consumer_)
+    return video_consumer_->frame_stats();
+
+  OffScreenFrameStats stats;
+  stats.captured = stats.delivered = software_frames_;
+  if (GetFrameRate() > 0)
+    stats.capture_period = base::Seconds(1) / GetFrameRate();
+  return stats;
+}
+
+base::OnceClosure OffScreenRenderWidgetHostView::TakeFrameReleaseCallback() {
+  if (!video_consumer_)
+    return base::OnceClosure();
+  return video_consumer_->TakeFrameReleaseCallback();
+}
+
 ui::Layer* OffScreenRenderWidgetHostView::GetRootLayer() const {
   return root_layer_.get();
 }
@@ -27,6 +27,7 @@
 #include "content/browser/renderer_host/render_widget_host_view_base.h"  // nogncheck
 #include "content/browser/web_contents/web_contents_view.h"  // nogncheck
 #include "shell/browser/osr/osr_host_display_client.h"
+#include "shell/browser/osr/osr_options.h"
 #include "shell/browser/osr/osr_video_consumer.h"
 #include "shell/browser/osr/osr_view_proxy.h"
 #include "third_party/blink/public/mojom/widget/record_content_to_visible_time_request.mojom-forward.h"
@@ -54,9 +55,12 @@ class ElectronCopyFrameGenerator;
 class ElectronBeginFrameTimer;
 
 class ElectronDelegatedFrameHostClient;
+class YUVFrame;
 
 typedef base::RepeatingCallback<void(const gfx::Rect&, const SkBitmap&)>
     OnPaintCallback;
+typedef base::RepeatingCallback<void(const gfx::Rect&, const YUVFrame&)>
+    OnYUVPaintCallback;
 typedef base::RepeatingCallback<void(const gfx::Rect&)> OnPopupPaintCallback;
 
 class OffScreenRenderWidgetHostView : public content::RenderWidgetHostViewBase,
@@ -64,9 +68,11 @@ class OffScreenRenderWidgetHostView : public content::RenderWidgetHostViewBase,
                                       public OffscreenViewProxyObserver {
  public:
   OffScreenRenderWidgetHostView(bool transparent,
+                                const OffScreenOptions& options,
                                 bool painting,
                                 int frame_rate,
                                 const OnPaintCallback& callback,
+                                const OnYUVPaintCallback& yuv_callback,
                                 content::RenderWidgetHost* render_widget_host,
                                 OffScreenRenderWidgetHostView* parent_host_view,
                                 gfx::Size initial_size);
@@ -185,6 +191,7 @@ class OffScreenRenderWidgetHostView : public content::RenderWidgetHostViewBase,
   void ProxyViewDestroyed(OffscreenViewProxy* proxy) override;
 
   void OnPaint(const gfx::Rect& damage_rect, const SkBitmap& bitmap);
+  void OnYUVPaint(const gfx::Rect& damage_rect, const YUVFrame& frame);
   void OnPopupPaint(const gfx::Rect& damage_rect);
   void OnProxyViewPaint(const gfx::Rect& damage_rect) override;
 
@@ -211,6 +218,10 @@ class OffScreenRenderWidgetHostView : public content::RenderWidgetHostViewBase,
   void SetFrameRate(int frame_rate);
   int GetFrameRate() const;
 
+  OffScreenFrameStats GetFrameStats() const;
+  // See OffScreenVideoConsumer::TakeFrameReleaseCallback().
+  base::OnceClosure TakeFrameReleaseCallback();
+
   ui::Layer* GetRootLayer() const;
 
   content::DelegatedFrameHost* GetDelegatedFrameHost() const;
@@ -252,12 +263,18 @@ class OffScreenRenderWidgetHostView : public content::RenderWidgetHostViewBase,
   std::set<OffscreenViewProxy*> proxy_views_;
 
   const bool transparent_;
+  const OffScreenOptions options_;
   OnPaintCallback callback_;
+  OnYUVPaintCallback yuv_callback_;
   OnPopupPaintCallback parent_callback_;
 
   int frame_rate_ = 0;
   int frame_rate_threshold_us_ = 0;
 
+  // The frames painted by the software output device, which are all passed
+  // on.
+  uint64_t software_frames_ = 0;
+
   gfx::Size size_;
   bool painting_;
 
@@ -296,6 +313,9 @@ class OffScreenRenderWidgetHostView : public content::RenderWidgetHostViewBase,
   SkColor background_color_ = SkColor();
 
   std::unique_ptr<SkBitmap> backing_;
+  // Whether |backing_| is owned by this view and holds the previous frame, so
+  // that the damage of the next frame is all that has to be copied into it.
+  bool backing_has_previous_frame_ = false;
 
   base::WeakPtrFactory<OffScreenRenderWidgetHostView> weak_ptr_factory_{this};
 };
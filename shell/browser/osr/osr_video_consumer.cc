@@ -4,18 +4,25 @@
 
 #include "shell/browser/osr/osr_video_consumer.h"
 
+#include <algorithm>
 #include <utility>
 
+#include "base/functional/bind.h"
 #include "media/base/limits.h"
 #include "media/base/video_frame_metadata.h"
 #include "media/capture/mojom/video_capture_buffer.mojom.h"
 #include "media/capture/mojom/video_capture_types.mojom.h"
 #include "services/viz/privileged/mojom/compositing/frame_sink_video_capture.mojom-shared.h"
 #include "shell/browser/osr/osr_render_widget_host_view.h"
+#include "shell/browser/yuv_frame.h"
 #include "ui/gfx/skbitmap_operations.h"
 
 namespace {
 
+// The longest adaptive pacing spaces frames out to, however slow the paint
+// callback is.
+constexpr base::TimeDelta kMaxAdaptiveCapturePeriod = base::Seconds(1);
+
 bool IsValidMinAndMaxFrameSize(gfx::Size min_frame_size,
                                gfx::Size max_frame_size) {
   // Returns true if
@@ -33,13 +40,22 @@ namespace electron {
 
 OffScreenVideoConsumer::OffScreenVideoConsumer(
     OffScreenRenderWidgetHostView* view,
-    OnPaintCallback callback)
+    const OffScreenOptions& options,
+    OnPaintCallback callback,
+    OnYUVPaintCallback yuv_callback)
     : callback_(callback),
+      yuv_callback_(yuv_callback),
+      adaptive_frame_rate_(options.adaptive_frame_rate),
+      pixel_format_(options.pixel_format),
       view_(view),
       video_capturer_(view->CreateVideoCapturer()) {
   video_capturer_->SetAutoThrottlingEnabled(false);
   video_capturer_->SetMinSizeChangePeriod(base::TimeDelta());
-  video_capturer_->SetFormat(media::PIXEL_FORMAT_ARGB);
+  // NV12 frames are captured in I420, and have their chroma planes
+  // interleaved when they are copied out for JS.
+  video_capturer_->SetFormat(pixel_format_ == media::PIXEL_FORMAT_ARGB
+                                 ? media::PIXEL_FORMAT_ARGB
+                                 : media::PIXEL_FORMAT_I420);
 
   SizeChanged(view_->SizeInPixels());
   SetFrameRate(view_->GetFrameRate());
@@ -56,7 +72,11 @@ void OffScreenVideoConsumer::SetActive(bool active) {
 }
 
 void OffScreenVideoConsumer::SetFrameRate(int frame_rate) {
-  video_capturer_->SetMinCapturePeriod(base::Seconds(1) / frame_rate);
+  min_capture_period_ = base::Seconds(1) / frame_rate;
+  frame_stats_.capture_period = min_capture_period_;
+  video_capturer_->SetMinCapturePeriod(min_capture_period_);
+  if (adaptive_frame_rate_)
+    UpdateCapturePeriod();
 }
 
 void OffScreenVideoConsumer::SizeChanged(const gfx::Size& size_in_pixels) {
@@ -74,7 +94,21 @@ void OffScreenVideoConsumer::OnFrameCaptured(
         callbacks) {
   auto& data_region = data->get_read_only_shmem_region();
 
+  frame_stats_.captured++;
+  // The capturer numbers the frames it captures, so a gap means it skipped
+  // frames, e.g. because all of its buffers were still held by this consumer.
+  const absl::optional<int> capture_counter = info->metadata.capture_counter;
+  if (capture_counter && last_capture_counter_ &&
+      *capture_counter > *last_capture_counter_ + 1) {
+    frame_stats_.dropped += *capture_counter - *last_capture_counter_ - 1;
+    frame_missed_ = true;
+  }
+  if (capture_counter)
+    last_capture_counter_ = capture_counter;
+
   if (!CheckContentRect(content_rect)) {
+    frame_stats_.dropped++;
+    frame_missed_ = true;
     SizeChanged(view_->SizeInPixels());
     return;
   }
@@ -83,22 +117,48 @@ void OffScreenVideoConsumer::OnFrameCaptured(
       callbacks_remote(std::move(callbacks));
 
   if (!data_region.IsValid()) {
+    frame_stats_.dropped++;
+    frame_missed_ = true;
     callbacks_remote->Done();
     return;
   }
   base::ReadOnlySharedMemoryMapping mapping = data_region.Map();
   if (!mapping.IsValid()) {
     DLOG(ERROR) << "Shared memory mapping failed.";
+    frame_stats_.dropped++;
+    frame_missed_ = true;
     callbacks_remote->Done();
     return;
   }
   if (mapping.size() <
       media::VideoFrame::AllocationSize(info->pixel_format, info->coded_size)) {
     DLOG(ERROR) << "Shared memory size was less than expected.";
+    frame_stats_.dropped++;
+    frame_missed_ = true;
     callbacks_remote->Done();
     return;
   }
 
+  absl::optional<gfx::Rect> update_rect = info->metadata.capture_update_rect;
+  if (!update_rect.has_value() || update_rect->IsEmpty() || frame_missed_) {
+    update_rect = content_rect;
+  }
+  frame_missed_ = false;
+
+  if (pixel_format_ != media::PIXEL_FORMAT_ARGB) {
+    // The frame is copied out for JS before the callback returns, so the
+    // time it is held for is the time the callback takes.
+    const base::TimeTicks delivered_time = base::TimeTicks::Now();
+    frame_stats_.delivered++;
+    auto weak_this = weak_ptr_factory_.GetWeakPtr();
+    yuv_callback_.Run(*update_rect,
+                      YUVFrame(pixel_format_, std::move(mapping), *info,
+                               content_rect, callbacks_remote.Unbind()));
+    if (weak_this)
+      OnFrameReleased(delivered_time);
+    return;
+  }
+
   // The SkBitmap's pixels will be marked as immutable, but the installPixels()
   // API requires a non-const pointer. So, cast away the const.
   void* const pixels = const_cast<void*>(mapping.memory());
@@ -128,12 +188,53 @@ void OffScreenVideoConsumer::OnFrameCaptured(
       new FramePinner{std::move(mapping), callbacks_remote.Unbind()});
   bitmap.setImmutable();
 
-  absl::optional<gfx::Rect> update_rect = info->metadata.capture_update_rect;
-  if (!update_rect.has_value() || update_rect->IsEmpty()) {
-    update_rect = content_rect;
+  // The pixels stay pinned until the view draws the next frame, so their
+  // lifetime says nothing about how long the paint callback needs a frame
+  // for. It is measured from when the callback is done with the frame
+  // instead.
+  auto weak_this = weak_ptr_factory_.GetWeakPtr();
+  frame_release_callback_ =
+      base::BindOnce(&OffScreenVideoConsumer::OnFrameReleased, weak_this,
+                     base::TimeTicks::Now());
+  frame_stats_.delivered++;
+  callback_.Run(*update_rect, bitmap);
+  if (weak_this && frame_release_callback_)
+    std::move(frame_release_callback_).Run();
+}
+
+base::OnceClosure OffScreenVideoConsumer::TakeFrameReleaseCallback() {
+  return std::move(frame_release_callback_);
+}
+
+void OffScreenVideoConsumer::OnFrameReleased(base::TimeTicks delivered_time) {
+  const base::TimeDelta hold_time = base::TimeTicks::Now() - delivered_time;
+  // A moving average, so that a single slow frame does not change the pace.
+  if (frame_stats_.consumer_latency.is_zero()) {
+    frame_stats_.consumer_latency = hold_time;
+  } else {
+    frame_stats_.consumer_latency =
+        (frame_stats_.consumer_latency * 7 + hold_time) / 8;
   }
+  if (adaptive_frame_rate_)
+    UpdateCapturePeriod();
+}
 
-  callback_.Run(*update_rect, bitmap);
+void OffScreenVideoConsumer::UpdateCapturePeriod() {
+  // Leave some headroom, so that the capturer does not run out of buffers
+  // while the consumer is still holding on to the last frames.
+  const base::TimeDelta period =
+      std::clamp(frame_stats_.consumer_latency * 5 / 4, min_capture_period_,
+                 kMaxAdaptiveCapturePeriod);
+  // Small changes are ignored so the capturer is not told about every frame.
+  if (period != min_capture_period_ &&
+      (period - frame_stats_.capture_period).magnitude() * 8 <
+          frame_stats_.capture_period) {
+    return;
+  }
+  if (period == frame_stats_.capture_period)
+    return;
+  frame_stats_.capture_period = period;
+  video_capturer_->SetMinCapturePeriod(period);
 }
 
 void OffScreenVideoConsumer::OnNewCropVersion(uint32_t crop_version) {}
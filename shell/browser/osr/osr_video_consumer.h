@@ -5,27 +5,49 @@
 #ifndef ELECTRON_SHELL_BROWSER_OSR_OSR_VIDEO_CONSUMER_H_
 #define ELECTRON_SHELL_BROWSER_OSR_OSR_VIDEO_CONSUMER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
 #include "base/functional/callback.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "components/viz/host/client_frame_sink_video_capturer.h"
 #include "media/capture/mojom/video_capture_buffer.mojom-forward.h"
 #include "media/capture/mojom/video_capture_types.mojom.h"
+#include "shell/browser/osr/osr_options.h"
 
 namespace electron {
 
 class OffScreenRenderWidgetHostView;
+class YUVFrame;
 
 typedef base::RepeatingCallback<void(const gfx::Rect&, const SkBitmap&)>
     OnPaintCallback;
+typedef base::RepeatingCallback<void(const gfx::Rect&, const YUVFrame&)>
+    OnYUVPaintCallback;
+
+// Counters of the frames painted by an offscreen view.
+struct OffScreenFrameStats {
+  // Frames received from the capturer.
+  uint64_t captured = 0;
+  // Frames passed to the paint callback.
+  uint64_t delivered = 0;
+  // Frames the capturer skipped, or that could not be passed on.
+  uint64_t dropped = 0;
+  // How long the paint callback has been holding on to frames, on average.
+  base::TimeDelta consumer_latency;
+  // How often frames are captured at most.
+  base::TimeDelta capture_period;
+};
 
 class OffScreenVideoConsumer : public viz::mojom::FrameSinkVideoConsumer {
  public:
   OffScreenVideoConsumer(OffScreenRenderWidgetHostView* view,
-                         OnPaintCallback callback);
+                         const OffScreenOptions& options,
+                         OnPaintCallback callback,
+                         OnYUVPaintCallback yuv_callback);
   ~OffScreenVideoConsumer() override;
 
   // disable copy
@@ -36,6 +58,15 @@ class OffScreenVideoConsumer : public viz::mojom::FrameSinkVideoConsumer {
   void SetFrameRate(int frame_rate);
   void SizeChanged(const gfx::Size& size_in_pixels);
 
+  const OffScreenFrameStats& frame_stats() const { return frame_stats_; }
+
+  // Called by the paint callback of a frame that outlives the callback, to
+  // take over telling this consumer when it is done with the frame. The
+  // returned closure is null outside of the callback, or when it was taken
+  // already. Frames that are not taken over are done when the callback
+  // returns, even though the view keeps their pixels to redraw them.
+  base::OnceClosure TakeFrameReleaseCallback();
+
  private:
   // viz::mojom::FrameSinkVideoConsumer implementation.
   void OnFrameCaptured(
@@ -51,7 +82,26 @@ class OffScreenVideoConsumer : public viz::mojom::FrameSinkVideoConsumer {
 
   bool CheckContentRect(const gfx::Rect& content_rect);
 
+  // Called when the paint callback has let go of a frame it was given at
+  // |delivered_time|.
+  void OnFrameReleased(base::TimeTicks delivered_time);
+  void UpdateCapturePeriod();
+
   OnPaintCallback callback_;
+  OnYUVPaintCallback yuv_callback_;
+
+  const bool adaptive_frame_rate_;
+  const media::VideoPixelFormat pixel_format_;
+  // The period asked for with SetFrameRate(), which adaptive pacing does not
+  // go below.
+  base::TimeDelta min_capture_period_;
+  absl::optional<int> last_capture_counter_;
+  // Set when a frame was skipped or dropped since the last one that was
+  // delivered, whose damage the next frame's update rect does not cover.
+  bool frame_missed_ = false;
+  // Set while the paint callback of an ARGB frame runs.
+  base::OnceClosure frame_release_callback_;
+  OffScreenFrameStats frame_stats_;
 
   raw_ptr<OffScreenRenderWidgetHostView> view_;
   std::unique_ptr<viz::ClientFrameSinkVideoCapturer> video_capturer_;
@@ -13,8 +13,13 @@ namespace electron {
 
 OffScreenWebContentsView::OffScreenWebContentsView(
     bool transparent,
-    const OnPaintCallback& callback)
-    : transparent_(transparent), callback_(callback) {
+    const OffScreenOptions& options,
+    const OnPaintCallback& callback,
+    const OnYUVPaintCallback& yuv_callback)
+    : transparent_(transparent),
+      options_(options),
+      callback_(callback),
+      yuv_callback_(yuv_callback) {
 #if BUILDFLAG(IS_MAC)
   PlatformCreate();
 #endif
@@ -119,8 +124,8 @@ OffScreenWebContentsView::CreateViewForWidget(
   }
 
   return new OffScreenRenderWidgetHostView(
-      transparent_, painting_, GetFrameRate(), callback_, render_widget_host,
-      nullptr, GetSize());
+      transparent_, options_, painting_, GetFrameRate(), callback_,
+      yuv_callback_, render_widget_host, nullptr, GetSize());
 }
 
 content::RenderWidgetHostViewBase*
@@ -134,9 +139,9 @@ OffScreenWebContentsView::CreateViewForChildWidget(
           ? web_contents_impl->GetOuterWebContents()->GetRenderWidgetHostView()
           : web_contents_impl->GetRenderWidgetHostView());
 
-  return new OffScreenRenderWidgetHostView(transparent_, painting_,
-                                           view->GetFrameRate(), callback_,
-                                           render_widget_host, view, GetSize());
+  return new OffScreenRenderWidgetHostView(
+      transparent_, options_, painting_, view->GetFrameRate(), callback_,
+      yuv_callback_, render_widget_host, view, GetSize());
 }
 
 void OffScreenWebContentsView::SetPageTitle(const std::u16string& title) {}
@@ -30,7 +30,10 @@ class OffScreenWebContentsView : public content::WebContentsView,
                                  public content::RenderViewHostDelegateView,
                                  public NativeWindowObserver {
  public:
-  OffScreenWebContentsView(bool transparent, const OnPaintCallback& callback);
+  OffScreenWebContentsView(bool transparent,
+                           const OffScreenOptions& options,
+                           const OnPaintCallback& callback,
+                           const OnYUVPaintCallback& yuv_callback);
   ~OffScreenWebContentsView() override;
 
   void SetWebContents(content::WebContents*);
@@ -85,6 +88,7 @@ class OffScreenWebContentsView : public content::WebContentsView,
   bool IsPainting() const;
   void SetFrameRate(int frame_rate);
   int GetFrameRate() const;
+  const OffScreenOptions& options() const { return options_; }
 
  private:
 #if BUILDFLAG(IS_MAC)
@@ -97,9 +101,11 @@ class OffScreenWebContentsView : public content::WebContentsView,
   raw_ptr<NativeWindow> native_window_ = nullptr;
 
   const bool transparent_;
+  const OffScreenOptions options_;
   bool painting_ = true;
   int frame_rate_ = 60;
   OnPaintCallback callback_;
+  OnYUVPaintCallback yuv_callback_;
 
   // Weak refs.
   raw_ptr<content::WebContents> web_contents_ = nullptr;
@@ -22,6 +22,7 @@
 #include "sandbox/policy/switches.h"
 #include "shell/browser/api/electron_api_web_contents.h"
 #include "shell/browser/native_window.h"
+#include "shell/browser/osr/osr_options.h"
 #include "shell/browser/session_preferences.h"
 #include "shell/common/color_util.h"
 #include "shell/common/gin_converters/value_converter.h"
@@ -204,7 +205,7 @@ void WebContentsPreferences::SetFromDictionary(
                            &allow_running_insecure_content_) &&
       !web_security_)
     allow_running_insecure_content_ = true;
-  web_preferences.Get(options::kOffscreen, &offscreen_);
+  offscreen_ = GetOffScreenOptions(web_preferences, nullptr);
   web_preferences.Get(options::kNavigateOnDragDrop, &navigate_on_drag_drop_);
   web_preferences.Get("autoplayPolicy", &autoplay_policy_);
   web_preferences.Get("defaultFontFamily", &default_font_family_);
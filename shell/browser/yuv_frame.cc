@@ -0,0 +1,131 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/yuv_frame.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "media/base/video_frame.h"
+#include "media/capture/mojom/video_capture_types.mojom.h"
+#include "shell/common/gin_helper/dictionary.h"
+#include "shell/common/node_includes.h"
+
+namespace electron {
+
+absl::optional<media::VideoPixelFormat> ParseCapturePixelFormat(
+    const std::string& name) {
+  if (name == "argb")
+    return media::PIXEL_FORMAT_ARGB;
+  if (name == "i420")
+    return media::PIXEL_FORMAT_I420;
+  if (name == "nv12")
+    return media::PIXEL_FORMAT_NV12;
+  return absl::nullopt;
+}
+
+YUVFrame::YUVFrame(
+    media::VideoPixelFormat format,
+    base::ReadOnlySharedMemoryMapping mapping,
+    const media::mojom::VideoFrameInfo& info,
+    const gfx::Rect& content_rect,
+    mojo::PendingRemote<viz::mojom::FrameSinkVideoConsumerFrameCallbacks>
+        callbacks)
+    : format_(format),
+      mapping_(std::move(mapping)),
+      coded_size_(info.coded_size),
+      content_rect_(content_rect),
+      callbacks_(std::move(callbacks)) {
+  DCHECK(format_ == media::PIXEL_FORMAT_I420 ||
+         format_ == media::PIXEL_FORMAT_NV12);
+  DCHECK_EQ(info.pixel_format, media::PIXEL_FORMAT_I420);
+}
+
+YUVFrame::~YUVFrame() = default;
+
+size_t YUVFrame::NumPlanes() const {
+  return media::VideoFrame::NumPlanes(format_);
+}
+
+gfx::Size YUVFrame::PlaneSize(size_t plane) const {
+  if (plane == media::VideoFrame::kYPlane)
+    return size();
+  // The chroma planes are subsampled by two in both directions. NV12 has a
+  // single one with the U and V samples interleaved.
+  const int width = (size().width() + 1) / 2;
+  const int height = (size().height() + 1) / 2;
+  return gfx::Size(format_ == media::PIXEL_FORMAT_NV12 ? width * 2 : width,
+                   height);
+}
+
+const uint8_t* YUVFrame::SourceRow(size_t plane, int row) const {
+  // The capturer lays the planes of its I420 frames out one after the other,
+  // as media::VideoFrame allocates them.
+  const uint8_t* data = static_cast<const uint8_t*>(mapping_.memory());
+  for (size_t i = 0; i < plane; ++i) {
+    data += media::VideoFrame::PlaneSize(media::PIXEL_FORMAT_I420, i,
+                                         coded_size_)
+                .GetArea();
+  }
+  const int stride = media::VideoFrame::RowBytes(
+      plane, media::PIXEL_FORMAT_I420, coded_size_.width());
+  const int subsampling = plane == media::VideoFrame::kYPlane ? 1 : 2;
+  return data + (content_rect_.y() / subsampling + row) * stride +
+         content_rect_.x() / subsampling;
+}
+
+void YUVFrame::CopyPlane(size_t plane, uint8_t* dest) const {
+  const gfx::Size plane_size = PlaneSize(plane);
+  if (format_ == media::PIXEL_FORMAT_I420 ||
+      plane == media::VideoFrame::kYPlane) {
+    for (int row = 0; row < plane_size.height(); ++row) {
+      memcpy(dest, SourceRow(plane, row), plane_size.width());
+      dest += plane_size.width();
+    }
+    return;
+  }
+
+  // Interleaving the chroma planes is all it takes to turn I420 into NV12.
+  for (int row = 0; row < plane_size.height(); ++row) {
+    const uint8_t* u = SourceRow(media::VideoFrame::kUPlane, row);
+    const uint8_t* v = SourceRow(media::VideoFrame::kVPlane, row);
+    for (int i = 0; i < plane_size.width() / 2; ++i) {
+      *dest++ = u[i];
+      *dest++ = v[i];
+    }
+  }
+}
+
+}  // namespace electron
+
+namespace gin {
+
+// static
+v8::Local<v8::Value> Converter<electron::YUVFrame>::ToV8(
+    v8::Isolate* isolate,
+    const electron::YUVFrame& frame) {
+  std::vector<v8::Local<v8::Value>> planes;
+  for (size_t i = 0; i < frame.NumPlanes(); ++i) {
+    const gfx::Size plane_size = frame.PlaneSize(i);
+    v8::Local<v8::Object> data =
+        node::Buffer::New(isolate, plane_size.GetArea()).ToLocalChecked();
+    frame.CopyPlane(i, reinterpret_cast<uint8_t*>(node::Buffer::Data(data)));
+
+    gin_helper::Dictionary plane = gin::Dictionary::CreateEmpty(isolate);
+    plane.Set("data", data);
+    plane.Set("stride", plane_size.width());
+    planes.push_back(plane.GetHandle());
+  }
+
+  gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+  dict.Set("pixelFormat",
+           frame.format() == media::PIXEL_FORMAT_NV12 ? "nv12" : "i420");
+  dict.Set("width", frame.size().width());
+  dict.Set("height", frame.size().height());
+  dict.Set("planes", planes);
+  return dict.GetHandle();
+}
+
+}  // namespace gin
@@ -0,0 +1,82 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_BROWSER_YUV_FRAME_H_
+#define ELECTRON_SHELL_BROWSER_YUV_FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "base/memory/read_only_shared_memory_region.h"
+#include "gin/converter.h"
+#include "media/base/video_types.h"
+#include "media/capture/mojom/video_capture_types.mojom-forward.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "services/viz/privileged/mojom/compositing/frame_sink_video_capture.mojom.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace electron {
+
+// Parses the name of a pixel format a frame can be captured in: "argb",
+// "i420" or "nv12".
+absl::optional<media::VideoPixelFormat> ParseCapturePixelFormat(
+    const std::string& name);
+
+// A frame the capturer produced in I420, in its shared memory. It is passed
+// on in |format|, which is either I420 or NV12, when it is converted to JS.
+// The memory is handed back to the capturer when the frame is destroyed.
+class YUVFrame {
+ public:
+  YUVFrame(media::VideoPixelFormat format,
+           base::ReadOnlySharedMemoryMapping mapping,
+           const media::mojom::VideoFrameInfo& info,
+           const gfx::Rect& content_rect,
+           mojo::PendingRemote<viz::mojom::FrameSinkVideoConsumerFrameCallbacks>
+               callbacks);
+  ~YUVFrame();
+
+  // disable copy
+  YUVFrame(const YUVFrame&) = delete;
+  YUVFrame& operator=(const YUVFrame&) = delete;
+
+  media::VideoPixelFormat format() const { return format_; }
+  const gfx::Size& size() const { return content_rect_.size(); }
+
+  // The number of planes in |format|.
+  size_t NumPlanes() const;
+  // The number of bytes in each row, and the number of rows, of |plane| in
+  // |format|.
+  gfx::Size PlaneSize(size_t plane) const;
+  // Copies |plane| in |format| into |dest|, with rows PlaneSize().width()
+  // bytes apart.
+  void CopyPlane(size_t plane, uint8_t* dest) const;
+
+ private:
+  // Returns the first visible byte of |plane| of the captured I420 frame.
+  const uint8_t* SourceRow(size_t plane, int row) const;
+
+  const media::VideoPixelFormat format_;
+  base::ReadOnlySharedMemoryMapping mapping_;
+  const gfx::Size coded_size_;
+  const gfx::Rect content_rect_;
+  // Prevents the capturer from reusing |mapping_| while this is alive.
+  mojo::PendingRemote<viz::mojom::FrameSinkVideoConsumerFrameCallbacks>
+      callbacks_;
+};
+
+}  // namespace electron
+
+namespace gin {
+
+template <>
+struct Converter<electron::YUVFrame> {
+  static v8::Local<v8::Value> ToV8(v8::Isolate* isolate,
+                                   const electron::YUVFrame& frame);
+};
+
+}  // namespace gin
+
+#endif  // ELECTRON_SHELL_BROWSER_YUV_FRAME_H_
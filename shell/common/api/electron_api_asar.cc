@@ -2,6 +2,7 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <string>
 #include <vector>
 
 #include "gin/handle.h"
@@ -30,6 +31,9 @@ class Archive : public node::ObjectWrap {
     NODE_SET_PROTOTYPE_METHOD(tpl, "copyFileOut", &Archive::CopyFileOut);
     NODE_SET_PROTOTYPE_METHOD(tpl, "getFdAndValidateIntegrityLater",
                               &Archive::GetFD);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getLookupStats", &Archive::GetLookupStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "readMappedFile", &Archive::ReadMappedFile);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "hasSharedIndex", &Archive::HasSharedIndex);
 
     return tpl;
   }
@@ -190,6 +194,88 @@ class Archive : public node::ObjectWrap {
         isolate, wrap->archive_ ? wrap->archive_->GetUnsafeFD() : -1));
   }
 
+  // Reads a packed file straight out of the archive's memory mapping, either
+  // decoded as a UTF-8 string or copied into a Buffer. Returns false when the
+  // archive is not mapped, so callers can fall back to reading from the fd.
+  static void ReadMappedFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto* isolate = args.GetIsolate();
+    auto* wrap = node::ObjectWrap::Unwrap<Archive>(args.Holder());
+    base::FilePath path;
+    if (!gin::ConvertFromV8(isolate, args[0], &path)) {
+      args.GetReturnValue().Set(v8::False(isolate));
+      return;
+    }
+    bool as_string = args[1]->BooleanValue(isolate);
+
+    asar::Archive::FileInfo info;
+    if (!wrap->archive_ || !wrap->archive_->GetFileInfo(path, &info)) {
+      args.GetReturnValue().Set(v8::False(isolate));
+      return;
+    }
+
+    absl::optional<base::span<const uint8_t>> contents =
+        wrap->archive_->GetMappedContents(info);
+    if (!contents) {
+      args.GetReturnValue().Set(v8::False(isolate));
+      return;
+    }
+
+    // The mapped file can change underneath, so what is validated is the copy
+    // that is handed out rather than the mapping itself.
+    const char* data = reinterpret_cast<const char*>(contents->data());
+    if (as_string) {
+      std::string copy(data, contents->size());
+      if (info.integrity.has_value())
+        asar::ValidateFileIntegrityOrDie(
+            info, base::as_bytes(base::make_span(copy)));
+      v8::Local<v8::String> str;
+      if (!v8::String::NewFromUtf8(isolate, copy.data(),
+                                   v8::NewStringType::kNormal, copy.size())
+               .ToLocal(&str)) {
+        args.GetReturnValue().Set(v8::False(isolate));
+        return;
+      }
+      args.GetReturnValue().Set(str);
+    } else {
+      v8::Local<v8::Object> buffer;
+      if (!node::Buffer::Copy(isolate, data, contents->size())
+               .ToLocal(&buffer)) {
+        args.GetReturnValue().Set(v8::False(isolate));
+        return;
+      }
+      if (info.integrity.has_value()) {
+        const auto* copy =
+            reinterpret_cast<const uint8_t*>(node::Buffer::Data(buffer));
+        asar::ValidateFileIntegrityOrDie(
+            info, base::make_span(copy, node::Buffer::Length(buffer)));
+      }
+      args.GetReturnValue().Set(buffer);
+    }
+  }
+
+  // Returns the number of header lookups and misses.
+  static void GetLookupStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto* isolate = args.GetIsolate();
+    auto* wrap = node::ObjectWrap::Unwrap<Archive>(args.Holder());
+    if (!wrap->archive_) {
+      args.GetReturnValue().Set(v8::False(isolate));
+      return;
+    }
+
+    asar::Archive::LookupStats stats = wrap->archive_->GetLookupStats();
+    gin_helper::Dictionary dict(isolate, v8::Object::New(isolate));
+    dict.Set("lookups", stats.lookups);
+    dict.Set("misses", stats.misses);
+    args.GetReturnValue().Set(dict.GetHandle());
+  }
+
+  static void HasSharedIndex(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto* isolate = args.GetIsolate();
+    auto* wrap = node::ObjectWrap::Unwrap<Archive>(args.Holder());
+    args.GetReturnValue().Set(v8::Boolean::New(
+        isolate, wrap->archive_ && wrap->archive_->HasSharedIndex()));
+  }
+
   std::shared_ptr<asar::Archive> archive_;
 };
 
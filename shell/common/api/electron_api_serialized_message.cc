@@ -0,0 +1,72 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/common/api/electron_api_serialized_message.h"
+
+#include <utility>
+
+#include "base/trace_event/trace_event.h"
+#include "gin/object_template_builder.h"
+#include "gin/per_isolate_data.h"
+#include "shell/common/v8_value_serializer.h"
+#include "v8/include/v8.h"
+
+namespace electron::api {
+
+SerializedMessage::SerializedMessage(blink::CloneableMessage message)
+    : message_(std::move(message)) {
+  // The message may point into a buffer owned by the mojo message it arrived
+  // in, which does not live as long as this does.
+  message_.EnsureDataIsOwned();
+}
+
+SerializedMessage::~SerializedMessage() = default;
+
+// static
+gin::Handle<SerializedMessage> SerializedMessage::Create(
+    v8::Isolate* isolate,
+    blink::CloneableMessage message) {
+  return gin::CreateHandle(isolate, new SerializedMessage(std::move(message)));
+}
+
+blink::CloneableMessage SerializedMessage::Clone() const {
+  blink::CloneableMessage clone = message_.ShallowClone();
+  clone.EnsureDataIsOwned();
+  return clone;
+}
+
+v8::Local<v8::Value> SerializedMessage::GetArgs(v8::Isolate* isolate) {
+  if (args_.IsEmpty()) {
+    TRACE_EVENT1("electron", "SerializedMessage::GetArgs", "bytes",
+                 message_.encoded_message.size());
+    args_.Reset(isolate, DeserializeV8Value(isolate, message_));
+  }
+  return args_.Get(isolate);
+}
+
+gin::ObjectTemplateBuilder SerializedMessage::GetObjectTemplateBuilder(
+    v8::Isolate* isolate) {
+  gin::PerIsolateData* data = gin::PerIsolateData::From(isolate);
+  auto* wrapper_info = &kWrapperInfo;
+  v8::Local<v8::FunctionTemplate> constructor =
+      data->GetFunctionTemplate(wrapper_info);
+  if (constructor.IsEmpty()) {
+    constructor = v8::FunctionTemplate::New(isolate);
+    constructor->SetClassName(gin::StringToV8(isolate, GetTypeName()));
+    data->SetFunctionTemplate(wrapper_info, constructor);
+  }
+  return gin::ObjectTemplateBuilder(isolate, GetTypeName(),
+                                    constructor->InstanceTemplate())
+      .SetProperty("args", &SerializedMessage::GetArgs)
+      .SetProperty("byteLength", &SerializedMessage::GetByteLength);
+}
+
+const char* SerializedMessage::GetTypeName() {
+  return "SerializedMessage";
+}
+
+// static
+gin::WrapperInfo SerializedMessage::kWrapperInfo = {gin::kEmbedderNativeGin};
+
+}  // namespace electron::api
@@ -0,0 +1,55 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_COMMON_API_ELECTRON_API_SERIALIZED_MESSAGE_H_
+#define ELECTRON_SHELL_COMMON_API_ELECTRON_API_SERIALIZED_MESSAGE_H_
+
+#include <cstddef>
+
+#include "gin/handle.h"
+#include "gin/wrappable.h"
+#include "third_party/blink/public/common/messaging/cloneable_message.h"
+#include "v8/include/v8-forward.h"
+#include "v8/include/v8-persistent-handle.h"
+
+namespace electron::api {
+
+// The arguments of an IPC message that have not been deserialized yet. They
+// are only decoded when JS first reads them, and are sent on to another frame
+// as they are, so a large message that is only forwarded is never decoded.
+class SerializedMessage : public gin::Wrappable<SerializedMessage> {
+ public:
+  static gin::Handle<SerializedMessage> Create(
+      v8::Isolate* isolate,
+      blink::CloneableMessage message);
+
+  // gin::Wrappable
+  static gin::WrapperInfo kWrapperInfo;
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override;
+  const char* GetTypeName() override;
+
+  // disable copy
+  SerializedMessage(const SerializedMessage&) = delete;
+  SerializedMessage& operator=(const SerializedMessage&) = delete;
+
+  // Returns a copy of the message, for sending it on.
+  blink::CloneableMessage Clone() const;
+
+ private:
+  explicit SerializedMessage(blink::CloneableMessage message);
+  ~SerializedMessage() override;
+
+  v8::Local<v8::Value> GetArgs(v8::Isolate* isolate);
+  size_t GetByteLength() const { return message_.encoded_message.size(); }
+
+  blink::CloneableMessage message_;
+  // Every listener gets the same decoded arguments, as it would have had they
+  // been decoded before the listeners were called.
+  v8::Global<v8::Value> args_;
+};
+
+}  // namespace electron::api
+
+#endif  // ELECTRON_SHELL_COMMON_API_ELECTRON_API_SERIALIZED_MESSAGE_H_
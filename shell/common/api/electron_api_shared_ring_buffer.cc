@@ -0,0 +1,337 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/common/api/electron_api_shared_ring_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "base/auto_reset.h"
+#include "base/strings/string_number_conversions.h"
+#include "gin/object_template_builder.h"
+#include "gin/per_isolate_data.h"
+#include "shell/common/gin_helper/dictionary.h"
+#include "shell/common/gin_helper/error_thrower.h"
+#include "shell/common/node_includes.h"
+#include "v8/include/v8.h"
+
+namespace electron::api {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x52494e47;  // 'RING'
+
+// Every record starts with its size.
+using RecordSize = uint32_t;
+
+}  // namespace
+
+// Positions count bytes written and read since the ring was created, so the
+// used part of the ring is |write_position| - |read_position|, and the offset
+// of a position is the position modulo the capacity. Each position is only
+// ever advanced by its own end.
+struct SharedRingBuffer::Header {
+  uint32_t magic;
+  uint32_t capacity;
+  // On separate cache lines, so that the two ends do not contend for them.
+  alignas(64) std::atomic<uint64_t> write_position;
+  alignas(64) std::atomic<uint64_t> read_position;
+  // Set by the consumer once it has drained the ring, and cleared by the
+  // producer when it rings the consumer's doorbell.
+  alignas(64) std::atomic<uint32_t> consumer_idle;
+};
+
+SharedRingBuffer::SharedRingBuffer(base::UnsafeSharedMemoryRegion region,
+                                   base::WritableSharedMemoryMapping mapping,
+                                   size_t capacity)
+    : region_(std::move(region)),
+      mapping_(std::move(mapping)),
+      capacity_(capacity) {
+  static_assert(sizeof(Header) <= kHeaderSize);
+  // The atomics are shared between processes, which only works when they are
+  // lock free.
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<uint32_t>::is_always_lock_free);
+}
+
+SharedRingBuffer::~SharedRingBuffer() = default;
+
+// static
+gin::Handle<SharedRingBuffer> SharedRingBuffer::Create(
+    gin_helper::ErrorThrower thrower,
+    double capacity) {
+  if (!std::isfinite(capacity) || capacity <= 0 || capacity > kMaxCapacity) {
+    thrower.ThrowRangeError("capacity must be between 1 and " +
+                            base::NumberToString(kMaxCapacity));
+    return gin::Handle<SharedRingBuffer>();
+  }
+  size_t rounded = kMinCapacity;
+  while (rounded < capacity)
+    rounded *= 2;
+
+  base::UnsafeSharedMemoryRegion region =
+      base::UnsafeSharedMemoryRegion::Create(kHeaderSize + rounded);
+  base::WritableSharedMemoryMapping mapping = region.Map();
+  if (!mapping.IsValid()) {
+    thrower.ThrowError("Failed to allocate the ring buffer");
+    return gin::Handle<SharedRingBuffer>();
+  }
+  auto* header = new (mapping.memory()) Header();
+  header->magic = kMagic;
+  header->capacity = rounded;
+  header->write_position.store(0, std::memory_order_relaxed);
+  header->read_position.store(0, std::memory_order_relaxed);
+  // The first write wakes the consumer up.
+  header->consumer_idle.store(1, std::memory_order_relaxed);
+
+  return gin::CreateHandle(
+      thrower.isolate(),
+      new SharedRingBuffer(std::move(region), std::move(mapping), rounded));
+}
+
+// static
+gin::Handle<SharedRingBuffer> SharedRingBuffer::FromRegion(
+    v8::Isolate* isolate,
+    base::UnsafeSharedMemoryRegion region) {
+  if (!region.IsValid() || region.GetSize() < kHeaderSize)
+    return gin::Handle<SharedRingBuffer>();
+  base::WritableSharedMemoryMapping mapping = region.Map();
+  if (!mapping.IsValid())
+    return gin::Handle<SharedRingBuffer>();
+  const auto* header = static_cast<const Header*>(mapping.memory());
+  const size_t capacity = header->capacity;
+  if (header->magic != kMagic || capacity < kMinCapacity ||
+      capacity > kMaxCapacity || (capacity & (capacity - 1)) != 0 ||
+      region.GetSize() < kHeaderSize + capacity)
+    return gin::Handle<SharedRingBuffer>();
+  return gin::CreateHandle(
+      isolate,
+      new SharedRingBuffer(std::move(region), std::move(mapping), capacity));
+}
+
+base::UnsafeSharedMemoryRegion SharedRingBuffer::DuplicateRegion() const {
+  return region_.Duplicate();
+}
+
+SharedRingBuffer::Header* SharedRingBuffer::header() const {
+  return static_cast<Header*>(mapping_.memory());
+}
+
+void SharedRingBuffer::CopyIn(uint64_t position,
+                              const void* data,
+                              size_t size) {
+  uint8_t* records = static_cast<uint8_t*>(mapping_.memory()) + kHeaderSize;
+  const size_t offset = position & (capacity_ - 1);
+  const size_t first = std::min(size, capacity_ - offset);
+  memcpy(records + offset, data, first);
+  memcpy(records, static_cast<const uint8_t*>(data) + first, size - first);
+}
+
+void SharedRingBuffer::CopyOut(uint64_t position,
+                               void* data,
+                               size_t size) const {
+  const uint8_t* records =
+      static_cast<const uint8_t*>(mapping_.memory()) + kHeaderSize;
+  const size_t offset = position & (capacity_ - 1);
+  const size_t first = std::min(size, capacity_ - offset);
+  memcpy(data, records + offset, first);
+  memcpy(static_cast<uint8_t*>(data) + first, records, size - first);
+}
+
+bool SharedRingBuffer::Write(gin_helper::ErrorThrower thrower,
+                             v8::Local<v8::Value> data) {
+  const uint8_t* bytes = nullptr;
+  size_t size = 0;
+  if (data->IsArrayBufferView()) {
+    auto view = data.As<v8::ArrayBufferView>();
+    bytes = static_cast<const uint8_t*>(view->Buffer()->Data()) +
+            view->ByteOffset();
+    size = view->ByteLength();
+  } else if (data->IsArrayBuffer()) {
+    auto buffer = data.As<v8::ArrayBuffer>();
+    bytes = static_cast<const uint8_t*>(buffer->Data());
+    size = buffer->ByteLength();
+  } else {
+    thrower.ThrowTypeError("data must be an ArrayBuffer or ArrayBufferView");
+    return false;
+  }
+  if (corrupted_) {
+    ThrowCorrupted(thrower.isolate());
+    return false;
+  }
+  const size_t needed = sizeof(RecordSize) + size;
+  if (needed > capacity_) {
+    thrower.ThrowRangeError("data is larger than the ring buffer");
+    return false;
+  }
+
+  Header* header = this->header();
+  const uint64_t write = header->write_position.load(std::memory_order_relaxed);
+  const uint64_t read = header->read_position.load(std::memory_order_acquire);
+  if (write - read > capacity_) {
+    ThrowCorrupted(thrower.isolate());
+    return false;
+  }
+  if (capacity_ - (write - read) < needed)
+    return false;
+
+  const RecordSize record_size = size;
+  CopyIn(write, &record_size, sizeof(record_size));
+  CopyIn(write + sizeof(record_size), bytes, size);
+  // Sequentially consistent, along with the load of |consumer_idle| below, so
+  // that either this write is seen by a consumer going idle, or the consumer
+  // being idle is seen here.
+  header->write_position.store(write + needed);
+  if (!wake_up_handler_.IsEmpty() && header->consumer_idle.exchange(0)) {
+    v8::Isolate* isolate = thrower.isolate();
+    v8::Local<v8::Function> handler = wake_up_handler_.Get(isolate);
+    // An exception thrown by the handler propagates to the caller.
+    if (handler->Call(isolate->GetCurrentContext(), v8::Undefined(isolate), 0,
+                      nullptr)
+            .IsEmpty())
+      return false;
+  }
+  return true;
+}
+
+v8::MaybeLocal<v8::Value> SharedRingBuffer::ReadRecord(v8::Isolate* isolate) {
+  if (corrupted_) {
+    ThrowCorrupted(isolate);
+    return v8::MaybeLocal<v8::Value>();
+  }
+  Header* header = this->header();
+  const uint64_t read = header->read_position.load(std::memory_order_relaxed);
+  const uint64_t write = header->write_position.load(std::memory_order_acquire);
+  const uint64_t used = write - read;
+  if (used == 0)
+    return v8::Null(isolate);
+
+  RecordSize size = 0;
+  if (used > capacity_ || used < sizeof(size)) {
+    ThrowCorrupted(isolate);
+    return v8::MaybeLocal<v8::Value>();
+  }
+  CopyOut(read, &size, sizeof(size));
+  if (size > used - sizeof(size)) {
+    ThrowCorrupted(isolate);
+    return v8::MaybeLocal<v8::Value>();
+  }
+
+  std::unique_ptr<v8::BackingStore> backing_store =
+      v8::ArrayBuffer::NewBackingStore(isolate, size);
+  CopyOut(read + sizeof(size), backing_store->Data(), size);
+  header->read_position.store(read + sizeof(size) + size,
+                              std::memory_order_release);
+  v8::Local<v8::ArrayBuffer> buffer =
+      v8::ArrayBuffer::New(isolate, std::move(backing_store));
+  return v8::Uint8Array::New(buffer, 0, size);
+}
+
+v8::Local<v8::Value> SharedRingBuffer::Read(v8::Isolate* isolate) {
+  v8::Local<v8::Value> record;
+  if (!ReadRecord(isolate).ToLocal(&record))
+    return v8::Local<v8::Value>();
+  return record;
+}
+
+uint32_t SharedRingBuffer::Drain(v8::Isolate* isolate,
+                                 v8::Local<v8::Function> callback) {
+  // A callback draining the ring itself would see records out of order.
+  if (draining_)
+    return 0;
+  base::AutoReset<bool> draining(&draining_, true);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  Header* header = this->header();
+  uint32_t count = 0;
+  for (;;) {
+    for (;;) {
+      v8::Local<v8::Value> record;
+      if (!ReadRecord(isolate).ToLocal(&record))
+        return count;
+      if (record->IsNull())
+        break;
+      ++count;
+      if (callback->Call(context, v8::Undefined(isolate), 1, &record)
+              .IsEmpty())
+        return count;
+    }
+    // Going idle has to be visible before checking for records written
+    // meanwhile, whose producer may not have seen it yet.
+    header->consumer_idle.store(1);
+    if (header->write_position.load() ==
+        header->read_position.load(std::memory_order_relaxed))
+      return count;
+    header->consumer_idle.store(0, std::memory_order_relaxed);
+  }
+}
+
+void SharedRingBuffer::SetWakeUpHandler(v8::Isolate* isolate,
+                                        v8::Local<v8::Value> handler) {
+  if (handler->IsFunction())
+    wake_up_handler_.Reset(isolate, handler.As<v8::Function>());
+  else
+    wake_up_handler_.Reset();
+}
+
+void SharedRingBuffer::ThrowCorrupted(v8::Isolate* isolate) {
+  // The other end does not follow the protocol, so nothing it wrote can be
+  // trusted from here on.
+  corrupted_ = true;
+  gin_helper::ErrorThrower(isolate).ThrowError(
+      "The ring buffer was corrupted by the other end");
+}
+
+gin::ObjectTemplateBuilder SharedRingBuffer::GetObjectTemplateBuilder(
+    v8::Isolate* isolate) {
+  gin::PerIsolateData* data = gin::PerIsolateData::From(isolate);
+  auto* wrapper_info = &kWrapperInfo;
+  v8::Local<v8::FunctionTemplate> constructor =
+      data->GetFunctionTemplate(wrapper_info);
+  if (constructor.IsEmpty()) {
+    constructor = v8::FunctionTemplate::New(isolate);
+    constructor->SetClassName(gin::StringToV8(isolate, GetTypeName()));
+    data->SetFunctionTemplate(wrapper_info, constructor);
+  }
+  return gin::ObjectTemplateBuilder(isolate, GetTypeName(),
+                                    constructor->InstanceTemplate())
+      .SetMethod("write", &SharedRingBuffer::Write)
+      .SetMethod("read", &SharedRingBuffer::Read)
+      .SetMethod("drain", &SharedRingBuffer::Drain)
+      .SetMethod("setWakeUpHandler", &SharedRingBuffer::SetWakeUpHandler)
+      .SetProperty("capacity", &SharedRingBuffer::GetCapacity);
+}
+
+const char* SharedRingBuffer::GetTypeName() {
+  return "SharedRingBuffer";
+}
+
+// static
+gin::WrapperInfo SharedRingBuffer::kWrapperInfo = {gin::kEmbedderNativeGin};
+
+}  // namespace electron::api
+
+namespace {
+
+using electron::api::SharedRingBuffer;
+
+void Initialize(v8::Local<v8::Object> exports,
+                v8::Local<v8::Value> unused,
+                v8::Local<v8::Context> context,
+                void* priv) {
+  v8::Isolate* isolate = context->GetIsolate();
+  gin_helper::Dictionary dict(isolate, exports);
+  gin_helper::Dictionary shared_ring_buffer =
+      gin::Dictionary::CreateEmpty(isolate);
+  dict.Set("sharedRingBuffer", shared_ring_buffer);
+  shared_ring_buffer.SetMethod("create", &SharedRingBuffer::Create);
+}
+
+}  // namespace
+
+NODE_LINKED_BINDING_CONTEXT_AWARE(electron_common_shared_ring_buffer,
+                                  Initialize)
@@ -0,0 +1,99 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_COMMON_API_ELECTRON_API_SHARED_RING_BUFFER_H_
+#define ELECTRON_SHELL_COMMON_API_ELECTRON_API_SHARED_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/memory/shared_memory_mapping.h"
+#include "base/memory/unsafe_shared_memory_region.h"
+#include "gin/handle.h"
+#include "gin/wrappable.h"
+#include "v8/include/v8-forward.h"
+#include "v8/include/v8-persistent-handle.h"
+
+namespace gin_helper {
+class ErrorThrower;
+}
+
+namespace electron::api {
+
+// A single-producer/single-consumer queue of byte records in shared memory,
+// for streaming data between processes without a message per record. The
+// region is handed to the other process by posting the SharedRingBuffer with
+// postMessage; both ends then map the same memory.
+//
+// The producer only calls its wake up handler when the consumer has drained
+// everything and gone idle, so a busy stream costs no IPC at all.
+class SharedRingBuffer : public gin::Wrappable<SharedRingBuffer> {
+ public:
+  // Capacities are rounded up to a power of two within these bounds.
+  static constexpr size_t kMinCapacity = 4 * 1024;
+  static constexpr size_t kMaxCapacity = 64 * 1024 * 1024;
+  // Size of the header preceding the records in the region.
+  static constexpr size_t kHeaderSize = 256;
+
+  static gin::Handle<SharedRingBuffer> Create(gin_helper::ErrorThrower thrower,
+                                              double capacity);
+
+  // Maps a ring received from another process. Returns an empty handle when
+  // |region| does not hold a valid ring.
+  static gin::Handle<SharedRingBuffer> FromRegion(
+      v8::Isolate* isolate,
+      base::UnsafeSharedMemoryRegion region);
+
+  // gin::Wrappable
+  static gin::WrapperInfo kWrapperInfo;
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override;
+  const char* GetTypeName() override;
+
+  // disable copy
+  SharedRingBuffer(const SharedRingBuffer&) = delete;
+  SharedRingBuffer& operator=(const SharedRingBuffer&) = delete;
+
+  // Returns a handle to the ring's memory, for posting it to another process.
+  base::UnsafeSharedMemoryRegion DuplicateRegion() const;
+
+ private:
+  SharedRingBuffer(base::UnsafeSharedMemoryRegion region,
+                   base::WritableSharedMemoryMapping mapping,
+                   size_t capacity);
+  ~SharedRingBuffer() override;
+
+  struct Header;
+  Header* header() const;
+
+  // Copies between the records area and |data|, wrapping around its end.
+  void CopyIn(uint64_t position, const void* data, size_t size);
+  void CopyOut(uint64_t position, void* data, size_t size) const;
+
+  // Returns the next record, null when there is none, or an empty handle
+  // with an exception thrown when the other end corrupted the ring.
+  v8::MaybeLocal<v8::Value> ReadRecord(v8::Isolate* isolate);
+
+  bool Write(gin_helper::ErrorThrower thrower, v8::Local<v8::Value> data);
+  v8::Local<v8::Value> Read(v8::Isolate* isolate);
+  uint32_t Drain(v8::Isolate* isolate, v8::Local<v8::Function> callback);
+  void SetWakeUpHandler(v8::Isolate* isolate, v8::Local<v8::Value> handler);
+  size_t GetCapacity() const { return capacity_; }
+
+  void ThrowCorrupted(v8::Isolate* isolate);
+
+  base::UnsafeSharedMemoryRegion region_;
+  base::WritableSharedMemoryMapping mapping_;
+  // Read from the header once, when the ring is mapped; the other end could
+  // change the header's copy at any time.
+  const size_t capacity_;
+  bool corrupted_ = false;
+  bool draining_ = false;
+  v8::Global<v8::Function> wake_up_handler_;
+};
+
+}  // namespace electron::api
+
+#endif  // ELECTRON_SHELL_COMMON_API_ELECTRON_API_SHARED_RING_BUFFER_H_
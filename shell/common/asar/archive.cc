@@ -4,21 +4,26 @@
 
 #include "shell/common/asar/archive.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/check.h"
+#include "base/command_line.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
 #include "base/json/json_reader.h"
 #include "base/logging.h"
+#include "base/memory/shared_memory_mapping.h"
 #include "base/pickle.h"
-#include "base/strings/string_number_conversions.h"
+#include "base/trace_event/trace_event.h"
 #include "base/values.h"
 #include "electron/fuses.h"
 #include "shell/common/asar/asar_util.h"
 #include "shell/common/asar/scoped_temporary_file.h"
+#include "shell/common/options_switches.h"
 #include "shell/common/thread_restrictions.h"
 
 #if BUILDFLAG(IS_WIN)
@@ -29,129 +34,47 @@ namespace asar {
 
 namespace {
 
+// Converts |path| into the form the header index is keyed by.
 #if BUILDFLAG(IS_WIN)
-const char kSeparators[] = "\\/";
-#else
-const char kSeparators[] = "/";
-#endif
-
-const base::Value::Dict* GetNodeFromPath(std::string path,
-                                         const base::Value::Dict& root);
-
-// Gets the "files" from "dir".
-const base::Value::Dict* GetFilesNode(const base::Value::Dict& root,
-                                      const base::Value::Dict& dir) {
-  // Test for symbol linked directory.
-  const std::string* link = dir.FindString("link");
-  if (link != nullptr) {
-    const base::Value::Dict* linked_node = GetNodeFromPath(*link, root);
-    if (!linked_node)
-      return nullptr;
-    return linked_node->FindDict("files");
-  }
-
-  return dir.FindDict("files");
+std::string ToIndexKey(const base::FilePath& path) {
+  std::string key = path.AsUTF8Unsafe();
+  std::replace(key.begin(), key.end(), '\\', '/');
+  return key;
 }
-
-// Gets sub-file "name" from "dir".
-const base::Value::Dict* GetChildNode(const base::Value::Dict& root,
-                                      const std::string& name,
-                                      const base::Value::Dict& dir) {
-  if (name.empty())
-    return &root;
-
-  const base::Value::Dict* files = GetFilesNode(root, dir);
-  return files ? files->FindDict(name) : nullptr;
+#else
+const std::string& ToIndexKey(const base::FilePath& path) {
+  return path.value();
 }
+#endif
 
-// Gets the node of "path" from "root".
-const base::Value::Dict* GetNodeFromPath(std::string path,
-                                         const base::Value::Dict& root) {
-  if (path.empty())
-    return &root;
-
-  const base::Value::Dict* dir = &root;
-  for (size_t delimiter_position = path.find_first_of(kSeparators);
-       delimiter_position != std::string::npos;
-       delimiter_position = path.find_first_of(kSeparators)) {
-    const base::Value::Dict* child =
-        GetChildNode(root, path.substr(0, delimiter_position), *dir);
-    if (!child)
-      return nullptr;
-
-    dir = child;
-    path.erase(0, delimiter_position + 1);
-  }
-
-  return GetChildNode(root, path, *dir);
+// Precedes the serialized index in the region made by ShareIndex, so that a
+// child can tell whether it still describes the file it opened.
+struct SharedIndexHeader {
+  uint32_t header_size;
+  uint32_t header_validated;
+  int64_t file_size;
+  int64_t last_modified;
+};
+static_assert(sizeof(SharedIndexHeader) % sizeof(uint64_t) == 0,
+              "The index must stay 8-byte aligned");
+
+int64_t ToSharedTime(base::Time time) {
+  return time.ToDeltaSinceWindowsEpoch().InMicroseconds();
 }
 
-bool FillFileInfoWithNode(Archive::FileInfo* info,
-                          uint32_t header_size,
-                          bool load_integrity,
-                          const base::Value::Dict* node) {
-  if (absl::optional<int> size = node->FindInt("size")) {
-    info->size = static_cast<uint32_t>(*size);
-  } else {
-    return false;
-  }
-
-  if (absl::optional<bool> unpacked = node->FindBool("unpacked")) {
-    info->unpacked = *unpacked;
-    if (info->unpacked) {
-      return true;
-    }
-  }
-
-  const std::string* offset = node->FindString("offset");
-  if (offset &&
-      base::StringToUint64(base::StringPiece(*offset), &info->offset)) {
-    info->offset += header_size;
-  } else {
-    return false;
-  }
-
-  if (absl::optional<bool> executable = node->FindBool("executable")) {
-    info->executable = *executable;
-  }
-
+bool ShouldValidateHeader(const Archive& archive) {
 #if BUILDFLAG(IS_MAC)
-  if (load_integrity &&
-      electron::fuses::IsEmbeddedAsarIntegrityValidationEnabled()) {
-    if (const base::Value::Dict* integrity = node->FindDict("integrity")) {
-      const std::string* algorithm = integrity->FindString("algorithm");
-      const std::string* hash = integrity->FindString("hash");
-      absl::optional<int> block_size = integrity->FindInt("blockSize");
-      const base::Value::List* blocks = integrity->FindList("blocks");
-
-      if (algorithm && hash && block_size && block_size > 0 && blocks) {
-        IntegrityPayload integrity_payload;
-        integrity_payload.hash = *hash;
-        integrity_payload.block_size =
-            static_cast<uint32_t>(block_size.value());
-        for (auto& value : *blocks) {
-          if (const std::string* block = value.GetIfString()) {
-            integrity_payload.blocks.push_back(*block);
-          } else {
-            LOG(FATAL)
-                << "Invalid block integrity value for file in ASAR archive";
-          }
-        }
-        if (*algorithm == "SHA256") {
-          integrity_payload.algorithm = HashAlgorithm::kSHA256;
-          info->integrity = std::move(integrity_payload);
-        }
-      }
-    }
-
-    if (!info->integrity.has_value()) {
-      LOG(FATAL) << "Failed to read integrity for file in ASAR archive";
-      return false;
-    }
-  }
+  return electron::fuses::IsEmbeddedAsarIntegrityValidationEnabled() &&
+         archive.RelativePath().has_value();
+#else
+  return false;
 #endif
+}
 
-  return true;
+bool ShouldMapArchives() {
+  return base::CommandLine::InitializedForCurrentProcess() &&
+         base::CommandLine::ForCurrentProcess()->HasSwitch(
+             electron::switches::kAsarMmap);
 }
 
 }  // namespace
@@ -221,6 +144,13 @@ bool Archive::Init() {
     return false;
   }
 
+  header_size_ = 8 + size;
+
+  if (AttachSharedIndex(GetSharedArchiveIndex(path_))) {
+    MapArchive();
+    return true;
+  }
+
   buf.resize(size);
   {
     electron::ScopedAllowBlockingForElectron allow_blocking;
@@ -231,17 +161,22 @@ bool Archive::Init() {
     return false;
   }
 
-  std::string header;
-  if (!base::PickleIterator(base::Pickle(buf.data(), buf.size()))
-           .ReadString(&header)) {
+  // The JSON header may be followed by a precompiled binary index, which
+  // readers that do not know about it ignore.
+  base::Pickle pickle(buf.data(), buf.size());
+  base::PickleIterator iter(pickle);
+  base::StringPiece header;
+  if (!iter.ReadStringPiece(&header)) {
     LOG(ERROR) << "Failed to parse header from " << path_.value();
     return false;
   }
+  const char* binary_index = nullptr;
+  size_t binary_index_length = 0;
+  bool has_binary_index = iter.ReadData(&binary_index, &binary_index_length);
 
 #if BUILDFLAG(IS_MAC)
   // Validate header signature if required and possible
-  if (electron::fuses::IsEmbeddedAsarIntegrityValidationEnabled() &&
-      RelativePath().has_value()) {
+  if (ShouldValidateHeader(*this)) {
     absl::optional<IntegrityPayload> integrity = HeaderIntegrity();
     if (!integrity.has_value()) {
       LOG(FATAL) << "Failed to get integrity for validatable asar archive: "
@@ -253,7 +188,7 @@ bool Archive::Init() {
     // more below ensure we read them in preference order from most secure to
     // least
     if (integrity.value().algorithm != HashAlgorithm::kNone) {
-      ValidateIntegrityOrDie(header.c_str(), header.length(),
+      ValidateIntegrityOrDie(header.data(), header.length(),
                              integrity.value());
     } else {
       LOG(FATAL) << "No eligible hash for validatable asar archive: "
@@ -264,17 +199,120 @@ bool Archive::Init() {
   }
 #endif
 
-  absl::optional<base::Value> value = base::JSONReader::Read(header);
-  if (!value || !value->is_dict()) {
-    LOG(ERROR) << "Failed to parse header";
+  // Only the JSON header is covered by the integrity hash, so the binary index
+  // is not trusted when integrity is being validated.
+  if (has_binary_index && !header_validated_) {
+    TRACE_EVENT1("electron", "Archive::LoadBinaryIndex", "size",
+                 binary_index_length);
+    index_ = ArchiveIndex::CreateFromBinary(base::make_span(
+        reinterpret_cast<const uint8_t*>(binary_index), binary_index_length));
+    if (!index_) {
+      LOG(WARNING) << "Ignoring invalid binary index in " << path_.value();
+    }
+  }
+
+  if (!index_) {
+    TRACE_EVENT1("electron", "Archive::ParseJSONHeader", "size",
+                 header.size());
+    absl::optional<base::Value> value = base::JSONReader::Read(header);
+    if (!value || !value->is_dict()) {
+      LOG(ERROR) << "Failed to parse header";
+      return false;
+    }
+
+    index_ = ArchiveIndex::Create(value->GetDict(), header_validated_);
+  }
+
+  MapArchive();
+  return true;
+}
+
+bool Archive::AttachSharedIndex(base::ReadOnlySharedMemoryRegion region) {
+  if (!region.IsValid())
+    return false;
+
+  TRACE_EVENT0("electron", "Archive::AttachSharedIndex");
+  base::ReadOnlySharedMemoryMapping mapping = region.Map();
+  if (!mapping.IsValid() || mapping.size() < sizeof(SharedIndexHeader))
+    return false;
+  SharedIndexHeader header;
+  memcpy(&header, mapping.memory(), sizeof(header));
+
+  base::File::Info info;
+  {
+    electron::ScopedAllowBlockingForElectron allow_blocking;
+    if (!file_.GetInfo(&info))
+      return false;
+  }
+  // The archive may have been replaced since the browser process opened it.
+  if (header.header_size != header_size_ || header.file_size != info.size ||
+      header.last_modified != ToSharedTime(info.last_modified)) {
     return false;
   }
+  // An index built without integrity data cannot stand in for a header this
+  // process is required to validate.
+  if (ShouldValidateHeader(*this) && !header.header_validated)
+    return false;
 
-  header_size_ = 8 + size;
-  header_ = std::move(value->GetDict());
+  index_ = ArchiveIndex::CreateFromSharedMemory(std::move(mapping),
+                                                sizeof(SharedIndexHeader));
+  if (!index_) {
+    LOG(WARNING) << "Ignoring invalid shared index for " << path_.value();
+    return false;
+  }
+  header_validated_ = header.header_validated != 0;
+  has_shared_index_ = true;
   return true;
 }
 
+void Archive::MapArchive() {
+  if (!ShouldMapArchives())
+    return;
+
+  electron::ScopedAllowBlockingForElectron allow_blocking;
+  auto mapped_file = std::make_unique<base::MemoryMappedFile>();
+  if (mapped_file->Initialize(file_.Duplicate())) {
+    mapped_file_ = std::move(mapped_file);
+  } else {
+    LOG(WARNING) << "Failed to map " << path_.value()
+                 << ", falling back to file reads";
+  }
+}
+
+base::ReadOnlySharedMemoryRegion Archive::ShareIndex() {
+  if (!index_)
+    return {};
+
+  base::AutoLock auto_lock(shared_index_lock_);
+  if (!shared_index_.IsValid()) {
+    TRACE_EVENT0("electron", "Archive::ShareIndex");
+    base::File::Info info;
+    {
+      electron::ScopedAllowBlockingForElectron allow_blocking;
+      if (!file_.GetInfo(&info))
+        return {};
+    }
+
+    const size_t index_size = index_->GetSerializedSize();
+    base::MappedReadOnlyRegion shared =
+        base::ReadOnlySharedMemoryRegion::Create(sizeof(SharedIndexHeader) +
+                                                 index_size);
+    if (!shared.IsValid())
+      return {};
+
+    SharedIndexHeader header = {};
+    header.header_size = header_size_;
+    header.header_validated = header_validated_;
+    header.file_size = info.size;
+    header.last_modified = ToSharedTime(info.last_modified);
+    base::span<uint8_t> memory = shared.mapping.GetMemoryAsSpan<uint8_t>();
+    memcpy(memory.data(), &header, sizeof(header));
+    index_->Serialize(memory.subspan(sizeof(header)));
+    shared_index_ = std::move(shared.region);
+  }
+  return shared_index_.Duplicate();
+}
+
 #if !BUILDFLAG(IS_MAC)
 absl::optional<IntegrityPayload> Archive::HeaderIntegrity() const {
   return absl::nullopt;
@@ -285,78 +323,115 @@ absl::optional<base::FilePath> Archive::RelativePath() const {
 }
 #endif
 
-bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) const {
-  if (!header_)
-    return false;
+const ArchiveIndex::Node* Archive::FindNode(
+    const base::FilePath& path) const {
+  if (!index_)
+    return nullptr;
 
-  const base::Value::Dict* node =
-      GetNodeFromPath(path.AsUTF8Unsafe(), *header_);
+  lookups_.fetch_add(1, std::memory_order_relaxed);
+  const ArchiveIndex::Node* node = index_->Find(ToIndexKey(path));
   if (!node)
+    lookup_misses_.fetch_add(1, std::memory_order_relaxed);
+  return node;
+}
+
+bool Archive::FillFileInfo(const ArchiveIndex::Node& node,
+                           FileInfo* info) const {
+  if (node.type != ArchiveIndex::NodeType::kFile || !node.has_info())
     return false;
 
-  const std::string* link = node->FindString("link");
-  if (link)
-    return GetFileInfo(base::FilePath::FromUTF8Unsafe(*link), info);
+  info->size = node.size;
+  info->unpacked = node.unpacked();
+  if (info->unpacked)
+    return true;
+
+  if (node.offset > UINT64_MAX - header_size_)
+    return false;
+  info->offset = header_size_ + node.offset;
+  info->executable = node.executable();
+
+#if BUILDFLAG(IS_MAC)
+  if (header_validated_ &&
+      electron::fuses::IsEmbeddedAsarIntegrityValidationEnabled()) {
+    const ArchiveIndex::Integrity* integrity = index_->GetIntegrity(node);
+    if (!integrity) {
+      LOG(FATAL) << "Failed to read integrity for file in ASAR archive";
+      return false;
+    }
+
+    IntegrityPayload integrity_payload;
+    integrity_payload.algorithm = HashAlgorithm::kSHA256;
+    integrity_payload.hash = std::string(index_->GetString(integrity->hash));
+    integrity_payload.block_size = integrity->block_size;
+    integrity_payload.blocks.reserve(integrity->block_count);
+    for (uint32_t i = 0; i < integrity->block_count; ++i) {
+      integrity_payload.blocks.emplace_back(
+          index_->GetIntegrityBlock(*integrity, i));
+    }
+    info->integrity = std::move(integrity_payload);
+  }
+#endif
 
-  return FillFileInfoWithNode(info, header_size_, header_validated_, node);
+  return true;
 }
 
-bool Archive::Stat(const base::FilePath& path, Stats* stats) const {
-  if (!header_)
+bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) const {
+  const ArchiveIndex::Node* node = FindNode(path);
+  if (!node)
+    return false;
+
+  node = index_->ResolveLinks(node);
+  if (!node)
     return false;
 
-  const base::Value::Dict* node =
-      GetNodeFromPath(path.AsUTF8Unsafe(), *header_);
+  return FillFileInfo(*node, info);
+}
+
+bool Archive::Stat(const base::FilePath& path, Stats* stats) const {
+  const ArchiveIndex::Node* node = FindNode(path);
   if (!node)
     return false;
 
-  if (node->Find("link")) {
+  if (node->type == ArchiveIndex::NodeType::kLink) {
     stats->is_file = false;
     stats->is_link = true;
     return true;
   }
 
-  if (node->Find("files")) {
+  if (node->type == ArchiveIndex::NodeType::kDirectory) {
     stats->is_file = false;
     stats->is_directory = true;
     return true;
   }
 
-  return FillFileInfoWithNode(stats, header_size_, header_validated_, node);
+  return FillFileInfo(*node, stats);
 }
 
 bool Archive::Readdir(const base::FilePath& path,
                       std::vector<base::FilePath>* files) const {
-  if (!header_)
-    return false;
-
-  const base::Value::Dict* node =
-      GetNodeFromPath(path.AsUTF8Unsafe(), *header_);
+  const ArchiveIndex::Node* node = FindNode(path);
   if (!node)
     return false;
 
-  const base::Value::Dict* files_node = GetFilesNode(*header_, *node);
-  if (!files_node)
+  const ArchiveIndex::Node* dir = index_->GetDirectory(*node);
+  if (!dir)
     return false;
 
-  for (const auto iter : *files_node)
-    files->push_back(base::FilePath::FromUTF8Unsafe(iter.first));
+  base::span<const ArchiveIndex::Node> children = index_->Children(*dir);
+  files->reserve(files->size() + children.size());
+  for (const auto& child : children)
+    files->push_back(base::FilePath::FromUTF8Unsafe(index_->Name(child)));
   return true;
 }
 
 bool Archive::Realpath(const base::FilePath& path,
                        base::FilePath* realpath) const {
-  if (!header_)
-    return false;
-
-  const base::Value::Dict* node =
-      GetNodeFromPath(path.AsUTF8Unsafe(), *header_);
+  const ArchiveIndex::Node* node = FindNode(path);
   if (!node)
     return false;
 
-  const std::string* link = node->FindString("link");
-  if (link) {
-    *realpath = base::FilePath::FromUTF8Unsafe(*link);
+  if (node->type == ArchiveIndex::NodeType::kLink) {
+    *realpath = base::FilePath::FromUTF8Unsafe(index_->GetString(node->link));
     return true;
   }
 
@@ -365,7 +440,7 @@ bool Archive::Realpath(const base::FilePath& path,
 }
 
 bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
-  if (!header_)
+  if (!index_)
     return false;
 
   base::AutoLock auto_lock(external_files_lock_);
@@ -407,4 +482,28 @@ int Archive::GetUnsafeFD() const {
   return fd_;
 }
 
+base::span<const uint8_t> Archive::GetMappedData() const {
+  if (!mapped_file_)
+    return {};
+  return base::make_span(mapped_file_->data(), mapped_file_->length());
+}
+
+absl::optional<base::span<const uint8_t>> Archive::GetMappedContents(
+    const FileInfo& info) const {
+  if (!mapped_file_ || info.unpacked)
+    return absl::nullopt;
+
+  base::span<const uint8_t> data = GetMappedData();
+  if (info.offset > data.size() || info.size > data.size() - info.offset)
+    return absl::nullopt;
+  return data.subspan(info.offset, info.size);
+}
+
+Archive::LookupStats Archive::GetLookupStats() const {
+  LookupStats stats;
+  stats.lookups = lookups_.load(std::memory_order_relaxed);
+  stats.misses = lookup_misses_.load(std::memory_order_relaxed);
+  return stats;
+}
+
 }  // namespace asar
@@ -5,15 +5,19 @@
 #ifndef ELECTRON_SHELL_COMMON_ASAR_ARCHIVE_H_
 #define ELECTRON_SHELL_COMMON_ASAR_ARCHIVE_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "base/containers/span.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/read_only_shared_memory_region.h"
 #include "base/synchronization/lock.h"
-#include "base/values.h"
+#include "shell/common/asar/archive_index.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace asar {
@@ -56,6 +60,12 @@ class Archive {
     bool is_link;
   };
 
+  // Counters for path lookups against the header index.
+  struct LookupStats {
+    uint64_t lookups = 0;
+    uint64_t misses = 0;
+  };
+
   explicit Archive(const base::FilePath& path);
   virtual ~Archive();
 
@@ -63,7 +73,9 @@ class Archive {
   Archive(const Archive&) = delete;
   Archive& operator=(const Archive&) = delete;
 
-  // Read and parse the header.
+  // Read and parse the header, or attach to the index the browser process
+  // shared for this archive, see ShareIndex. When the process was started
+  // with --asar-mmap the archive is also mapped into memory.
   bool Init();
 
   absl::optional<IntegrityPayload> HeaderIntegrity() const;
@@ -92,16 +104,55 @@ class Archive {
   // for integrity validation after this fd is handed over.
   int GetUnsafeFD() const;
 
+  // Returns the whole archive when it is memory-mapped, or an empty span. The
+  // mapping lives as long as this Archive.
+  base::span<const uint8_t> GetMappedData() const;
+
+  // Returns the contents of the packed file described by |info| straight
+  // out of the memory mapping, or absl::nullopt if the archive is not mapped
+  // or the file is unpacked. The contents are not validated.
+  absl::optional<base::span<const uint8_t>> GetMappedContents(
+      const FileInfo& info) const;
+
+  // Returns how many paths have been looked up, and how many of them were
+  // not found in the archive.
+  LookupStats GetLookupStats() const;
+
+  // Returns a read-only shared memory region holding the header index, which
+  // child processes attach to instead of parsing the header again. It is
+  // created on first use; an invalid region is returned on failure.
+  base::ReadOnlySharedMemoryRegion ShareIndex();
+
+  // Whether the index was attached from another process rather than parsed
+  // from the header.
+  bool HasSharedIndex() const { return has_shared_index_; }
+
   base::FilePath path() const { return path_; }
 
  private:
+  // Uses an index from ShareIndex if it was made for this very file.
+  bool AttachSharedIndex(base::ReadOnlySharedMemoryRegion region);
+  void MapArchive();
+
+  // Looks up |path| in the header index, recording the lookup.
+  const ArchiveIndex::Node* FindNode(const base::FilePath& path) const;
+  bool FillFileInfo(const ArchiveIndex::Node& node, FileInfo* info) const;
+
   bool initialized_;
   bool header_validated_ = false;
+  bool has_shared_index_ = false;
   const base::FilePath path_;
   base::File file_;
   int fd_ = -1;
+  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
   uint32_t header_size_ = 0;
-  absl::optional<base::Value::Dict> header_;
+  std::unique_ptr<ArchiveIndex> index_;
+
+  base::Lock shared_index_lock_;
+  base::ReadOnlySharedMemoryRegion shared_index_;
+
+  mutable std::atomic<uint64_t> lookups_{0};
+  mutable std::atomic<uint64_t> lookup_misses_{0};
 
   // Cached external temporary files.
   base::Lock external_files_lock_;
@@ -0,0 +1,620 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/common/asar/archive_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/hash/hash.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "electron/fuses.h"
+
+namespace asar {
+
+namespace {
+
+#if BUILDFLAG(IS_WIN)
+const char kSeparators[] = "\\/";
+#else
+const char kSeparators[] = "/";
+#endif
+
+// Binary index format. All fields are little-endian, which is the native byte
+// order of every platform Electron supports, so the records are used as-is.
+constexpr char kBinaryIndexMagic[8] = {'A', 'S', 'A', 'R', 'I', 'D', 'X', 0};
+constexpr uint32_t kBinaryIndexVersion = 1;
+
+struct BinaryIndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t node_count;
+  uint32_t integrity_count;
+  uint32_t block_count;
+  uint32_t string_pool_size;
+  uint32_t reserved;
+};
+static_assert(sizeof(BinaryIndexHeader) == 32, "Unexpected padding");
+
+static_assert(sizeof(ArchiveIndex::Node) == 56, "Unexpected padding");
+static_assert(offsetof(ArchiveIndex::Node, type) == 48, "Unexpected padding");
+static_assert(sizeof(ArchiveIndex::Integrity) == 20, "Unexpected padding");
+static_assert(sizeof(ArchiveIndex::StringRef) == 8, "Unexpected padding");
+static_assert(std::is_trivially_copyable_v<ArchiveIndex::Node>,
+              "Nodes are used in place");
+
+// Points |out| at |count| records of type T in |data| at |*position|.
+template <typename T>
+bool TakeRecords(base::span<const uint8_t> data,
+                 size_t* position,
+                 uint32_t count,
+                 base::span<const T>* out) {
+  size_t size = static_cast<size_t>(count) * sizeof(T);
+  if (*position > data.size() || size > data.size() - *position)
+    return false;
+  const uint8_t* records = data.data() + *position;
+  DCHECK_EQ(reinterpret_cast<uintptr_t>(records) % alignof(T), 0u);
+  *out = base::make_span(reinterpret_cast<const T*>(records), count);
+  *position += size;
+  return true;
+}
+
+uint32_t HashPath(base::StringPiece path) {
+  // Persistent so that a table built by the browser process can be probed
+  // by its children.
+  return base::PersistentHash(base::as_bytes(base::make_span(path)));
+}
+
+// Link resolution state used while building the index.
+enum LinkState : uint8_t {
+  kUnresolved,
+  kResolving,
+  kResolved,
+};
+
+// Returns true if |path| could resolve differently when walked component by
+// component than when looked up verbatim, i.e. it has empty components or
+// non-canonical separators.
+bool NeedsWalk(base::StringPiece path) {
+  if (path.empty())
+    return false;
+  if (path.front() == '/' || path.back() == '/')
+    return true;
+#if BUILDFLAG(IS_WIN)
+  if (path.find('\\') != base::StringPiece::npos)
+    return true;
+#endif
+  return path.find("//") != base::StringPiece::npos;
+}
+
+}  // namespace
+
+ArchiveIndex::ArchiveIndex() = default;
+
+ArchiveIndex::~ArchiveIndex() = default;
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::Create(
+    const base::Value::Dict& header,
+    bool load_integrity) {
+  auto index = base::WrapUnique(new ArchiveIndex());
+
+  Node root;
+  root.type = NodeType::kDirectory;
+  index->owned_nodes_.push_back(root);
+  if (const base::Value::Dict* files = header.FindDict("files"))
+    index->AddChildren(kRootNode, *files, load_integrity);
+  index->UseOwnedTables();
+
+  if (index->has_links_) {
+    std::vector<uint8_t> state(index->nodes_.size(), kUnresolved);
+    for (uint32_t id = 0; id < index->nodes_.size(); ++id) {
+      if (index->nodes_[id].type == NodeType::kLink)
+        index->ResolveLink(id, &state);
+    }
+  }
+
+  index->BuildPathTable();
+  return index;
+}
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::CreateFromBinary(
+    base::span<const uint8_t> data) {
+  auto index = base::WrapUnique(new ArchiveIndex());
+  // The index sits at an arbitrary position in the header pickle, so it is
+  // copied once to get its records aligned.
+  index->buffer_.resize(data.size() / sizeof(uint64_t) + 1);
+  if (!data.empty())
+    memcpy(index->buffer_.data(), data.data(), data.size());
+
+  size_t end;
+  if (!index->AttachTables(
+          base::as_bytes(base::make_span(index->buffer_)).first(data.size()),
+          &end) ||
+      end != data.size() || !index->Validate()) {
+    return nullptr;
+  }
+
+  index->BuildPathTable();
+  return index;
+}
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::CreateFromSharedMemory(
+    base::ReadOnlySharedMemoryMapping mapping,
+    size_t offset) {
+  if (!mapping.IsValid() || offset > mapping.size() ||
+      offset % sizeof(uint64_t) != 0) {
+    return nullptr;
+  }
+  base::span<const uint8_t> data =
+      mapping.GetMemoryAsSpan<uint8_t>().subspan(offset);
+
+  auto index = base::WrapUnique(new ArchiveIndex());
+  size_t position;
+  if (!index->AttachTables(data, &position))
+    return nullptr;
+
+  // The path table follows the string pool, 4-byte aligned.
+  position = base::bits::AlignUp(position, sizeof(uint32_t));
+  uint32_t bucket_count;
+  if (position > data.size() || data.size() - position < sizeof(bucket_count))
+    return nullptr;
+  memcpy(&bucket_count, data.data() + position, sizeof(bucket_count));
+  position += sizeof(bucket_count);
+  if (!base::bits::IsPowerOfTwo(bucket_count) ||
+      bucket_count < index->nodes_.size() ||
+      !TakeRecords(data, &position, bucket_count, &index->path_table_) ||
+      position != data.size()) {
+    return nullptr;
+  }
+  for (uint32_t id : index->path_table_) {
+    if (id != kInvalidNode && id >= index->nodes_.size())
+      return nullptr;
+  }
+
+  if (!index->Validate())
+    return nullptr;
+
+  index->mapping_ = std::move(mapping);
+  return index;
+}
+
+bool ArchiveIndex::AttachTables(base::span<const uint8_t> data, size_t* end) {
+  BinaryIndexHeader header;
+  if (data.size() < sizeof(header))
+    return false;
+  memcpy(&header, data.data(), sizeof(header));
+  if (memcmp(header.magic, kBinaryIndexMagic, sizeof(header.magic)) != 0 ||
+      header.version != kBinaryIndexVersion || header.node_count == 0) {
+    return false;
+  }
+
+  size_t position = sizeof(header);
+  if (!TakeRecords(data, &position, header.node_count, &nodes_) ||
+      !TakeRecords(data, &position, header.integrity_count, &integrity_) ||
+      !TakeRecords(data, &position, header.block_count, &integrity_blocks_) ||
+      data.size() - position < header.string_pool_size) {
+    return false;
+  }
+  strings_ = base::StringPiece(
+      reinterpret_cast<const char*>(data.data()) + position,
+      header.string_pool_size);
+  *end = position + header.string_pool_size;
+
+  has_links_ = std::any_of(nodes_.begin(), nodes_.end(), [](const Node& node) {
+    return node.type == NodeType::kLink;
+  });
+  return true;
+}
+
+void ArchiveIndex::UseOwnedTables() {
+  nodes_ = owned_nodes_;
+  integrity_ = owned_integrity_;
+  integrity_blocks_ = owned_integrity_blocks_;
+  strings_ = owned_strings_;
+}
+
+bool ArchiveIndex::IsValidStringRef(StringRef ref) const {
+  return ref.offset <= strings_.size() &&
+         ref.length <= strings_.size() - ref.offset;
+}
+
+bool ArchiveIndex::Validate() const {
+  const uint64_t node_count = nodes_.size();
+  const Node& root = nodes_[kRootNode];
+  if (root.type != NodeType::kDirectory || root.path.length != 0)
+    return false;
+
+  for (uint32_t id = 0; id < node_count; ++id) {
+    const Node& node = nodes_[id];
+    if (!IsValidStringRef(node.path) || node.name_offset > node.path.length)
+      return false;
+
+    if (static_cast<uint8_t>(node.type) >
+        static_cast<uint8_t>(NodeType::kLink))
+      return false;
+
+    switch (node.type) {
+      case NodeType::kDirectory: {
+        // Children always follow their parent, which also rules out cycles.
+        uint64_t end = static_cast<uint64_t>(node.first_child) +
+                       node.child_count;
+        if ((node.child_count && node.first_child <= id) || end > node_count)
+          return false;
+        for (uint32_t i = 1; i < node.child_count; ++i) {
+          if (Name(nodes_[node.first_child + i - 1]) >=
+              Name(nodes_[node.first_child + i]))
+            return false;
+        }
+        break;
+      }
+      case NodeType::kLink:
+        if (!IsValidStringRef(node.link) ||
+            (node.link_target != kInvalidNode &&
+             node.link_target >= node_count))
+          return false;
+        break;
+      case NodeType::kFile:
+        if (node.integrity != kInvalidNode &&
+            node.integrity >= integrity_.size())
+          return false;
+        break;
+    }
+  }
+
+  for (const Integrity& integrity : integrity_) {
+    uint64_t end =
+        static_cast<uint64_t>(integrity.first_block) + integrity.block_count;
+    if (!IsValidStringRef(integrity.hash) || integrity.block_size == 0 ||
+        end > integrity_blocks_.size())
+      return false;
+  }
+
+  for (const StringRef& block : integrity_blocks_) {
+    if (!IsValidStringRef(block))
+      return false;
+  }
+
+  return true;
+}
+
+void ArchiveIndex::BuildPathTable() {
+  // At most half full, which keeps probe sequences short.
+  size_t bucket_count = 8;
+  while (bucket_count < nodes_.size() * 2)
+    bucket_count *= 2;
+  owned_path_table_.assign(bucket_count, kInvalidNode);
+  const uint32_t mask = static_cast<uint32_t>(owned_path_table_.size() - 1);
+  for (uint32_t id = 0; id < nodes_.size(); ++id) {
+    uint32_t bucket = HashPath(GetString(nodes_[id].path)) & mask;
+    while (owned_path_table_[bucket] != kInvalidNode)
+      bucket = (bucket + 1) & mask;
+    owned_path_table_[bucket] = id;
+  }
+  path_table_ = owned_path_table_;
+}
+
+uint32_t ArchiveIndex::LookupPath(base::StringPiece path) const {
+  const uint32_t mask = static_cast<uint32_t>(path_table_.size() - 1);
+  uint32_t bucket = HashPath(path) & mask;
+  for (size_t probes = 0; probes < path_table_.size(); ++probes) {
+    uint32_t id = path_table_[bucket];
+    if (id == kInvalidNode)
+      break;
+    if (GetString(nodes_[id].path) == path)
+      return id;
+    bucket = (bucket + 1) & mask;
+  }
+  return kInvalidNode;
+}
+
+uint32_t ArchiveIndex::AddString(base::StringPiece str) {
+  CHECK_LE(owned_strings_.size() + str.size(),
+           static_cast<size_t>(UINT32_MAX));
+  uint32_t offset = static_cast<uint32_t>(owned_strings_.size());
+  owned_strings_.append(str.data(), str.size());
+  return offset;
+}
+
+void ArchiveIndex::AddChildren(uint32_t parent,
+                               const base::Value::Dict& dir,
+                               bool load_integrity) {
+  // Reserve a contiguous range for the children first, so that they can be
+  // binary searched by name. base::Value::Dict iterates in key order.
+  const uint32_t first_child = static_cast<uint32_t>(owned_nodes_.size());
+  const StringRef parent_ref = owned_nodes_[parent].path;
+  const std::string parent_path =
+      owned_strings_.substr(parent_ref.offset, parent_ref.length);
+  std::vector<const base::Value::Dict*> dicts;
+  for (const auto [name, value] : dir) {
+    const base::Value::Dict* dict = value.GetIfDict();
+    if (!dict)
+      continue;
+
+    Node node;
+    if (parent_path.empty()) {
+      node.path.offset = AddString(name);
+    } else {
+      node.path.offset = AddString(parent_path);
+      AddString("/");
+      AddString(name);
+      node.name_offset = static_cast<uint32_t>(parent_path.size() + 1);
+    }
+    node.path.length = static_cast<uint32_t>(owned_strings_.size()) -
+                       node.path.offset;
+
+    if (const std::string* link = dict->FindString("link")) {
+      node.type = NodeType::kLink;
+      node.link.offset = AddString(*link);
+      node.link.length = static_cast<uint32_t>(link->size());
+      has_links_ = true;
+    } else if (dict->FindDict("files")) {
+      node.type = NodeType::kDirectory;
+    } else {
+      FillFile(&node, *dict, load_integrity);
+    }
+
+    owned_nodes_.push_back(node);
+    dicts.push_back(dict);
+  }
+
+  owned_nodes_[parent].first_child = first_child;
+  owned_nodes_[parent].child_count = static_cast<uint32_t>(dicts.size());
+
+  for (uint32_t i = 0; i < dicts.size(); ++i) {
+    if (owned_nodes_[first_child + i].type != NodeType::kDirectory)
+      continue;
+    AddChildren(first_child + i, *dicts[i]->FindDict("files"),
+                load_integrity);
+  }
+}
+
+void ArchiveIndex::FillFile(Node* node,
+                            const base::Value::Dict& dict,
+                            bool load_integrity) {
+  if (absl::optional<int> size = dict.FindInt("size")) {
+    node->size = static_cast<uint32_t>(*size);
+  } else {
+    return;
+  }
+
+  if (dict.FindBool("unpacked").value_or(false)) {
+    node->flags |= Node::kHasInfo | Node::kUnpacked;
+    return;
+  }
+
+  const std::string* offset = dict.FindString("offset");
+  if (!offset ||
+      !base::StringToUint64(base::StringPiece(*offset), &node->offset)) {
+    return;
+  }
+
+  if (dict.FindBool("executable").value_or(false))
+    node->flags |= Node::kExecutable;
+
+  node->flags |= Node::kHasInfo;
+
+#if BUILDFLAG(IS_MAC)
+  // A missing or malformed payload is only fatal once the file is looked up,
+  // see Archive::GetFileInfo.
+  if (load_integrity &&
+      electron::fuses::IsEmbeddedAsarIntegrityValidationEnabled()) {
+    const base::Value::Dict* integrity = dict.FindDict("integrity");
+    if (!integrity)
+      return;
+
+    const std::string* algorithm = integrity->FindString("algorithm");
+    const std::string* hash = integrity->FindString("hash");
+    absl::optional<int> block_size = integrity->FindInt("blockSize");
+    const base::Value::List* blocks = integrity->FindList("blocks");
+    if (!algorithm || *algorithm != "SHA256" || !hash || !block_size ||
+        *block_size <= 0 || !blocks) {
+      return;
+    }
+
+    Integrity record;
+    record.hash.offset = AddString(*hash);
+    record.hash.length = static_cast<uint32_t>(hash->size());
+    record.block_size = static_cast<uint32_t>(*block_size);
+    record.first_block =
+        static_cast<uint32_t>(owned_integrity_blocks_.size());
+    for (const auto& value : *blocks) {
+      const std::string* block = value.GetIfString();
+      if (!block) {
+        owned_integrity_blocks_.resize(record.first_block);
+        return;
+      }
+      StringRef ref;
+      ref.offset = AddString(*block);
+      ref.length = static_cast<uint32_t>(block->size());
+      owned_integrity_blocks_.push_back(ref);
+    }
+    record.block_count =
+        static_cast<uint32_t>(owned_integrity_blocks_.size()) -
+        record.first_block;
+
+    node->integrity = static_cast<uint32_t>(owned_integrity_.size());
+    owned_integrity_.push_back(record);
+  }
+#endif
+}
+
+uint32_t ArchiveIndex::ResolveLink(uint32_t id, std::vector<uint8_t>* state) {
+  if ((*state)[id] == kResolved)
+    return nodes_[id].link_target;
+  // A link that is reached again while it is being resolved is part of a
+  // cycle, and is left dangling.
+  if ((*state)[id] == kResolving)
+    return kInvalidNode;
+
+  (*state)[id] = kResolving;
+  uint32_t target =
+      Walk(GetString(nodes_[id].link), [this, state](uint32_t link) {
+        return ResolveLink(link, state);
+      });
+  // |nodes_| is a view of |owned_nodes_| while the index is being built.
+  owned_nodes_[id].link_target = target;
+  (*state)[id] = kResolved;
+  return target;
+}
+
+template <typename LinkResolver>
+uint32_t ArchiveIndex::Walk(base::StringPiece path,
+                            LinkResolver&& link_target) const {
+  // Mirrors how paths have always been resolved against the JSON header: an
+  // empty component restarts from the root, and a link to a directory is
+  // followed exactly once when descending into it.
+  auto child_of = [&](uint32_t dir, base::StringPiece name) -> uint32_t {
+    if (name.empty())
+      return kRootNode;
+    if (nodes_[dir].type == NodeType::kLink) {
+      dir = link_target(dir);
+      if (dir == kInvalidNode)
+        return kInvalidNode;
+    }
+    if (nodes_[dir].type != NodeType::kDirectory)
+      return kInvalidNode;
+    return FindChild(dir, name);
+  };
+
+  if (path.empty())
+    return kRootNode;
+
+  uint32_t dir = kRootNode;
+  size_t pos;
+  while ((pos = path.find_first_of(kSeparators)) != base::StringPiece::npos) {
+    dir = child_of(dir, path.substr(0, pos));
+    if (dir == kInvalidNode)
+      return kInvalidNode;
+    path.remove_prefix(pos + 1);
+  }
+  return child_of(dir, path);
+}
+
+uint32_t ArchiveIndex::FindChild(uint32_t dir, base::StringPiece name) const {
+  const Node& parent = nodes_[dir];
+  auto begin = nodes_.begin() + parent.first_child;
+  auto end = begin + parent.child_count;
+  auto it = std::lower_bound(begin, end, name,
+                             [this](const Node& node, base::StringPiece name) {
+                               return Name(node) < name;
+                             });
+  if (it == end || Name(*it) != name)
+    return kInvalidNode;
+  return static_cast<uint32_t>(it - nodes_.begin());
+}
+
+const ArchiveIndex::Node* ArchiveIndex::Find(base::StringPiece path) const {
+  uint32_t id = LookupPath(path);
+  if (id != kInvalidNode)
+    return &nodes_[id];
+
+  // A verbatim miss is final unless the path has to be interpreted
+  // component by component.
+  if (!has_links_ && !NeedsWalk(path))
+    return nullptr;
+
+  id = Walk(path,
+            [this](uint32_t link) { return nodes_[link].link_target; });
+  return id == kInvalidNode ? nullptr : &nodes_[id];
+}
+
+const ArchiveIndex::Node* ArchiveIndex::ResolveLinks(const Node* node) const {
+  // A chain longer than the number of nodes must contain a cycle.
+  for (size_t hops = 0; node && hops <= nodes_.size(); ++hops) {
+    if (node->type != NodeType::kLink)
+      return node;
+    node = node->link_target == kInvalidNode ? nullptr
+                                             : &nodes_[node->link_target];
+  }
+  return nullptr;
+}
+
+const ArchiveIndex::Node* ArchiveIndex::GetDirectory(const Node& node) const {
+  const Node* dir = &node;
+  if (dir->type == NodeType::kLink) {
+    if (dir->link_target == kInvalidNode)
+      return nullptr;
+    dir = &nodes_[dir->link_target];
+  }
+  return dir->type == NodeType::kDirectory ? dir : nullptr;
+}
+
+base::span<const ArchiveIndex::Node> ArchiveIndex::Children(
+    const Node& dir) const {
+  DCHECK(dir.type == NodeType::kDirectory);
+  return nodes_.subspan(dir.first_child, dir.child_count);
+}
+
+base::StringPiece ArchiveIndex::GetString(StringRef ref) const {
+  return strings_.substr(ref.offset, ref.length);
+}
+
+base::StringPiece ArchiveIndex::Name(const Node& node) const {
+  return GetString(node.path).substr(node.name_offset);
+}
+
+const ArchiveIndex::Integrity* ArchiveIndex::GetIntegrity(
+    const Node& node) const {
+  if (node.integrity == kInvalidNode)
+    return nullptr;
+  return &integrity_[node.integrity];
+}
+
+size_t ArchiveIndex::GetSerializedSize() const {
+  size_t size = sizeof(BinaryIndexHeader) + nodes_.size_bytes() +
+                integrity_.size_bytes() + integrity_blocks_.size_bytes() +
+                strings_.size();
+  return base::bits::AlignUp(size, sizeof(uint32_t)) + sizeof(uint32_t) +
+         path_table_.size_bytes();
+}
+
+void ArchiveIndex::Serialize(base::span<uint8_t> out) const {
+  CHECK_EQ(out.size(), GetSerializedSize());
+  DCHECK_EQ(reinterpret_cast<uintptr_t>(out.data()) % sizeof(uint64_t), 0u);
+
+  BinaryIndexHeader header = {};
+  memcpy(header.magic, kBinaryIndexMagic, sizeof(header.magic));
+  header.version = kBinaryIndexVersion;
+  header.node_count = static_cast<uint32_t>(nodes_.size());
+  header.integrity_count = static_cast<uint32_t>(integrity_.size());
+  header.block_count = static_cast<uint32_t>(integrity_blocks_.size());
+  header.string_pool_size = static_cast<uint32_t>(strings_.size());
+  const uint32_t bucket_count = static_cast<uint32_t>(path_table_.size());
+
+  size_t position = 0;
+  auto write = [&out, &position](const void* data, size_t size) {
+    if (size)
+      memcpy(out.data() + position, data, size);
+    position += size;
+  };
+  write(&header, sizeof(header));
+  write(nodes_.data(), nodes_.size_bytes());
+  write(integrity_.data(), integrity_.size_bytes());
+  write(integrity_blocks_.data(), integrity_blocks_.size_bytes());
+  write(strings_.data(), strings_.size());
+  const size_t aligned = base::bits::AlignUp(position, sizeof(uint32_t));
+  std::fill(out.begin() + position, out.begin() + aligned, 0);
+  position = aligned;
+  write(&bucket_count, sizeof(bucket_count));
+  write(path_table_.data(), path_table_.size_bytes());
+  DCHECK_EQ(position, out.size());
+}
+
+base::StringPiece ArchiveIndex::GetIntegrityBlock(const Integrity& integrity,
+                                                  uint32_t block) const {
+  DCHECK_LT(block, integrity.block_count);
+  return GetString(integrity_blocks_[integrity.first_block + block]);
+}
+
+}  // namespace asar
@@ -0,0 +1,193 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_COMMON_ASAR_ARCHIVE_INDEX_H_
+#define ELECTRON_SHELL_COMMON_ASAR_ARCHIVE_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "base/memory/shared_memory_mapping.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace asar {
+
+// An immutable, flat lookup table compiled from the JSON header of an asar
+// archive. Every node is stored in a single array with its full relative path
+// interned in a shared string pool, so resolving a path is one hash probe that
+// does not allocate. The children of a directory are stored contiguously in
+// name order and symbolic links are resolved once at build time.
+//
+// Archives may also carry the same tables precompiled in a binary form after
+// the JSON header, see CreateFromBinary and docs/tutorial/asar-archives.md.
+// The in-memory records use that same layout, which lets the browser process
+// hand a compiled index to its children in shared memory for them to use in
+// place, see Serialize and CreateFromSharedMemory.
+class ArchiveIndex {
+ public:
+  static constexpr uint32_t kInvalidNode = UINT32_MAX;
+  static constexpr uint32_t kRootNode = 0;
+
+  enum class NodeType : uint8_t {
+    kFile,
+    kDirectory,
+    kLink,
+  };
+
+  // A substring of the string pool.
+  struct StringRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  struct Integrity {
+    StringRef hash;
+    uint32_t block_size = 0;
+    uint32_t first_block = 0;
+    uint32_t block_count = 0;
+  };
+
+  struct Node {
+    enum Flags : uint8_t {
+      // Set for files with a well-formed size (and offset, when packed).
+      kHasInfo = 1 << 0,
+      kUnpacked = 1 << 1,
+      kExecutable = 1 << 2,
+    };
+
+    bool has_info() const { return flags & kHasInfo; }
+    bool unpacked() const { return flags & kUnpacked; }
+    bool executable() const { return flags & kExecutable; }
+
+    // Relative to the end of the archive header, like the "offset" of the
+    // JSON header.
+    uint64_t offset = 0;
+    uint32_t size = 0;
+    // Full path relative to the archive root, "/" separated.
+    StringRef path;
+    // Offset of the last path component within |path|.
+    uint32_t name_offset = 0;
+    // Directories: contiguous range of child nodes, sorted by name.
+    uint32_t first_child = 0;
+    uint32_t child_count = 0;
+    // Links: the raw link value and the node it resolves to.
+    StringRef link;
+    uint32_t link_target = kInvalidNode;
+    // Index into the integrity table, or kInvalidNode.
+    uint32_t integrity = kInvalidNode;
+    NodeType type = NodeType::kFile;
+    uint8_t flags = 0;
+    uint8_t reserved[6] = {};
+  };
+
+  // Compiles |header|. Per-file integrity is only read when |load_integrity|
+  // is set.
+  static std::unique_ptr<ArchiveIndex> Create(const base::Value::Dict& header,
+                                              bool load_integrity);
+
+  // Loads a binary index. Every record is bounds-checked and the child
+  // ranges are checked to be sorted, so lookups against the result are as
+  // safe as against a compiled one. Returns nullptr if |data| is not a valid
+  // index of a supported version.
+  static std::unique_ptr<ArchiveIndex> CreateFromBinary(
+      base::span<const uint8_t> data);
+
+  // Uses an index written by Serialize at |offset| within |mapping| in place,
+  // without copying it. It is validated the same way as a binary index.
+  static std::unique_ptr<ArchiveIndex> CreateFromSharedMemory(
+      base::ReadOnlySharedMemoryMapping mapping,
+      size_t offset);
+
+  ~ArchiveIndex();
+
+  // disable copy
+  ArchiveIndex(const ArchiveIndex&) = delete;
+  ArchiveIndex& operator=(const ArchiveIndex&) = delete;
+
+  // Returns the node at |path|, or nullptr. Both "/" and, on Windows, "\"
+  // are accepted as separators.
+  const Node* Find(base::StringPiece path) const;
+
+  // Follows |node| through any chain of links, returning nullptr for dangling
+  // or cyclic links.
+  const Node* ResolveLinks(const Node* node) const;
+
+  // Returns the directory |node| refers to, following a link once the same
+  // way the JSON header has always been interpreted, or nullptr.
+  const Node* GetDirectory(const Node& node) const;
+
+  // Returns the children of directory |dir|, sorted by name.
+  base::span<const Node> Children(const Node& dir) const;
+
+  base::StringPiece GetString(StringRef ref) const;
+  base::StringPiece Name(const Node& node) const;
+  const Integrity* GetIntegrity(const Node& node) const;
+  base::StringPiece GetIntegrityBlock(const Integrity& integrity,
+                                      uint32_t block) const;
+
+  size_t node_count() const { return nodes_.size(); }
+
+  // Returns the number of bytes Serialize writes.
+  size_t GetSerializedSize() const;
+
+  // Writes the index in the binary format followed by its path table.
+  // |out| must be GetSerializedSize() bytes long and 8-byte aligned.
+  void Serialize(base::span<uint8_t> out) const;
+
+ private:
+  ArchiveIndex();
+
+  // Points the tables at the binary index at the start of |data|, which must
+  // be 8-byte aligned and outlive this index. On success |*end| is set to the
+  // position right after the string pool.
+  bool AttachTables(base::span<const uint8_t> data, size_t* end);
+  // Points the tables at the vectors filled in by Create.
+  void UseOwnedTables();
+
+  bool IsValidStringRef(StringRef ref) const;
+  bool Validate() const;
+  void BuildPathTable();
+  uint32_t LookupPath(base::StringPiece path) const;
+
+  uint32_t AddString(base::StringPiece str);
+  void AddChildren(uint32_t parent,
+                   const base::Value::Dict& dir,
+                   bool load_integrity);
+  void FillFile(Node* node, const base::Value::Dict& dict, bool load_integrity);
+  uint32_t ResolveLink(uint32_t id, std::vector<uint8_t>* state);
+
+  template <typename LinkResolver>
+  uint32_t Walk(base::StringPiece path, LinkResolver&& link_target) const;
+  uint32_t FindChild(uint32_t dir, base::StringPiece name) const;
+
+  // The tables lookups go through. They point into the owned vectors below,
+  // into |buffer_|, or into |mapping_|.
+  base::span<const Node> nodes_;
+  base::span<const Integrity> integrity_;
+  base::span<const StringRef> integrity_blocks_;
+  base::StringPiece strings_;
+  // Open-addressed hash table of node ids keyed by full path, with a
+  // power-of-two size and kInvalidNode for empty buckets.
+  base::span<const uint32_t> path_table_;
+
+  std::vector<Node> owned_nodes_;
+  std::vector<Integrity> owned_integrity_;
+  std::vector<StringRef> owned_integrity_blocks_;
+  std::string owned_strings_;
+  std::vector<uint32_t> owned_path_table_;
+  // An 8-byte aligned copy of a binary index.
+  std::vector<uint64_t> buffer_;
+  base::ReadOnlySharedMemoryMapping mapping_;
+
+  // Whether paths may have to be walked component by component on a miss.
+  bool has_links_ = false;
+};
+
+}  // namespace asar
+
+#endif  // ELECTRON_SHELL_COMMON_ASAR_ARCHIVE_INDEX_H_
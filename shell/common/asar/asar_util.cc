@@ -4,20 +4,34 @@
 
 #include "shell/common/asar/asar_util.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "base/containers/lru_cache.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/functional/bind.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/no_destructor.h"
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/synchronization/lock.h"
+#include "base/task/post_job.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
+#include "base/thread_annotations.h"
 #include "base/threading/thread_local.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/trace_event/trace_event.h"
 #include "crypto/secure_hash.h"
 #include "crypto/sha2.h"
 #include "shell/common/asar/archive.h"
@@ -27,51 +41,248 @@ namespace asar {
 
 namespace {
 
-typedef std::map<base::FilePath, std::shared_ptr<Archive>> ArchiveMap;
+typedef std::unordered_map<base::FilePath, std::shared_ptr<Archive>>
+    ArchiveMap;
 
 const base::FilePath::CharType kAsarExtension[] = FILE_PATH_LITERAL(".asar");
 
-bool IsDirectoryCached(const base::FilePath& path) {
-  static base::NoDestructor<std::map<base::FilePath, bool>>
+// The caches below are hit on every fs call and file:// request that could
+// involve an archive, from any thread. They are split into independently
+// locked shards so that lookups of different paths rarely contend.
+constexpr size_t kCacheShardCount = 16;
+
+// Bounds the number of paths each shard of the path split cache remembers.
+constexpr size_t kMaxPathSplitsPerShard = 512;
+
+template <typename Map>
+class ShardedCache {
+ public:
+  struct Shard {
+    base::Lock lock;
+    Map map GUARDED_BY(lock);
+  };
+
+  Shard& GetShard(const base::FilePath& path) {
+    return shards_[std::hash<base::FilePath>()(path) % shards_.size()];
+  }
+
+  std::array<Shard, kCacheShardCount>& shards() { return shards_; }
+
+ private:
+  std::array<Shard, kCacheShardCount> shards_;
+};
+
+// Where a full path splits into an archive and a path inside it. An empty
+// |asar_path| records that the path is not inside any archive.
+struct ArchivePathSplit {
+  base::FilePath asar_path;
+  base::FilePath relative_path;
+};
+
+using PathSplitLRUCache =
+    base::HashingLRUCache<base::FilePath, ArchivePathSplit>;
+
+struct PathSplitMap : public PathSplitLRUCache {
+  PathSplitMap() : PathSplitLRUCache(kMaxPathSplitsPerShard) {}
+};
+
+ShardedCache<std::unordered_map<base::FilePath, bool>>& GetIsDirectoryCache() {
+  static base::NoDestructor<
+      ShardedCache<std::unordered_map<base::FilePath, bool>>>
       s_is_directory_cache;
-  static base::NoDestructor<base::Lock> lock;
+  return *s_is_directory_cache;
+}
+
+ShardedCache<PathSplitMap>& GetPathSplitCache() {
+  static base::NoDestructor<ShardedCache<PathSplitMap>> s_path_split_cache;
+  return *s_path_split_cache;
+}
 
-  base::AutoLock auto_lock(*lock);
-  auto& is_directory_cache = *s_is_directory_cache;
+ShardedCache<ArchiveMap>& GetArchiveCache() {
+  static base::NoDestructor<ShardedCache<ArchiveMap>> s_archive_cache;
+  return *s_archive_cache;
+}
 
-  auto it = is_directory_cache.find(path);
-  if (it != is_directory_cache.end()) {
-    return it->second;
+bool IsDirectoryCached(const base::FilePath& path) {
+  auto& shard = GetIsDirectoryCache().GetShard(path);
+  {
+    base::AutoLock auto_lock(shard.lock);
+    auto it = shard.map.find(path);
+    if (it != shard.map.end())
+      return it->second;
+  }
+
+  // Stat outside of the lock; racing threads store the same answer.
+  bool is_directory;
+  {
+    electron::ScopedAllowBlockingForElectron allow_blocking;
+    is_directory = base::DirectoryExists(path);
   }
-  electron::ScopedAllowBlockingForElectron allow_blocking;
-  return is_directory_cache[path] = base::DirectoryExists(path);
+  base::AutoLock auto_lock(shard.lock);
+  shard.map.emplace(path, is_directory);
+  return is_directory;
 }
 
-}  // namespace
+// Walks up from |full_path| to the first component that is an archive.
+ArchivePathSplit SplitArchivePath(const base::FilePath& full_path) {
+  ArchivePathSplit split;
+  base::FilePath iter = full_path;
+  while (true) {
+    base::FilePath dirname = iter.DirName();
+    if (iter.MatchesExtension(kAsarExtension) && !IsDirectoryCached(iter))
+      break;
+    else if (iter == dirname)
+      return split;
+    iter = dirname;
+  }
 
-ArchiveMap& GetArchiveCache() {
-  static base::NoDestructor<ArchiveMap> s_archive_map;
-  return *s_archive_map;
+  // A path that cannot be made relative to the archive, e.g. the archive
+  // itself, keeps an empty relative path.
+  iter.AppendRelativePath(full_path, &split.relative_path);
+  split.asar_path = iter;
+  return split;
 }
 
-base::Lock& GetArchiveCacheLock() {
+typedef std::map<base::FilePath, base::ReadOnlySharedMemoryRegion>
+    SharedIndexMap;
+
+SharedIndexMap& GetSharedIndexes() {
+  static base::NoDestructor<SharedIndexMap> s_shared_indexes;
+  return *s_shared_indexes;
+}
+
+base::Lock& GetSharedIndexesLock() {
   static base::NoDestructor<base::Lock> lock;
   return *lock;
 }
 
+// Files with fewer blocks than this are hashed on the calling thread, where
+// posting a job costs more than it saves.
+constexpr size_t kMinBlocksForParallelValidation = 2;
+
+// The use of the ForTesting flavor is a hack workaround to avoid having to
+// patch this as a friend into the guard class.
+class [[maybe_unused, nodiscard]] ScopedAllowJoinForIntegrityValidation
+    : public base::ScopedAllowBaseSyncPrimitivesForTesting {};
+
+// Returns true if |integrity| has one block hash per |block_size| bytes of a
+// |size| byte file, in which case validating every block is equivalent to
+// validating the whole file.
+bool HasBlockHashes(const IntegrityPayload& integrity, uint64_t size) {
+  if (integrity.algorithm != HashAlgorithm::kSHA256 ||
+      integrity.block_size == 0 || size == 0) {
+    return false;
+  }
+  return integrity.blocks.size() ==
+         (size + integrity.block_size - 1) / integrity.block_size;
+}
+
+// Hashes the blocks [first_block, end_block) of a packed file, crashing on the
+// first one that does not pass. |contents| holds the bytes of those blocks,
+// which are the bytes the caller goes on to use, so nothing can change them
+// between being validated and being used.
+class BlockValidationJob
+    : public base::RefCountedThreadSafe<BlockValidationJob> {
+ public:
+  BlockValidationJob(const IntegrityPayload& integrity,
+                     uint64_t size,
+                     base::span<const uint8_t> contents,
+                     uint32_t first_block,
+                     uint32_t end_block)
+      : size_(size),
+        integrity_(integrity),
+        contents_(contents),
+        first_block_(first_block),
+        end_block_(end_block) {
+    DCHECK_LE(end_block, integrity_.blocks.size());
+  }
+
+  // disable copy
+  BlockValidationJob(const BlockValidationJob&) = delete;
+  BlockValidationJob& operator=(const BlockValidationJob&) = delete;
+
+  // Validates the blocks on the calling thread, with the help of the thread
+  // pool when there are enough of them.
+  void RunAndWait() {
+    if (end_block_ - first_block_ < kMinBlocksForParallelValidation ||
+        !base::ThreadPoolInstance::Get()) {
+      for (uint32_t block = first_block_; block < end_block_; ++block)
+        ValidateBlock(block);
+      return;
+    }
+
+    base::JobHandle handle = base::PostJob(
+        FROM_HERE, {base::TaskPriority::USER_BLOCKING},
+        base::BindRepeating(&BlockValidationJob::Work,
+                            base::WrapRefCounted(this)),
+        base::BindRepeating(&BlockValidationJob::GetMaxConcurrency,
+                            base::WrapRefCounted(this)));
+    ScopedAllowJoinForIntegrityValidation allow_join;
+    handle.Join();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<BlockValidationJob>;
+  ~BlockValidationJob() = default;
+
+  void Work(base::JobDelegate* delegate) {
+    while (!delegate->ShouldYield()) {
+      uint32_t block = next_.fetch_add(1, std::memory_order_relaxed);
+      if (block >= end_block_)
+        return;
+      ValidateBlock(block);
+    }
+  }
+
+  size_t GetMaxConcurrency(size_t worker_count) const {
+    uint32_t next = next_.load(std::memory_order_relaxed);
+    return next >= end_block_ ? 0 : end_block_ - next;
+  }
+
+  void ValidateBlock(uint32_t block) {
+    const uint64_t start =
+        static_cast<uint64_t>(block) * integrity_.block_size;
+    const size_t length =
+        std::min<uint64_t>(integrity_.block_size, size_ - start);
+    base::span<const uint8_t> data = contents_.subspan(
+        start - static_cast<uint64_t>(first_block_) * integrity_.block_size,
+        length);
+
+    std::array<uint8_t, crypto::kSHA256Length> hash = crypto::SHA256Hash(data);
+    const std::string hex_hash =
+        base::ToLowerASCII(base::HexEncode(hash.data(), hash.size()));
+    if (integrity_.blocks[block] != hex_hash) {
+      LOG(FATAL) << "Integrity check failed for block " << block
+                 << " of asar archive file (" << integrity_.blocks[block]
+                 << " vs " << hex_hash << ")";
+    }
+  }
+
+  const uint64_t size_;
+  const IntegrityPayload integrity_;
+  const base::span<const uint8_t> contents_;
+  const uint32_t first_block_;
+  const uint32_t end_block_;
+  std::atomic<uint32_t> next_{first_block_};
+};
+
+}  // namespace
+
 std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
-  base::AutoLock auto_lock(GetArchiveCacheLock());
-  ArchiveMap& map = GetArchiveCache();
+  // The shard stays locked while the archive is created, so that each archive
+  // is only opened once.
+  auto& shard = GetArchiveCache().GetShard(path);
+  base::AutoLock auto_lock(shard.lock);
 
   // if we have it, return it
-  const auto lower = map.lower_bound(path);
-  if (lower != std::end(map) && !map.key_comp()(path, lower->first))
-    return lower->second;
+  auto it = shard.map.find(path);
+  if (it != shard.map.end())
+    return it->second;
 
   // if we can create it, return it
   auto archive = std::make_shared<Archive>(path);
   if (archive->Init()) {
-    map.try_emplace(lower, path, archive);
+    shard.map.emplace(path, archive);
     return archive;
   }
 
@@ -80,33 +291,79 @@ std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
 }
 
 void ClearArchives() {
-  base::AutoLock auto_lock(GetArchiveCacheLock());
-  ArchiveMap& map = GetArchiveCache();
+  for (auto& shard : GetArchiveCache().shards()) {
+    base::AutoLock auto_lock(shard.lock);
+    shard.map.clear();
+  }
+}
+
+std::vector<electron::mojom::SharedAsarIndexPtr> GetSharedArchiveIndexes() {
+  std::vector<std::shared_ptr<Archive>> archives;
+  for (auto& shard : GetArchiveCache().shards()) {
+    base::AutoLock auto_lock(shard.lock);
+    for (const auto& [path, archive] : shard.map)
+      archives.push_back(archive);
+  }
+
+  std::vector<electron::mojom::SharedAsarIndexPtr> indexes;
+  for (const auto& archive : archives) {
+    base::ReadOnlySharedMemoryRegion region = archive->ShareIndex();
+    if (region.IsValid()) {
+      indexes.push_back(electron::mojom::SharedAsarIndex::New(
+          archive->path(), std::move(region)));
+    }
+  }
+  return indexes;
+}
+
+void SetSharedArchiveIndexes(
+    std::vector<electron::mojom::SharedAsarIndexPtr> indexes) {
+  base::AutoLock auto_lock(GetSharedIndexesLock());
+  SharedIndexMap& map = GetSharedIndexes();
+  for (auto& index : indexes) {
+    if (index && index->region.IsValid())
+      map[index->archive_path] = std::move(index->region);
+  }
+}
 
-  map.clear();
+base::ReadOnlySharedMemoryRegion GetSharedArchiveIndex(
+    const base::FilePath& path) {
+  base::AutoLock auto_lock(GetSharedIndexesLock());
+  SharedIndexMap& map = GetSharedIndexes();
+  auto it = map.find(path);
+  if (it == map.end())
+    return {};
+  return it->second.Duplicate();
 }
 
 bool GetAsarArchivePath(const base::FilePath& full_path,
                         base::FilePath* asar_path,
                         base::FilePath* relative_path,
                         bool allow_root) {
-  base::FilePath iter = full_path;
-  while (true) {
-    base::FilePath dirname = iter.DirName();
-    if (iter.MatchesExtension(kAsarExtension) && !IsDirectoryCached(iter))
-      break;
-    else if (iter == dirname)
-      return false;
-    iter = dirname;
+  ArchivePathSplit split;
+  auto& shard = GetPathSplitCache().GetShard(full_path);
+  bool cached;
+  {
+    base::AutoLock auto_lock(shard.lock);
+    auto it = shard.map.Get(full_path);
+    cached = it != shard.map.end();
+    if (cached)
+      split = it->second;
+  }
+  if (!cached) {
+    split = SplitArchivePath(full_path);
+    base::AutoLock auto_lock(shard.lock);
+    shard.map.Put(full_path, split);
   }
 
-  base::FilePath tail;
-  if (!((allow_root && iter == full_path) ||
-        iter.AppendRelativePath(full_path, &tail)))
+  if (split.asar_path.empty())
+    return false;
+  if (split.relative_path.empty() &&
+      !(allow_root && split.asar_path == full_path))
     return false;
 
-  *asar_path = iter;
-  *relative_path = tail;
+  *asar_path = split.asar_path;
+  *relative_path = split.relative_path;
   return true;
 }
 
@@ -130,6 +387,18 @@ bool ReadFileToString(const base::FilePath& path, std::string* contents) {
     return base::ReadFileToString(real_path, contents);
   }
 
+  if (absl::optional<base::span<const uint8_t>> mapped =
+          archive->GetMappedContents(info)) {
+    // The copy is validated rather than the mapping, which another process
+    // can write to after it was hashed.
+    contents->assign(mapped->begin(), mapped->end());
+    if (info.integrity.has_value()) {
+      ValidateFileIntegrityOrDie(info,
+                                 base::as_bytes(base::make_span(*contents)));
+    }
+    return true;
+  }
+
   base::File src(asar_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
   if (!src.IsValid())
     return false;
@@ -142,8 +411,8 @@ bool ReadFileToString(const base::FilePath& path, std::string* contents) {
   }
 
   if (info.integrity.has_value()) {
-    ValidateIntegrityOrDie(contents->data(), contents->size(),
-                           info.integrity.value());
+    ValidateFileIntegrityOrDie(info,
+                               base::as_bytes(base::make_span(*contents)));
   }
 
   return true;
@@ -169,4 +438,49 @@ void ValidateIntegrityOrDie(const char* data,
   }
 }
 
+void ValidateFileIntegrityOrDie(const Archive::FileInfo& info,
+                                base::span<const uint8_t> contents) {
+  ValidateFileRangeOrDie(info, 0, contents);
+}
+
+std::pair<uint64_t, uint64_t> GetFileValidationRange(
+    const Archive::FileInfo& info,
+    uint64_t start,
+    uint64_t end) {
+  const IntegrityPayload& integrity = info.integrity.value();
+  if (!HasBlockHashes(integrity, info.size))
+    return {0, info.size};
+  const uint64_t block_size = integrity.block_size;
+  return {start / block_size * block_size,
+          std::min<uint64_t>((end + block_size - 1) / block_size * block_size,
+                             info.size)};
+}
+
+void ValidateFileRangeOrDie(const Archive::FileInfo& info,
+                            uint64_t start,
+                            base::span<const uint8_t> contents) {
+  const IntegrityPayload& integrity = info.integrity.value();
+  if (!HasBlockHashes(integrity, info.size)) {
+    // Without block hashes only the whole file can be checked.
+    CHECK(start == 0 && contents.size() == info.size)
+        << "Only whole asar archive files can be validated";
+    ValidateIntegrityOrDie(reinterpret_cast<const char*>(contents.data()),
+                           contents.size(), integrity);
+    return;
+  }
+
+  const uint64_t block_size = integrity.block_size;
+  const uint64_t end = start + contents.size();
+  CHECK(start % block_size == 0 && end <= info.size &&
+        (end == info.size || end % block_size == 0))
+      << "Asar archive files can only be validated in whole blocks";
+  TRACE_EVENT2("electron", "ValidateFileRangeOrDie", "start", start, "size",
+               contents.size());
+  const uint32_t first_block = start / block_size;
+  const uint32_t end_block = (end + block_size - 1) / block_size;
+  auto job = base::MakeRefCounted<BlockValidationJob>(
+      integrity, info.size, contents, first_block, end_block);
+  job->RunAndWait();
+}
+
 }  // namespace asar
@@ -7,22 +7,36 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
-namespace base {
-class FilePath;
-}
+#include "base/containers/span.h"
+#include "base/memory/read_only_shared_memory_region.h"
+#include "shell/common/api/api.mojom.h"
+#include "shell/common/asar/archive.h"
 
 namespace asar {
 
-class Archive;
-struct IntegrityPayload;
-
 // Gets or creates and caches a new Archive from the path.
 std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path);
 
 // Destroy cached Archive objects.
 void ClearArchives();
 
+// Returns the header indexes of every cached Archive, for handing to a child
+// process when it is launched.
+std::vector<electron::mojom::SharedAsarIndexPtr> GetSharedArchiveIndexes();
+
+// Lets archives opened later in this process attach to |indexes| instead of
+// parsing their headers.
+void SetSharedArchiveIndexes(
+    std::vector<electron::mojom::SharedAsarIndexPtr> indexes);
+
+// Returns a handle to the index shared for the archive at |path|, or an
+// invalid region.
+base::ReadOnlySharedMemoryRegion GetSharedArchiveIndex(
+    const base::FilePath& path);
+
 // Separates the path to Archive out.
 bool GetAsarArchivePath(const base::FilePath& full_path,
                         base::FilePath* asar_path,
@@ -36,6 +50,30 @@ void ValidateIntegrityOrDie(const char* data,
                             size_t size,
                             const IntegrityPayload& integrity);
 
+// Validates |contents|, the whole of the packed file |info|, against its
+// per-block hashes, which are hashed in parallel on the thread pool. Falls
+// back to ValidateIntegrityOrDie when the payload has no usable block hashes.
+// Callers must use |contents| itself afterwards, not read the file again, so
+// that the bytes they use are the bytes that were validated.
+void ValidateFileIntegrityOrDie(const Archive::FileInfo& info,
+                                base::span<const uint8_t> contents);
+
+// Returns the range of the file |info| that has to be read to validate
+// bytes [start, end) of it: the blocks that overlap them, or the whole file
+// when the payload has no usable block hashes.
+std::pair<uint64_t, uint64_t> GetFileValidationRange(
+    const Archive::FileInfo& info,
+    uint64_t start,
+    uint64_t end);
+
+// Validates |contents|, the bytes of the file |info| from |start| on,
+// where |start| and the size of |contents| are a range returned by
+// GetFileValidationRange. As with ValidateFileIntegrityOrDie, |contents| must
+// be what is used afterwards.
+void ValidateFileRangeOrDie(const Archive::FileInfo& info,
+                            uint64_t start,
+                            base::span<const uint8_t> contents);
+
 }  // namespace asar
 
 #endif  // ELECTRON_SHELL_COMMON_ASAR_ASAR_UTIL_H_
@@ -76,15 +76,16 @@
   V(electron_browser_web_view_manager)   \
   V(electron_browser_window)
 
-#define ELECTRON_COMMON_BINDINGS(V)   \
-  V(electron_common_asar)             \
-  V(electron_common_clipboard)        \
-  V(electron_common_command_line)     \
-  V(electron_common_crashpad_support) \
-  V(electron_common_environment)      \
-  V(electron_common_features)         \
-  V(electron_common_native_image)     \
-  V(electron_common_shell)            \
+#define ELECTRON_COMMON_BINDINGS(V)     \
+  V(electron_common_asar)               \
+  V(electron_common_clipboard)          \
+  V(electron_common_command_line)       \
+  V(electron_common_crashpad_support)   \
+  V(electron_common_environment)        \
+  V(electron_common_features)           \
+  V(electron_common_native_image)       \
+  V(electron_common_shared_ring_buffer) \
+  V(electron_common_shell)              \
   V(electron_common_v8_util)
 
 #define ELECTRON_RENDERER_BINDINGS(V) \
@@ -269,6 +269,13 @@ const char kDisableNTLMv2[] = "disable-ntlm-v2";
 
 const char kEnableWebSQL[] = "enable-websql";
 
+// Memory-map asar archives and serve reads of packed files from the mapping.
+const char kAsarMmap[] = "asar-mmap";
+
+// Capacity in bytes of the data pipes file:// responses from asar archives are
+// streamed through.
+const char kAsarPipeSize[] = "asar-pipe-size";
+
 }  // namespace switches
 
 }  // namespace electron
@@ -131,6 +131,9 @@ extern const char kEnableAuthNegotiatePort[];
 extern const char kDisableNTLMv2[];
 
 extern const char kEnableWebSQL[];
+
+extern const char kAsarMmap[];
+extern const char kAsarPipeSize[];
 }  // namespace switches
 
 }  // namespace electron
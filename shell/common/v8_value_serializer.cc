@@ -4,16 +4,28 @@
 
 #include "shell/common/v8_value_serializer.h"
 
+#include <cstring>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "base/memory/raw_ptr.h"
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/memory/unsafe_shared_memory_region.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/ranges/algorithm.h"
+#include "base/strings/string_number_conversions.h"
 #include "gin/converter.h"
+#include "mojo/public/cpp/base/big_buffer.h"
 #include "shell/common/api/electron_api_native_image.h"
+#include "shell/common/api/electron_api_shared_ring_buffer.h"
 #include "shell/common/gin_helper/microtasks_scope.h"
 #include "skia/public/mojom/bitmap.mojom.h"
 #include "third_party/blink/public/common/messaging/cloneable_message.h"
 #include "third_party/blink/public/common/messaging/web_message_port.h"
+#include "third_party/blink/public/mojom/messaging/transferable_message.mojom.h"
 #include "ui/gfx/image/image_skia.h"
 #include "v8/include/v8.h"
 
@@ -22,9 +34,25 @@ namespace electron {
 namespace {
 enum SerializationTag {
   kNativeImageTag = 'i',
+  kSharedNativeImageTag = 'I',
+  kSharedRingBufferTag = 'R',
   kTrailerOffsetTag = 0xFE,
   kVersionTag = 0xFF
 };
+
+// Whether the pixels of |bitmap| can be passed in a shared memory region and
+// installed into an N32 bitmap by the receiver.
+bool CanShareBitmap(const SkBitmap& bitmap) {
+  return bitmap.colorType() == kN32_SkColorType &&
+         bitmap.alphaType() != kUnpremul_SkAlphaType &&
+         !bitmap.drawsNothing() && bitmap.readyToDraw();
+}
+
+// Keeps the shared memory that backs a received bitmap mapped.
+struct SharedBitmapPinner {
+  base::ReadOnlySharedMemoryMapping mapping;
+};
+
 }  // namespace
 
 class V8Serializer : public v8::ValueSerializer::Delegate {
@@ -33,6 +61,18 @@ class V8Serializer : public v8::ValueSerializer::Delegate {
       : isolate_(isolate), serializer_(isolate, this) {}
   ~V8Serializer() override = default;
 
+  void TransferArrayBuffer(uint32_t id, v8::Local<v8::ArrayBuffer> buffer) {
+    serializer_.TransferArrayBuffer(id, buffer);
+  }
+
+  // Lets NativeImages pass their pixels alongside the encoded message, in
+  // |out|'s electron_read_only_shared_memory_regions, rather than inside of
+  // it, and allows SharedRingBuffers, whose memory is passed in its
+  // electron_shared_memory_regions.
+  void SetTransferableMessage(blink::TransferableMessage* out) {
+    transferable_message_ = out;
+  }
+
   bool Serialize(v8::Local<v8::Value> value, blink::CloneableMessage* out) {
     gin_helper::MicrotasksScope microtasks_scope(
         isolate_, isolate_->GetCurrentContext()->GetMicrotaskQueue(),
@@ -78,10 +118,18 @@ class V8Serializer : public v8::ValueSerializer::Delegate {
                                   v8::Local<v8::Object> object) override {
     api::NativeImage* native_image;
     if (gin::ConvertFromV8(isolate, object, &native_image)) {
-      // Serialize the NativeImage
-      WriteTag(kNativeImageTag);
       gfx::ImageSkia image = native_image->image().AsImageSkia();
       std::vector<gfx::ImageSkiaRep> image_reps = image.image_reps();
+      if (transferable_message_ &&
+          base::ranges::all_of(image_reps,
+                               [](const auto& rep) {
+                                 return CanShareBitmap(rep.GetBitmap());
+                               }) &&
+          WriteSharedNativeImage(image_reps)) {
+        return v8::Just(true);
+      }
+      // Serialize the NativeImage
+      WriteTag(kNativeImageTag);
       serializer_.WriteUint32(image_reps.size());
       for (const auto& rep : image_reps) {
         serializer_.WriteDouble(rep.scale());
@@ -92,9 +140,22 @@ class V8Serializer : public v8::ValueSerializer::Delegate {
         serializer_.WriteRawBytes(bytes.data(), bytes.size());
       }
       return v8::Just(true);
-    } else {
-      return v8::ValueSerializer::Delegate::WriteHostObject(isolate, object);
     }
+    // SharedRingBuffers can only be sent with postMessage, and fail to clone
+    // otherwise.
+    api::SharedRingBuffer* ring_buffer;
+    if (transferable_message_ &&
+        gin::ConvertFromV8(isolate, object, &ring_buffer)) {
+      base::UnsafeSharedMemoryRegion region = ring_buffer->DuplicateRegion();
+      if (!region.IsValid())
+        return v8::ValueSerializer::Delegate::WriteHostObject(isolate, object);
+      auto& regions = transferable_message_->electron_shared_memory_regions;
+      WriteTag(kSharedRingBufferTag);
+      serializer_.WriteUint32(regions.size());
+      regions.push_back(std::move(region));
+      return v8::Just(true);
+    }
+    return v8::ValueSerializer::Delegate::WriteHostObject(isolate, object);
   }
 
   void ThrowDataCloneError(v8::Local<v8::String> message) override {
@@ -104,6 +165,42 @@ class V8Serializer : public v8::ValueSerializer::Delegate {
  private:
   void WriteTag(SerializationTag tag) { serializer_.WriteRawBytes(&tag, 1); }
 
+  // Copies the pixels of every representation into a read-only shared memory
+  // region of the message, with tightly packed rows, and writes its scale,
+  // size, alpha type and the index of its region. The receiver installs the
+  // mapped region as the pixels of its bitmap, so they are copied only once.
+  // Returns false without writing anything when a region can not be created.
+  bool WriteSharedNativeImage(const std::vector<gfx::ImageSkiaRep>& reps) {
+    std::vector<base::ReadOnlySharedMemoryRegion> rep_regions;
+    rep_regions.reserve(reps.size());
+    for (const auto& rep : reps) {
+      const SkBitmap& bitmap = rep.GetBitmap();
+      const SkImageInfo& info = bitmap.info();
+      base::MappedReadOnlyRegion mapped =
+          base::ReadOnlySharedMemoryRegion::Create(info.computeMinByteSize());
+      if (!mapped.IsValid() ||
+          !bitmap.readPixels(info, mapped.mapping.memory(), info.minRowBytes(),
+                             0, 0))
+        return false;
+      rep_regions.push_back(std::move(mapped.region));
+    }
+
+    auto& regions =
+        transferable_message_->electron_read_only_shared_memory_regions;
+    WriteTag(kSharedNativeImageTag);
+    serializer_.WriteUint32(reps.size());
+    for (size_t i = 0; i < reps.size(); ++i) {
+      const SkBitmap& bitmap = reps[i].GetBitmap();
+      serializer_.WriteDouble(reps[i].scale());
+      serializer_.WriteUint32(bitmap.width());
+      serializer_.WriteUint32(bitmap.height());
+      serializer_.WriteUint32(bitmap.alphaType());
+      serializer_.WriteUint32(regions.size());
+      regions.push_back(std::move(rep_regions[i]));
+    }
+    return true;
+  }
+
   void WriteBlinkEnvelope(uint32_t blink_version) {
     // Write a dummy blink version envelope for compatibility with
     // blink::V8ScriptValueSerializer
@@ -114,6 +211,8 @@ class V8Serializer : public v8::ValueSerializer::Delegate {
   raw_ptr<v8::Isolate> isolate_;
   std::vector<uint8_t> data_;
   v8::ValueSerializer serializer_;
+
+  raw_ptr<blink::TransferableMessage> transferable_message_ = nullptr;
 };
 
 class V8Deserializer : public v8::ValueDeserializer::Delegate {
@@ -123,6 +222,14 @@ class V8Deserializer : public v8::ValueDeserializer::Delegate {
         deserializer_(isolate, data.data(), data.size(), this) {}
   V8Deserializer(v8::Isolate* isolate, const blink::CloneableMessage& message)
       : V8Deserializer(isolate, message.encoded_message) {}
+  V8Deserializer(v8::Isolate* isolate, blink::TransferableMessage& message)
+      : V8Deserializer(isolate, message.encoded_message) {
+    transferable_message_ = &message;
+  }
+
+  void TransferArrayBuffer(uint32_t id, v8::Local<v8::ArrayBuffer> buffer) {
+    deserializer_.TransferArrayBuffer(id, buffer);
+  }
 
   v8::Local<v8::Value> Deserialize() {
     v8::EscapableHandleScope scope(isolate_);
@@ -151,6 +258,17 @@ class V8Deserializer : public v8::ValueDeserializer::Delegate {
         if (api::NativeImage* native_image = ReadNativeImage(isolate))
           return native_image->GetWrapper(isolate);
         break;
+      case kSharedNativeImageTag:
+        if (api::NativeImage* native_image = ReadSharedNativeImage(isolate))
+          return native_image->GetWrapper(isolate);
+        break;
+      case kSharedRingBufferTag: {
+        gin::Handle<api::SharedRingBuffer> ring_buffer =
+            ReadSharedRingBuffer(isolate);
+        if (!ring_buffer.IsEmpty())
+          return ring_buffer->GetWrapper(isolate);
+        break;
+      }
     }
     // Throws an exception.
     return v8::ValueDeserializer::Delegate::ReadHostObject(isolate);
@@ -218,8 +336,84 @@ class V8Deserializer : public v8::ValueDeserializer::Delegate {
     return new api::NativeImage(isolate, image);
   }
 
+  // Reads a NativeImage whose pixels were passed alongside the message.
+  api::NativeImage* ReadSharedNativeImage(v8::Isolate* isolate) {
+    if (!transferable_message_)
+      return nullptr;
+    const auto& regions =
+        transferable_message_->electron_read_only_shared_memory_regions;
+    gfx::ImageSkia image_skia;
+    uint32_t num_reps = 0;
+    if (!deserializer_.ReadUint32(&num_reps))
+      return nullptr;
+    for (uint32_t i = 0; i < num_reps; i++) {
+      double scale = 0.0;
+      uint32_t width = 0;
+      uint32_t height = 0;
+      uint32_t alpha_type = 0;
+      uint32_t index = 0;
+      if (!deserializer_.ReadDouble(&scale) ||
+          !deserializer_.ReadUint32(&width) ||
+          !deserializer_.ReadUint32(&height) ||
+          !deserializer_.ReadUint32(&alpha_type) ||
+          !deserializer_.ReadUint32(&index))
+        return nullptr;
+      if (alpha_type != kOpaque_SkAlphaType &&
+          alpha_type != kPremul_SkAlphaType)
+        return nullptr;
+      if (index >= regions.size() || !regions[index].IsValid())
+        return nullptr;
+      if (!base::IsValueInRangeForNumericType<int>(width) ||
+          !base::IsValueInRangeForNumericType<int>(height))
+        return nullptr;
+      const SkImageInfo info =
+          SkImageInfo::MakeN32(static_cast<int>(width), static_cast<int>(height),
+                               static_cast<SkAlphaType>(alpha_type));
+      if (info.isEmpty() || !info.validRowBytes(info.minRowBytes()))
+        return nullptr;
+      base::ReadOnlySharedMemoryMapping mapping = regions[index].Map();
+      const size_t byte_size = info.computeMinByteSize();
+      if (!mapping.IsValid() || SkImageInfo::ByteSizeOverflowed(byte_size) ||
+          mapping.size() < byte_size)
+        return nullptr;
+
+      // The bitmap is marked as immutable, but installPixels() requires a
+      // non-const pointer. The release proc unmaps the memory once the last
+      // user of the pixels is gone.
+      void* const pixels = const_cast<void*>(mapping.memory());
+      SkBitmap bitmap;
+      if (!bitmap.installPixels(
+              info, pixels, info.minRowBytes(),
+              [](void* addr, void* context) {
+                delete static_cast<SharedBitmapPinner*>(context);
+              },
+              new SharedBitmapPinner{std::move(mapping)}))
+        return nullptr;
+      bitmap.setImmutable();
+      image_skia.AddRepresentation(gfx::ImageSkiaRep(bitmap, scale));
+    }
+    gfx::Image image(image_skia);
+    return new api::NativeImage(isolate, image);
+  }
+
+  // Maps the SharedRingBuffer whose memory was passed alongside the message.
+  gin::Handle<api::SharedRingBuffer> ReadSharedRingBuffer(
+      v8::Isolate* isolate) {
+    uint32_t index = 0;
+    if (!transferable_message_ || !deserializer_.ReadUint32(&index))
+      return gin::Handle<api::SharedRingBuffer>();
+    auto& regions = transferable_message_->electron_shared_memory_regions;
+    // The region is taken out of the message, so every entry can only be read
+    // once; FromRegion() fails for one that was taken already.
+    if (index >= regions.size())
+      return gin::Handle<api::SharedRingBuffer>();
+    return api::SharedRingBuffer::FromRegion(isolate,
+                                             std::move(regions[index]));
+  }
+
   raw_ptr<v8::Isolate> isolate_;
   v8::ValueDeserializer deserializer_;
+  raw_ptr<blink::TransferableMessage> transferable_message_ = nullptr;
 };
 
 bool SerializeV8Value(v8::Isolate* isolate,
@@ -228,11 +422,79 @@ bool SerializeV8Value(v8::Isolate* isolate,
   return V8Serializer(isolate).Serialize(value, out);
 }
 
+bool SerializeV8Value(
+    v8::Isolate* isolate,
+    v8::Local<v8::Value> value,
+    const std::vector<v8::Local<v8::ArrayBuffer>>& array_buffers,
+    blink::TransferableMessage* out) {
+  V8Serializer serializer(isolate);
+  for (size_t i = 0; i < array_buffers.size(); ++i) {
+    v8::Local<v8::ArrayBuffer> buffer = array_buffers[i];
+    const std::string index = base::NumberToString(i);
+    if (!buffer->IsDetachable() || buffer->WasDetached()) {
+      isolate->ThrowException(v8::Exception::TypeError(
+          gin::StringToV8(isolate, "ArrayBuffer at index " + index +
+                                       " can not be transferred")));
+      return false;
+    }
+    for (size_t j = 0; j < i; ++j) {
+      if (array_buffers[j] == buffer) {
+        isolate->ThrowException(v8::Exception::TypeError(gin::StringToV8(
+            isolate, "ArrayBuffer at index " + index + " is a duplicate")));
+        return false;
+      }
+    }
+    serializer.TransferArrayBuffer(i, buffer);
+  }
+  serializer.SetTransferableMessage(out);
+  if (!serializer.Serialize(value, out))
+    return false;
+
+  // Contents past mojo_base::BigBuffer's inline limit end up in a shared
+  // memory region that is handed to the receiver, rather than being copied
+  // through the message pipe as part of the encoded message.
+  for (v8::Local<v8::ArrayBuffer> buffer : array_buffers) {
+    auto contents = blink::mojom::SerializedArrayBufferContents::New();
+    contents->contents = mojo_base::BigBuffer(base::make_span(
+        static_cast<const uint8_t*>(buffer->Data()), buffer->ByteLength()));
+    out->array_buffer_contents_array.push_back(std::move(contents));
+  }
+  return true;
+}
+
+void DetachArrayBuffers(
+    v8::Isolate* isolate,
+    const std::vector<v8::Local<v8::ArrayBuffer>>& array_buffers) {
+  // The message is gone by now, so a buffer that refuses to be detached
+  // because of its detach key is left as it is, rather than failing the call.
+  v8::TryCatch try_catch(isolate);
+  for (v8::Local<v8::ArrayBuffer> buffer : array_buffers)
+    std::ignore = buffer->Detach(v8::Local<v8::Value>());
+}
+
 v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
                                         const blink::CloneableMessage& in) {
   return V8Deserializer(isolate, in).Deserialize();
 }
 
+v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
+                                        blink::TransferableMessage& in) {
+  V8Deserializer deserializer(isolate, in);
+  for (size_t i = 0; i < in.array_buffer_contents_array.size(); ++i) {
+    // The sender may still have the shared memory mapped, so the contents are
+    // copied out of it instead of being adopted, as Blink does.
+    const mojo_base::BigBuffer& contents =
+        in.array_buffer_contents_array[i]->contents;
+    std::unique_ptr<v8::BackingStore> backing_store =
+        v8::ArrayBuffer::NewBackingStore(isolate, contents.size());
+    if (contents.size())
+      memcpy(backing_store->Data(), contents.data(), contents.size());
+    deserializer.TransferArrayBuffer(
+        i, v8::ArrayBuffer::New(isolate, std::move(backing_store)));
+  }
+  return deserializer.Deserialize();
+}
+
 v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
                                         base::span<const uint8_t> data) {
   return V8Deserializer(isolate, data).Deserialize();
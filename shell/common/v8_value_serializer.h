@@ -5,27 +5,45 @@
 #ifndef ELECTRON_SHELL_COMMON_V8_VALUE_SERIALIZER_H_
 #define ELECTRON_SHELL_COMMON_V8_VALUE_SERIALIZER_H_
 
+#include <vector>
+
 #include "base/containers/span.h"
+#include "third_party/blink/public/common/messaging/transferable_message.h"
 #include "ui/gfx/image/image_skia_rep.h"
 
 namespace v8 {
+class ArrayBuffer;
 class Isolate;
 template <class T>
 class Local;
 class Value;
 }  // namespace v8
 
-namespace blink {
-struct CloneableMessage;
-}
-
 namespace electron {
 
 bool SerializeV8Value(v8::Isolate* isolate,
                       v8::Local<v8::Value> value,
                       blink::CloneableMessage* out);
+// Same as above, but |array_buffers| are transferred rather than cloned, like
+// window.postMessage does: their contents are passed alongside the encoded
+// message, in shared memory when they are large. The caller detaches them
+// with DetachArrayBuffers() once the message has been sent, so that they are
+// left alone when sending fails. SharedRingBuffers can only be sent this way.
+bool SerializeV8Value(
+    v8::Isolate* isolate,
+    v8::Local<v8::Value> value,
+    const std::vector<v8::Local<v8::ArrayBuffer>>& array_buffers,
+    blink::TransferableMessage* out);
+// Detaches the ArrayBuffers that were transferred with a message.
+void DetachArrayBuffers(
+    v8::Isolate* isolate,
+    const std::vector<v8::Local<v8::ArrayBuffer>>& array_buffers);
 v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
                                         const blink::CloneableMessage& in);
+// Same as above, but also recreates the ArrayBuffers transferred with |in|,
+// and maps the SharedRingBuffers sent with it, taking their memory out of |in|.
+v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
+                                        blink::TransferableMessage& in);
 v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
                                         base::span<const uint8_t> data);
 
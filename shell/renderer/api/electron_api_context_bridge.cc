@@ -22,6 +22,7 @@
 #include "shell/common/gin_converters/blink_converter.h"
 #include "shell/common/gin_converters/callback_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
+#include "shell/common/gin_helper/error_thrower.h"
 #include "shell/common/gin_helper/promise.h"
 #include "shell/common/node_includes.h"
 #include "shell/common/world_ids.h"
@@ -47,6 +48,11 @@ const char kProxyFunctionPrivateKey[] = "electron_contextBridge_proxy_fn";
 const char kSupportsDynamicPropertiesPrivateKey[] =
     "electron_contextBridge_supportsDynamicProperties";
 const char kOriginalFunctionPrivateKey[] = "electron_contextBridge_original_fn";
+const char kArrayBufferModePrivateKey[] =
+    "electron_contextBridge_arrayBufferMode";
+const char kProxyCachePrivateKey[] = "electron_contextBridge_proxy";
+const char kDynamicProxyCachePrivateKey[] =
+    "electron_contextBridge_proxy_dynamic";
 
 }  // namespace context_bridge
 
@@ -132,6 +138,192 @@ v8::MaybeLocal<v8::Value> GetPrivate(v8::Local<v8::Context> context,
                           gin::StringToV8(context->GetIsolate(), key)));
 }
 
+// Proxies of functions and promises forward to the original, so unlike the
+// copies made of other objects they can be reused every time the original
+// crosses the bridge, which also keeps their identity stable across calls.
+// The proxies made for an object are kept on it in a private Map keyed by the
+// global of the context each was made for, which is reclaimed along with the
+// object.
+v8::MaybeLocal<v8::Value> GetPersistentProxy(
+    v8::Local<v8::Context> source_context,
+    v8::Local<v8::Context> destination_context,
+    v8::Local<v8::Object> value,
+    bool support_dynamic_properties) {
+  // Only used on the main thread.
+  static int hits = 0;
+  static int misses = 0;
+
+  v8::Local<v8::Value> proxies;
+  v8::Local<v8::Value> proxy;
+  bool hit = GetPrivate(source_context, value,
+                        support_dynamic_properties
+                            ? context_bridge::kDynamicProxyCachePrivateKey
+                            : context_bridge::kProxyCachePrivateKey)
+                 .ToLocal(&proxies) &&
+             proxies->IsMap() &&
+             proxies.As<v8::Map>()
+                 ->Get(source_context, destination_context->Global())
+                 .ToLocal(&proxy) &&
+             proxy->IsObject();
+  ++(hit ? hits : misses);
+  TRACE_COUNTER2("electron", "ContextBridge::ProxyCache", "hits", hits,
+                 "misses", misses);
+  return hit ? v8::MaybeLocal<v8::Value>(proxy) : v8::MaybeLocal<v8::Value>();
+}
+
+void SetPersistentProxy(v8::Local<v8::Context> source_context,
+                        v8::Local<v8::Context> destination_context,
+                        v8::Local<v8::Object> value,
+                        v8::Local<v8::Value> proxy,
+                        bool support_dynamic_properties) {
+  v8::Context::Scope source_scope(source_context);
+  v8::Isolate* isolate = source_context->GetIsolate();
+  const char* key = support_dynamic_properties
+                        ? context_bridge::kDynamicProxyCachePrivateKey
+                        : context_bridge::kProxyCachePrivateKey;
+  v8::Local<v8::Value> proxies;
+  if (!GetPrivate(source_context, value, key).ToLocal(&proxies) ||
+      !proxies->IsMap()) {
+    proxies = v8::Map::New(isolate);
+    // Not caching the proxy is harmless, so failures are ignored.
+    if (value
+            ->SetPrivate(source_context,
+                         v8::Private::ForApi(isolate,
+                                             gin::StringToV8(isolate, key)),
+                         proxies)
+            .IsNothing()) {
+      return;
+    }
+  }
+  std::ignore = proxies.As<v8::Map>()->Set(
+      source_context, destination_context->Global(), proxy);
+}
+
+// How an ArrayBuffer crosses the bridge. Buffers are copied unless they were
+// opted into sharing or transferring their memory with contextBridge.
+enum class ArrayBufferMode { kCopy = 0, kShare = 1, kTransfer = 2 };
+
+ArrayBufferMode GetArrayBufferMode(v8::Local<v8::Context> context,
+                                   v8::Local<v8::ArrayBuffer> buffer) {
+  v8::Local<v8::Value> mode;
+  if (!GetPrivate(context, buffer, context_bridge::kArrayBufferModePrivateKey)
+           .ToLocal(&mode) ||
+      !mode->IsInt32()) {
+    return ArrayBufferMode::kCopy;
+  }
+  switch (mode.As<v8::Int32>()->Value()) {
+    case static_cast<int>(ArrayBufferMode::kShare):
+      return ArrayBufferMode::kShare;
+    case static_cast<int>(ArrayBufferMode::kTransfer):
+      return ArrayBufferMode::kTransfer;
+    default:
+      return ArrayBufferMode::kCopy;
+  }
+}
+
+// Creates a view like |view| over |buffer| in the current context.
+v8::Local<v8::Value> CreateArrayBufferView(v8::Local<v8::ArrayBufferView> view,
+                                           v8::Local<v8::ArrayBuffer> buffer,
+                                           size_t byte_offset,
+                                           size_t length) {
+#define CREATE_TYPED_ARRAY(Type) \
+  if (view->Is##Type())          \
+    return v8::Type::New(buffer, byte_offset, length);
+  CREATE_TYPED_ARRAY(Uint8Array)
+  CREATE_TYPED_ARRAY(Uint8ClampedArray)
+  CREATE_TYPED_ARRAY(Int8Array)
+  CREATE_TYPED_ARRAY(Uint16Array)
+  CREATE_TYPED_ARRAY(Int16Array)
+  CREATE_TYPED_ARRAY(Uint32Array)
+  CREATE_TYPED_ARRAY(Int32Array)
+  CREATE_TYPED_ARRAY(Float32Array)
+  CREATE_TYPED_ARRAY(Float64Array)
+  CREATE_TYPED_ARRAY(BigInt64Array)
+  CREATE_TYPED_ARRAY(BigUint64Array)
+#undef CREATE_TYPED_ARRAY
+  DCHECK(view->IsDataView());
+  return v8::DataView::New(buffer, byte_offset, length);
+}
+
+// Passes an ArrayBuffer, or a view of one, whose memory was opted into being
+// shared or transferred by wrapping its backing store in the destination
+// context instead of serializing it. Both contexts live in the same isolate,
+// so this needs no copy. Returns false if |value| is not such a buffer.
+bool PassArrayBufferByReference(v8::Local<v8::Context> source_context,
+                                v8::Local<v8::Context> destination_context,
+                                v8::Local<v8::Value> value,
+                                context_bridge::ObjectCache* object_cache,
+                                BridgeErrorTarget error_target,
+                                v8::MaybeLocal<v8::Value>* result) {
+  v8::Local<v8::ArrayBuffer> buffer;
+  if (value->IsArrayBuffer())
+    buffer = value.As<v8::ArrayBuffer>();
+  else if (value->IsArrayBufferView())
+    buffer = value.As<v8::ArrayBufferView>()->Buffer();
+  if (buffer.IsEmpty() || buffer->IsSharedArrayBuffer())
+    return false;
+  ArrayBufferMode mode = GetArrayBufferMode(source_context, buffer);
+  if (mode == ArrayBufferMode::kCopy)
+    return false;
+
+  // Detaching the buffer zeroes the offset and length of its views.
+  size_t byte_offset = 0;
+  size_t length = 0;
+  if (value->IsTypedArray()) {
+    byte_offset = value.As<v8::TypedArray>()->ByteOffset();
+    length = value.As<v8::TypedArray>()->Length();
+  } else if (value->IsDataView()) {
+    byte_offset = value.As<v8::DataView>()->ByteOffset();
+    length = value.As<v8::DataView>()->ByteLength();
+  }
+
+  // Views of the same buffer end up on the same new buffer, which also
+  // means that a transferred buffer is only detached once.
+  v8::Isolate* isolate = source_context->GetIsolate();
+  v8::Local<v8::Value> passed_buffer;
+  if (!object_cache->GetCachedProxiedObject(buffer).ToLocal(&passed_buffer)) {
+    std::shared_ptr<v8::BackingStore> backing_store =
+        buffer->GetBackingStore();
+    if (mode == ArrayBufferMode::kTransfer) {
+      if (!buffer->IsDetachable()) {
+        v8::Context::Scope error_scope(
+            error_target == BridgeErrorTarget::kSource ? source_context
+                                                       : destination_context);
+        isolate->ThrowException(v8::Exception::TypeError(gin::StringToV8(
+            isolate, "An ArrayBuffer that can not be detached can not be "
+                     "transferred over the context bridge.")));
+        return true;
+      }
+      // V8 throws if the buffer is guarded by a detach key.
+      if (buffer->Detach(v8::Local<v8::Value>()).IsNothing())
+        return true;
+    }
+    v8::Context::Scope destination_scope(destination_context);
+    passed_buffer = v8::ArrayBuffer::New(isolate, std::move(backing_store));
+    // Shared memory stays shared on its way back.
+    if (mode == ArrayBufferMode::kShare) {
+      SetPrivate(destination_context, passed_buffer.As<v8::Object>(),
+                 context_bridge::kArrayBufferModePrivateKey,
+                 gin::ConvertToV8(isolate, static_cast<int>(mode)));
+    }
+    object_cache->CacheProxiedObject(buffer, passed_buffer);
+  }
+
+  if (value->IsArrayBuffer()) {
+    *result = passed_buffer;
+    return true;
+  }
+
+  v8::Context::Scope destination_scope(destination_context);
+  v8::Local<v8::Value> passed_view =
+      CreateArrayBufferView(value.As<v8::ArrayBufferView>(),
+                            passed_buffer.As<v8::ArrayBuffer>(), byte_offset,
+                            length);
+  object_cache->CacheProxiedObject(value, passed_view);
+  *result = passed_view;
+  return true;
+}
+
 }  // namespace
 
 v8::MaybeLocal<v8::Value> PassValueToOtherContext(
@@ -195,6 +387,13 @@ v8::MaybeLocal<v8::Value> PassValueToOtherContext(
         return v8::MaybeLocal<v8::Value>(proxy_func);
       }
 
+      if (GetPersistentProxy(source_context, destination_context, func,
+                             support_dynamic_properties)
+              .ToLocal(&proxy_func)) {
+        object_cache->CacheProxiedObject(value, proxy_func);
+        return v8::MaybeLocal<v8::Value>(proxy_func);
+      }
+
       v8::Local<v8::Object> state =
           v8::Object::New(destination_context->GetIsolate());
       SetPrivate(destination_context, state,
@@ -209,6 +408,8 @@ v8::MaybeLocal<v8::Value> PassValueToOtherContext(
         return v8::MaybeLocal<v8::Value>();
       SetPrivate(destination_context, proxy_func.As<v8::Object>(),
                  context_bridge::kOriginalFunctionPrivateKey, func);
+      SetPersistentProxy(source_context, destination_context, func,
+                         proxy_func, support_dynamic_properties);
       object_cache->CacheProxiedObject(value, proxy_func);
       return v8::MaybeLocal<v8::Value>(proxy_func);
     }
@@ -218,6 +419,14 @@ v8::MaybeLocal<v8::Value> PassValueToOtherContext(
   if (value->IsPromise()) {
     v8::Context::Scope destination_scope(destination_context);
     auto source_promise = value.As<v8::Promise>();
+    v8::Local<v8::Value> cached_promise;
+    if (GetPersistentProxy(source_context, destination_context, source_promise,
+                           false)
+            .ToLocal(&cached_promise)) {
+      object_cache->CacheProxiedObject(value, cached_promise);
+      return v8::MaybeLocal<v8::Value>(cached_promise);
+    }
+
     // Make the promise a shared_ptr so that when the original promise is
     // freed the proxy promise is correctly freed as well instead of being
     // left dangling
@@ -325,6 +534,8 @@ v8::MaybeLocal<v8::Value> PassValueToOtherContext(
         gin::ConvertToV8(destination_context->GetIsolate(), std::move(catch_cb))
             .As<v8::Function>());
 
+    SetPersistentProxy(source_context, destination_context, source_promise,
+                       proxied_promise_handle, false);
     object_cache->CacheProxiedObject(value, proxied_promise_handle);
     return v8::MaybeLocal<v8::Value>(proxied_promise_handle);
   }
@@ -403,6 +614,12 @@ v8::MaybeLocal<v8::Value> PassValueToOtherContext(
     return v8::MaybeLocal<v8::Value>(passed_value.ToLocalChecked());
   }
 
+  v8::MaybeLocal<v8::Value> passed_buffer;
+  if (PassArrayBufferByReference(source_context, destination_context, value,
+                                 object_cache, error_target, &passed_buffer)) {
+    return passed_buffer;
+  }
+
   // Serializable objects
   blink::CloneableMessage ret;
   {
@@ -788,6 +1005,48 @@ bool OverrideGlobalPropertyFromIsolatedWorld(
   }
 }
 
+void SetArrayBufferMode(gin_helper::ErrorThrower thrower,
+                        v8::Local<v8::Value> value,
+                        const std::string& mode) {
+  v8::Local<v8::ArrayBuffer> buffer;
+  if (value->IsArrayBuffer())
+    buffer = value.As<v8::ArrayBuffer>();
+  else if (value->IsArrayBufferView())
+    buffer = value.As<v8::ArrayBufferView>()->Buffer();
+  if (buffer.IsEmpty() || buffer->IsSharedArrayBuffer()) {
+    thrower.ThrowTypeError("Expected an ArrayBuffer or ArrayBufferView");
+    return;
+  }
+  // The mode applies to the whole buffer, and the other side can reach all of
+  // it through the buffer property of the views it receives. A view of only
+  // part of a buffer must not give away the rest of it.
+  if (value->IsArrayBufferView()) {
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    if (view->ByteOffset() != 0 ||
+        view->ByteLength() != buffer->ByteLength()) {
+      thrower.ThrowTypeError(
+          "Only views of a whole ArrayBuffer can be shared or transferred, "
+          "pass a copy of the view with slice() instead");
+      return;
+    }
+  }
+
+  ArrayBufferMode buffer_mode;
+  if (mode == "share") {
+    buffer_mode = ArrayBufferMode::kShare;
+  } else if (mode == "transfer") {
+    buffer_mode = ArrayBufferMode::kTransfer;
+  } else {
+    thrower.ThrowTypeError("Invalid ArrayBuffer mode");
+    return;
+  }
+
+  v8::Local<v8::Context> context = thrower.isolate()->GetCurrentContext();
+  SetPrivate(context, buffer, context_bridge::kArrayBufferModePrivateKey,
+             gin::ConvertToV8(thrower.isolate(),
+                              static_cast<int>(buffer_mode)));
+}
+
 bool IsCalledFromMainWorld(v8::Isolate* isolate) {
   auto* render_frame = GetRenderFrame(isolate->GetCurrentContext()->Global());
   CHECK(render_frame);
@@ -816,6 +1075,7 @@ void Initialize(v8::Local<v8::Object> exports,
                  &electron::api::OverrideGlobalPropertyFromIsolatedWorld);
   dict.SetMethod("_isCalledFromMainWorld",
                  &electron::api::IsCalledFromMainWorld);
+  dict.SetMethod("setArrayBufferMode", &electron::api::SetArrayBufferMode);
 #if DCHECK_IS_ON()
   dict.Set("_isDebug", true);
 #endif
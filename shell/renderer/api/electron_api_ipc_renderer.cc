@@ -2,15 +2,35 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <memory>
 #include <string>
-
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/functional/bind.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/task/single_thread_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/thread_annotations.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "content/public/renderer/render_frame.h"
 #include "content/public/renderer/render_frame_observer.h"
+#include "content/public/renderer/render_frame_observer_tracker.h"
 #include "gin/dictionary.h"
 #include "gin/handle.h"
 #include "gin/object_template_builder.h"
 #include "gin/wrappable.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/receiver_set.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "mojo/public/cpp/bindings/self_owned_receiver.h"
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "shell/common/api/api.mojom.h"
 #include "shell/common/gin_converters/blink_converter.h"
@@ -33,6 +53,78 @@ namespace {
 const char kIPCMethodCalledAfterContextReleasedError[] =
     "IPC method called after context was released";
 
+// Limits of the messages coalesced into one ElectronApiIPC::MessageBatch
+// call, past which the batch is sent right away.
+constexpr size_t kMaxBatchedMessages = 1024;
+constexpr size_t kMaxBatchedBytes = 1024 * 1024;
+
+// The reply to a sendSync call with a timeout. It is received on a worker
+// sequence, so that the main thread can stop waiting for it once the timeout
+// passes, even while the main process is too busy to reply.
+class SyncReplyWaiter : public base::RefCountedThreadSafe<SyncReplyWaiter> {
+ public:
+  SyncReplyWaiter() = default;
+
+  // disable copy
+  SyncReplyWaiter(const SyncReplyWaiter&) = delete;
+  SyncReplyWaiter& operator=(const SyncReplyWaiter&) = delete;
+
+  // Called on the worker sequence. |result| is null when the main process
+  // dropped the call without replying.
+  void SetResult(absl::optional<blink::CloneableMessage> result) {
+    base::AutoLock lock(lock_);
+    if (done_)
+      return;
+    done_ = true;
+    result_ = std::move(result);
+    event_.Signal();
+  }
+
+  // Waits for the reply for at most |timeout|. Returns false when it did not
+  // come in time, after which it is dropped.
+  bool Wait(base::TimeDelta timeout,
+            absl::optional<blink::CloneableMessage>* result) {
+    event_.TimedWait(timeout);
+    base::AutoLock lock(lock_);
+    if (!done_) {
+      done_ = true;
+      return false;
+    }
+    *result = std::move(result_);
+    return true;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<SyncReplyWaiter>;
+  ~SyncReplyWaiter() = default;
+
+  base::Lock lock_;
+  base::WaitableEvent event_;
+  bool done_ GUARDED_BY(lock_) = false;
+  absl::optional<blink::CloneableMessage> result_ GUARDED_BY(lock_);
+};
+
+class SyncMessageReplyImpl : public electron::mojom::SyncMessageReply {
+ public:
+  explicit SyncMessageReplyImpl(scoped_refptr<SyncReplyWaiter> waiter)
+      : waiter_(std::move(waiter)) {}
+  // The receiver is self-owned, so this runs when the main process drops the
+  // call, which stops the wait without a result.
+  ~SyncMessageReplyImpl() override { waiter_->SetResult(absl::nullopt); }
+
+  // disable copy
+  SyncMessageReplyImpl(const SyncMessageReplyImpl&) = delete;
+  SyncMessageReplyImpl& operator=(const SyncMessageReplyImpl&) = delete;
+
+  // electron::mojom::SyncMessageReply:
+  void Reply(blink::CloneableMessage result) override {
+    waiter_->SetResult(std::move(result));
+  }
+
+ private:
+  scoped_refptr<SyncReplyWaiter> waiter_;
+};
+
 RenderFrame* GetCurrentRenderFrame() {
   WebLocalFrame* frame = WebLocalFrame::FrameForCurrentContext();
   if (!frame)
@@ -41,7 +133,90 @@ RenderFrame* GetCurrentRenderFrame() {
   return RenderFrame::FromWebFrame(frame);
 }
 
+// The messages sent with ipcRenderer.send in a frame that are waiting to be
+// sent together once the current task is done, which saves the browser a trip
+// into JavaScript per message. The queue is shared by the ipcRenderer of every
+// world in the frame, so that the messages of one world can not overtake
+// those another world sent before them.
+class FrameMessageQueue
+    : public content::RenderFrameObserver,
+      public content::RenderFrameObserverTracker<FrameMessageQueue> {
+ public:
+  static base::WeakPtr<FrameMessageQueue> ForFrame(RenderFrame* render_frame) {
+    FrameMessageQueue* queue = Get(render_frame);
+    if (!queue)
+      queue = new FrameMessageQueue(render_frame);
+    return queue->weak_factory_.GetWeakPtr();
+  }
+
+  // disable copy
+  FrameMessageQueue(const FrameMessageQueue&) = delete;
+  FrameMessageQueue& operator=(const FrameMessageQueue&) = delete;
+
+  void Queue(bool internal,
+             const std::string& channel,
+             blink::CloneableMessage arguments) {
+    const size_t size = arguments.encoded_message.size();
+    if (!pending_messages_.empty() &&
+        pending_bytes_ + size > kMaxBatchedBytes) {
+      Flush();
+    }
+    pending_messages_.push_back(electron::mojom::IPCMessage::New(
+        internal, channel, std::move(arguments)));
+    pending_bytes_ += size;
+    if (pending_messages_.size() >= kMaxBatchedMessages) {
+      Flush();
+    } else if (!flush_pending_) {
+      flush_pending_ = true;
+      base::SingleThreadTaskRunner::GetCurrentDefault()->PostTask(
+          FROM_HERE, base::BindOnce(&FrameMessageQueue::Flush,
+                                    weak_factory_.GetWeakPtr()));
+    }
+  }
+
+  void Flush() {
+    flush_pending_ = false;
+    if (pending_messages_.empty())
+      return;
+    std::vector<electron::mojom::IPCMessagePtr> messages;
+    messages.swap(pending_messages_);
+    pending_bytes_ = 0;
+    if (messages.size() == 1) {
+      auto& message = messages.front();
+      electron_ipc_remote_->Message(message->internal, message->channel,
+                                    std::move(message->arguments));
+    } else {
+      electron_ipc_remote_->MessageBatch(std::move(messages));
+    }
+  }
+
+ private:
+  explicit FrameMessageQueue(RenderFrame* render_frame)
+      : content::RenderFrameObserver(render_frame),
+        content::RenderFrameObserverTracker<FrameMessageQueue>(render_frame) {
+    // The remote shares the frame's channel with those of the ipcRenderers,
+    // so the batches stay in order with the other messages they send.
+    render_frame->GetRemoteAssociatedInterfaces()->GetInterface(
+        &electron_ipc_remote_);
+  }
+  ~FrameMessageQueue() override = default;
+
+  // content::RenderFrameObserver:
+  void OnDestruct() override {
+    Flush();
+    delete this;
+  }
+
+  mojo::AssociatedRemote<electron::mojom::ElectronApiIPC> electron_ipc_remote_;
+  std::vector<electron::mojom::IPCMessagePtr> pending_messages_;
+  size_t pending_bytes_ = 0;
+  bool flush_pending_ = false;
+
+  base::WeakPtrFactory<FrameMessageQueue> weak_factory_{this};
+};
+
 class IPCRenderer : public gin::Wrappable<IPCRenderer>,
+                    public electron::mojom::ElectronDirectIPCSender,
                     public content::RenderFrameObserver {
  public:
   static gin::WrapperInfo kWrapperInfo;
@@ -60,15 +235,23 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
 
     render_frame->GetRemoteAssociatedInterfaces()->GetInterface(
         &electron_ipc_remote_);
+    message_queue_ = FrameMessageQueue::ForFrame(render_frame);
   }
 
-  void OnDestruct() override { electron_ipc_remote_.reset(); }
+  void OnDestruct() override {
+    FlushMessages();
+    ResetDirectConnections();
+    electron_ipc_remote_.reset();
+  }
 
   void WillReleaseScriptContext(v8::Local<v8::Context> context,
                                 int32_t world_id) override {
     if (weak_context_.IsEmpty() ||
-        weak_context_.Get(context->GetIsolate()) == context)
+        weak_context_.Get(context->GetIsolate()) == context) {
+      FlushMessages();
+      ResetDirectConnections();
       electron_ipc_remote_.reset();
+    }
   }
 
   // gin::Wrappable:
@@ -99,7 +282,16 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
     if (!electron::SerializeV8Value(isolate, arguments, &message)) {
       return;
     }
-    electron_ipc_remote_->Message(internal, channel, std::move(message));
+    if (message_queue_)
+      message_queue_->Queue(internal, channel, std::move(message));
+  }
+
+  // Every method other than send flushes the messages queued in the frame
+  // first, so that messages still reach the browser in the order they were
+  // sent.
+  void FlushMessages() {
+    if (message_queue_)
+      message_queue_->Flush();
   }
 
   v8::Local<v8::Promise> Invoke(v8::Isolate* isolate,
@@ -111,6 +303,7 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
       thrower.ThrowError(kIPCMethodCalledAfterContextReleasedError);
       return v8::Local<v8::Promise>();
     }
+    FlushMessages();
     blink::CloneableMessage message;
     if (!electron::SerializeV8Value(isolate, arguments, &message)) {
       return v8::Local<v8::Promise>();
@@ -137,13 +330,7 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
       thrower.ThrowError(kIPCMethodCalledAfterContextReleasedError);
       return;
     }
-    blink::TransferableMessage transferable_message;
-    if (!electron::SerializeV8Value(isolate, message_value,
-                                    &transferable_message)) {
-      // SerializeV8Value sets an exception.
-      return;
-    }
-
+    FlushMessages();
     std::vector<v8::Local<v8::Object>> transferables;
     if (transfer && !transfer.value()->IsUndefined()) {
       if (!gin::ConvertFromV8(isolate, *transfer, &transferables)) {
@@ -152,8 +339,24 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
       }
     }
 
-    std::vector<blink::MessagePortChannel> ports;
+    std::vector<v8::Local<v8::ArrayBuffer>> array_buffers;
+    std::vector<v8::Local<v8::Object>> port_objects;
     for (auto& transferable : transferables) {
+      if (transferable->IsArrayBuffer())
+        array_buffers.push_back(transferable.As<v8::ArrayBuffer>());
+      else
+        port_objects.push_back(transferable);
+    }
+
+    blink::TransferableMessage transferable_message;
+    if (!electron::SerializeV8Value(isolate, message_value, array_buffers,
+                                    &transferable_message)) {
+      // SerializeV8Value sets an exception.
+      return;
+    }
+
+    std::vector<blink::MessagePortChannel> ports;
+    for (auto& transferable : port_objects) {
       absl::optional<blink::MessagePortChannel> port =
           blink::WebMessagePortConverter::
               DisentangleAndExtractMessagePortChannel(isolate, transferable);
@@ -167,6 +370,7 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
     transferable_message.ports = std::move(ports);
     electron_ipc_remote_->ReceivePostMessage(channel,
                                              std::move(transferable_message));
+    electron::DetachArrayBuffers(isolate, array_buffers);
   }
 
   void SendTo(v8::Isolate* isolate,
@@ -178,12 +382,136 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
       thrower.ThrowError(kIPCMethodCalledAfterContextReleasedError);
       return;
     }
+    FlushMessages();
     blink::CloneableMessage message;
     if (!electron::SerializeV8Value(isolate, arguments, &message)) {
       return;
     }
-    electron_ipc_remote_->MessageTo(web_contents_id, channel,
-                                    std::move(message));
+    DirectConnection& connection = direct_connections_[web_contents_id];
+    switch (connection.state) {
+      case DirectConnection::State::kNone: {
+        // The first message goes through the browser, which connects the two
+        // renderers while it is at it.
+        electron_ipc_remote_->MessageTo(web_contents_id, channel,
+                                        std::move(message));
+        connection.state = DirectConnection::State::kConnecting;
+        mojo::PendingRemote<electron::mojom::ElectronDirectIPCSender> sender;
+        connection.sender_id = direct_ipc_senders_.Add(
+            this, sender.InitWithNewPipeAndPassReceiver(), web_contents_id);
+        electron_ipc_remote_->ConnectTo(
+            web_contents_id, std::move(sender),
+            base::BindOnce(&IPCRenderer::OnDirectConnection,
+                           weak_factory_.GetWeakPtr(), web_contents_id));
+        break;
+      }
+      case DirectConnection::State::kConnecting:
+      case DirectConnection::State::kClosing:
+        // Held back until the connection is made or closed, so that they can
+        // not overtake the messages sent before them.
+        connection.pending.emplace_back(channel, std::move(message));
+        break;
+      case DirectConnection::State::kConnected:
+        connection.remote->Message(channel, std::move(message));
+        break;
+      case DirectConnection::State::kRefused:
+        electron_ipc_remote_->MessageTo(web_contents_id, channel,
+                                        std::move(message));
+        break;
+    }
+  }
+
+  void OnDirectConnection(
+      int32_t web_contents_id,
+      mojo::PendingRemote<electron::mojom::ElectronDirectIPC> remote) {
+    auto it = direct_connections_.find(web_contents_id);
+    if (it == direct_connections_.end())
+      return;
+    DirectConnection& connection = it->second;
+    if (!remote) {
+      connection.state = DirectConnection::State::kRefused;
+      direct_ipc_senders_.Remove(connection.sender_id);
+      SendPendingThroughBrowser(web_contents_id, &connection);
+      return;
+    }
+    if (connection.close_requested) {
+      // Closed before it was even made, so nothing was sent over it yet.
+      SendPendingThroughBrowser(web_contents_id, &connection);
+      CloseDirectConnection(it);
+      return;
+    }
+    connection.state = DirectConnection::State::kConnected;
+    connection.remote.Bind(std::move(remote));
+    // The target went away; the next message connects again, to whatever its
+    // main frame is then. The messages that were held back go through the
+    // browser.
+    connection.remote.set_disconnect_handler(
+        base::BindOnce(&IPCRenderer::OnDirectConnectionClosed,
+                       base::Unretained(this), web_contents_id));
+    for (auto& [channel, message] : connection.pending)
+      connection.remote->Message(channel, std::move(message));
+    connection.pending.clear();
+  }
+
+  // electron::mojom::ElectronDirectIPCSender:
+  void Close() override {
+    int32_t web_contents_id = direct_ipc_senders_.current_context();
+    auto it = direct_connections_.find(web_contents_id);
+    if (it == direct_connections_.end() ||
+        it->second.sender_id != direct_ipc_senders_.current_receiver()) {
+      return;
+    }
+    DirectConnection& connection = it->second;
+    switch (connection.state) {
+      case DirectConnection::State::kConnecting:
+        connection.close_requested = true;
+        break;
+      case DirectConnection::State::kConnected:
+        // The messages already sent over the connection are emitted before
+        // the ones held back from now on go through the browser.
+        connection.state = DirectConnection::State::kClosing;
+        connection.remote->Flush(
+            base::BindOnce(&IPCRenderer::OnDirectConnectionClosed,
+                           weak_factory_.GetWeakPtr(), web_contents_id));
+        break;
+      case DirectConnection::State::kNone:
+      case DirectConnection::State::kClosing:
+      case DirectConnection::State::kRefused:
+        break;
+    }
+  }
+
+  void OnDirectConnectionClosed(int32_t web_contents_id) {
+    auto it = direct_connections_.find(web_contents_id);
+    if (it == direct_connections_.end())
+      return;
+    SendPendingThroughBrowser(web_contents_id, &it->second);
+    CloseDirectConnection(it);
+  }
+
+  void CloseDirectConnection(
+      base::flat_map<int32_t, DirectConnection>::iterator it) {
+    direct_ipc_senders_.Remove(it->second.sender_id);
+    direct_connections_.erase(it);
+  }
+
+  void SendPendingThroughBrowser(int32_t web_contents_id,
+                                 DirectConnection* connection) {
+    if (electron_ipc_remote_) {
+      for (auto& [channel, message] : connection->pending) {
+        electron_ipc_remote_->MessageTo(web_contents_id, channel,
+                                        std::move(message));
+      }
+    }
+    connection->pending.clear();
+  }
+
+  // Sends the messages held back for connections that are not made yet
+  // through the browser, while it still can.
+  void ResetDirectConnections() {
+    for (auto& [web_contents_id, connection] : direct_connections_)
+      SendPendingThroughBrowser(web_contents_id, &connection);
+    direct_connections_.clear();
+    direct_ipc_senders_.Clear();
   }
 
   void SendToHost(v8::Isolate* isolate,
@@ -194,6 +522,7 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
       thrower.ThrowError(kIPCMethodCalledAfterContextReleasedError);
       return;
     }
+    FlushMessages();
     blink::CloneableMessage message;
     if (!electron::SerializeV8Value(isolate, arguments, &message)) {
       return;
@@ -205,24 +534,106 @@ class IPCRenderer : public gin::Wrappable<IPCRenderer>,
                                 gin_helper::ErrorThrower thrower,
                                 bool internal,
                                 const std::string& channel,
-                                v8::Local<v8::Value> arguments) {
+                                v8::Local<v8::Value> arguments,
+                                absl::optional<gin::Dictionary> options) {
     if (!electron_ipc_remote_) {
       thrower.ThrowError(kIPCMethodCalledAfterContextReleasedError);
       return v8::Local<v8::Value>();
     }
+    double timeout = 0;
+    std::string priority = "normal";
+    if (options) {
+      options->Get("timeout", &timeout);
+      options->Get("priority", &priority);
+    }
+    if (!(timeout >= 0)) {
+      thrower.ThrowError("timeout must be a non-negative number");
+      return v8::Local<v8::Value>();
+    }
+    if (priority != "normal" && priority != "high") {
+      thrower.ThrowError("priority must be 'normal' or 'high'");
+      return v8::Local<v8::Value>();
+    }
+    // High priority calls go ahead of the messages still queued here, as they
+    // do of the ones queued in the browser.
+    const bool high_priority = priority == "high";
+    if (!high_priority)
+      FlushMessages();
     blink::CloneableMessage message;
     if (!electron::SerializeV8Value(isolate, arguments, &message)) {
       return v8::Local<v8::Value>();
     }
 
-    blink::CloneableMessage result;
-    electron_ipc_remote_->MessageSync(internal, channel, std::move(message),
-                                      &result);
-    return electron::DeserializeV8Value(isolate, result);
+    auto sync_options = electron::mojom::SyncMessageOptions::New(
+        base::Milliseconds(timeout), base::TimeTicks::Now(), high_priority);
+    if (!sync_options->timeout.is_positive()) {
+      blink::CloneableMessage result;
+      if (!electron_ipc_remote_->MessageSync(internal, channel,
+                                             std::move(message),
+                                             std::move(sync_options),
+                                             &result)) {
+        return v8::Null(isolate);
+      }
+      return electron::DeserializeV8Value(isolate, result);
+    }
+
+    // The message is still sent down the frame's channel, in order with the
+    // others, but the reply comes back on a worker sequence. The wait then
+    // ends at the timeout here, however long the main process takes.
+    const base::TimeDelta wait_time = sync_options->timeout;
+    auto waiter = base::MakeRefCounted<SyncReplyWaiter>();
+    mojo::PendingRemote<electron::mojom::SyncMessageReply> reply;
+    base::ThreadPool::CreateSequencedTaskRunner({})->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](mojo::PendingReceiver<electron::mojom::SyncMessageReply>
+                   receiver,
+               scoped_refptr<SyncReplyWaiter> waiter) {
+              mojo::MakeSelfOwnedReceiver(
+                  std::make_unique<SyncMessageReplyImpl>(std::move(waiter)),
+                  std::move(receiver));
+            },
+            reply.InitWithNewPipeAndPassReceiver(), waiter));
+    electron_ipc_remote_->MessageSyncWithTimeout(
+        internal, channel, std::move(message), std::move(sync_options),
+        std::move(reply));
+
+    absl::optional<blink::CloneableMessage> result;
+    if (!waiter->Wait(wait_time, &result)) {
+      thrower.ThrowError(base::StringPrintf(
+          "sendSync for '%s' timed out after %g ms", channel.c_str(),
+          timeout));
+      return v8::Local<v8::Value>();
+    }
+    if (!result)
+      return v8::Null(isolate);
+    return electron::DeserializeV8Value(isolate, *result);
   }
 
   v8::Global<v8::Context> weak_context_;
   mojo::AssociatedRemote<electron::mojom::ElectronApiIPC> electron_ipc_remote_;
+
+  // The frame's queue of messages sent with send(), shared with the other
+  // worlds.
+  base::WeakPtr<FrameMessageQueue> message_queue_;
+
+  // Connections to the WebContents sendTo was called for, by ID.
+  struct DirectConnection {
+    enum class State { kNone, kConnecting, kConnected, kClosing, kRefused };
+    State state = State::kNone;
+    mojo::Remote<electron::mojom::ElectronDirectIPC> remote;
+    // The browser's hold on the connection, in |direct_ipc_senders_|.
+    mojo::ReceiverId sender_id = 0;
+    // Whether the browser closed the connection before it was made.
+    bool close_requested = false;
+    std::vector<std::pair<std::string, blink::CloneableMessage>> pending;
+  };
+  base::flat_map<int32_t, DirectConnection> direct_connections_;
+  // The context of each receiver is the ID of the WebContents it sends to.
+  mojo::ReceiverSet<electron::mojom::ElectronDirectIPCSender, int32_t>
+      direct_ipc_senders_;
+
+  base::WeakPtrFactory<IPCRenderer> weak_factory_{this};
 };
 
 gin::WrapperInfo IPCRenderer::kWrapperInfo = {gin::kEmbedderNativeGin};
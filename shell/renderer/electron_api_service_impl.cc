@@ -173,6 +173,23 @@ void ElectronApiServiceImpl::Message(bool internal,
   EmitIPCEvent(context, internal, channel, {}, args, sender_id);
 }
 
+void ElectronApiServiceImpl::BindDirectIPC(
+    int32_t sender_id,
+    mojo::PendingReceiver<mojom::ElectronDirectIPC> receiver) {
+  direct_ipc_receivers_.Add(this, std::move(receiver), sender_id);
+}
+
+void ElectronApiServiceImpl::Message(const std::string& channel,
+                                     blink::CloneableMessage arguments) {
+  Message(false /* internal */, channel, std::move(arguments),
+          direct_ipc_receivers_.current_context());
+}
+
+void ElectronApiServiceImpl::Flush(FlushCallback callback) {
+  // Messages are emitted as they arrive.
+  std::move(callback).Run();
+}
+
 void ElectronApiServiceImpl::ReceivePostMessage(
     const std::string& channel,
     blink::TransferableMessage message) {
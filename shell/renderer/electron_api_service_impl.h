@@ -14,12 +14,14 @@
 #include "electron/shell/common/api/api.mojom.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/receiver.h"
+#include "mojo/public/cpp/bindings/receiver_set.h"
 
 namespace electron {
 
 class RendererClientBase;
 
 class ElectronApiServiceImpl : public mojom::ElectronRenderer,
+                               public mojom::ElectronDirectIPC,
                                public content::RenderFrameObserver {
  public:
   ElectronApiServiceImpl(content::RenderFrame* render_frame,
@@ -38,8 +40,17 @@ class ElectronApiServiceImpl : public mojom::ElectronRenderer,
                int32_t sender_id) override;
   void ReceivePostMessage(const std::string& channel,
                           blink::TransferableMessage message) override;
+  void BindDirectIPC(
+      int32_t sender_id,
+      mojo::PendingReceiver<mojom::ElectronDirectIPC> receiver) override;
   void TakeHeapSnapshot(mojo::ScopedHandle file,
                         TakeHeapSnapshotCallback callback) override;
+
+  // mojom::ElectronDirectIPC
+  void Message(const std::string& channel,
+               blink::CloneableMessage arguments) override;
+  void Flush(FlushCallback callback) override;
+
   void ProcessPendingMessages();
 
   base::WeakPtr<ElectronApiServiceImpl> GetWeakPtr() {
@@ -63,6 +74,8 @@ class ElectronApiServiceImpl : public mojom::ElectronRenderer,
 
   mojo::PendingReceiver<mojom::ElectronRenderer> pending_receiver_;
   mojo::Receiver<mojom::ElectronRenderer> receiver_{this};
+  // The context of each receiver is the ID of the WebContents sending on it.
+  mojo::ReceiverSet<mojom::ElectronDirectIPC, int32_t> direct_ipc_receivers_;
 
   RendererClientBase* renderer_client_;
   base::WeakPtrFactory<ElectronApiServiceImpl> weak_factory_{this};
@@ -0,0 +1,44 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/renderer/electron_render_thread_observer.h"
+
+#include <utility>
+
+#include "base/functional/bind.h"
+#include "shell/common/asar/asar_util.h"
+#include "third_party/blink/public/common/associated_interfaces/associated_interface_registry.h"
+
+namespace electron {
+
+ElectronRenderThreadObserver::ElectronRenderThreadObserver() = default;
+
+ElectronRenderThreadObserver::~ElectronRenderThreadObserver() = default;
+
+void ElectronRenderThreadObserver::RegisterMojoInterfaces(
+    blink::AssociatedInterfaceRegistry* associated_interfaces) {
+  associated_interfaces->AddInterface<mojom::ElectronRendererConfiguration>(
+      base::BindRepeating(&ElectronRenderThreadObserver::
+                              OnRendererConfigurationAssociatedRequest,
+                          base::Unretained(this)));
+}
+
+void ElectronRenderThreadObserver::UnregisterMojoInterfaces(
+    blink::AssociatedInterfaceRegistry* associated_interfaces) {
+  associated_interfaces->RemoveInterface(
+      mojom::ElectronRendererConfiguration::Name_);
+}
+
+void ElectronRenderThreadObserver::SetSharedAsarIndexes(
+    std::vector<mojom::SharedAsarIndexPtr> indexes) {
+  asar::SetSharedArchiveIndexes(std::move(indexes));
+}
+
+void ElectronRenderThreadObserver::OnRendererConfigurationAssociatedRequest(
+    mojo::PendingAssociatedReceiver<mojom::ElectronRendererConfiguration>
+        receiver) {
+  configuration_receivers_.Add(this, std::move(receiver));
+}
+
+}  // namespace electron
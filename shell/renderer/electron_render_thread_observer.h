@@ -0,0 +1,52 @@
+// Copyright (c) 2023 Microsoft, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ELECTRON_SHELL_RENDERER_ELECTRON_RENDER_THREAD_OBSERVER_H_
+#define ELECTRON_SHELL_RENDERER_ELECTRON_RENDER_THREAD_OBSERVER_H_
+
+#include <vector>
+
+#include "content/public/renderer/render_thread_observer.h"
+#include "mojo/public/cpp/bindings/associated_receiver_set.h"
+#include "mojo/public/cpp/bindings/pending_associated_receiver.h"
+#include "shell/common/api/api.mojom.h"
+
+namespace electron {
+
+// Receives the process-wide configuration the browser sends to each renderer
+// process before any of its frames are created.
+class ElectronRenderThreadObserver
+    : public content::RenderThreadObserver,
+      public mojom::ElectronRendererConfiguration {
+ public:
+  ElectronRenderThreadObserver();
+  ~ElectronRenderThreadObserver() override;
+
+  // disable copy
+  ElectronRenderThreadObserver(const ElectronRenderThreadObserver&) = delete;
+  ElectronRenderThreadObserver& operator=(const ElectronRenderThreadObserver&) =
+      delete;
+
+  // content::RenderThreadObserver:
+  void RegisterMojoInterfaces(
+      blink::AssociatedInterfaceRegistry* associated_interfaces) override;
+  void UnregisterMojoInterfaces(
+      blink::AssociatedInterfaceRegistry* associated_interfaces) override;
+
+ private:
+  // mojom::ElectronRendererConfiguration:
+  void SetSharedAsarIndexes(
+      std::vector<mojom::SharedAsarIndexPtr> indexes) override;
+
+  void OnRendererConfigurationAssociatedRequest(
+      mojo::PendingAssociatedReceiver<mojom::ElectronRendererConfiguration>
+          receiver);
+
+  mojo::AssociatedReceiverSet<mojom::ElectronRendererConfiguration>
+      configuration_receivers_;
+};
+
+}  // namespace electron
+
+#endif  // ELECTRON_SHELL_RENDERER_ELECTRON_RENDER_THREAD_OBSERVER_H_
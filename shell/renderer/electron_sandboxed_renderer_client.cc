@@ -4,7 +4,10 @@
 
 #include "shell/renderer/electron_sandboxed_renderer_client.h"
 
+#include <cstring>
 #include <iterator>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -15,6 +18,7 @@
 #include "base/path_service.h"
 #include "base/process/process_handle.h"
 #include "base/process/process_metrics.h"
+#include "base/trace_event/trace_event.h"
 #include "content/public/renderer/render_frame.h"
 #include "electron/buildflags/buildflags.h"
 #include "shell/common/api/electron_bindings.h"
@@ -82,14 +86,69 @@ v8::Local<v8::Value> GetBinding(v8::Isolate* isolate,
   return exports;
 }
 
-v8::Local<v8::Value> CreatePreloadScript(v8::Isolate* isolate,
-                                         v8::Local<v8::String> source) {
+// Compiles the body of a preload script into a function taking |params|,
+// consuming the code cache the browser handed out for it when there is one.
+// Returns the function along with whether the cache was used.
+v8::Local<v8::Value> CreatePreloadScript(
+    v8::Isolate* isolate,
+    v8::Local<v8::String> source,
+    const std::vector<std::string>& params,
+    gin_helper::Arguments* args) {
   auto context = isolate->GetCurrentContext();
-  auto maybe_script = v8::Script::Compile(context, source);
-  v8::Local<v8::Script> script;
-  if (!maybe_script.ToLocal(&script))
+
+  // V8 takes ownership of the CachedData but not of the buffer it points to,
+  // which must outlive the compilation.
+  std::vector<uint8_t> cache;
+  v8::Local<v8::Value> cache_value;
+  if (args->GetNext(&cache_value) && cache_value->IsArrayBufferView()) {
+    auto view = cache_value.As<v8::ArrayBufferView>();
+    cache.resize(view->ByteLength());
+    view->CopyContents(cache.data(), cache.size());
+  }
+  v8::ScriptCompiler::CachedData* cached_data = nullptr;
+  if (!cache.empty()) {
+    cached_data = new v8::ScriptCompiler::CachedData(
+        cache.data(), cache.size(),
+        v8::ScriptCompiler::CachedData::BufferNotOwned);
+  }
+
+  std::vector<v8::Local<v8::String>> param_names;
+  for (const auto& param : params)
+    param_names.push_back(gin::StringToV8(isolate, param));
+
+  v8::ScriptCompiler::Source script_source(source, cached_data);
+  auto maybe_fn = v8::ScriptCompiler::CompileFunction(
+      context, &script_source, param_names.size(), param_names.data(), 0,
+      nullptr,
+      cached_data ? v8::ScriptCompiler::kConsumeCodeCache
+                  : v8::ScriptCompiler::kNoCompileOptions);
+  v8::Local<v8::Function> fn;
+  if (!maybe_fn.ToLocal(&fn))
     return v8::Local<v8::Value>();
-  return script->Run(context).ToLocalChecked();
+
+  const char* code_cache = "miss";
+  if (cached_data)
+    code_cache = script_source.GetCachedData()->rejected ? "rejected" : "hit";
+  TRACE_EVENT_INSTANT1("electron", "CreatePreloadScript",
+                       TRACE_EVENT_SCOPE_THREAD, "code_cache", code_cache);
+
+  gin_helper::Dictionary result = gin::Dictionary::CreateEmpty(isolate);
+  result.Set("fn", fn);
+  result.Set("codeCache", code_cache);
+  return result.GetHandle();
+}
+
+// Serializes the code V8 has compiled for a preload script function so far,
+// which includes the inner functions that ran.
+v8::Local<v8::Value> CreatePreloadCodeCache(v8::Isolate* isolate,
+                                            v8::Local<v8::Function> fn) {
+  std::unique_ptr<v8::ScriptCompiler::CachedData> cached_data(
+      v8::ScriptCompiler::CreateCodeCacheForFunction(fn));
+  if (!cached_data)
+    return v8::Null(isolate);
+  auto buffer = v8::ArrayBuffer::New(isolate, cached_data->length);
+  memcpy(buffer->Data(), cached_data->data, cached_data->length);
+  return v8::Uint8Array::New(buffer, 0, cached_data->length);
 }
 
 double Uptime() {
@@ -136,6 +195,7 @@ void ElectronSandboxedRendererClient::InitializeBindings(
   gin_helper::Dictionary b(isolate, binding);
   b.SetMethod("get", GetBinding);
   b.SetMethod("createPreloadScript", CreatePreloadScript);
+  b.SetMethod("createPreloadCodeCache", CreatePreloadCodeCache);
 
   gin_helper::Dictionary process = gin::Dictionary::CreateEmpty(isolate);
   b.Set("process", process);
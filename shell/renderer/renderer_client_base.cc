@@ -34,6 +34,7 @@
 #include "shell/renderer/content_settings_observer.h"
 #include "shell/renderer/electron_api_service_impl.h"
 #include "shell/renderer/electron_autofill_agent.h"
+#include "shell/renderer/electron_render_thread_observer.h"
 #include "third_party/blink/public/common/associated_interfaces/associated_interface_registry.h"
 #include "third_party/blink/public/common/web_preferences/web_preferences.h"
 #include "third_party/blink/public/web/blink.h"
@@ -223,10 +224,12 @@ bool RendererClientBase::ShouldLoadPreload(
 
 void RendererClientBase::RenderThreadStarted() {
   auto* command_line = base::CommandLine::ForCurrentProcess();
-
-#if BUILDFLAG(ENABLE_ELECTRON_EXTENSIONS)
   auto* thread = content::RenderThread::Get();
 
+  render_thread_observer_ = std::make_unique<ElectronRenderThreadObserver>();
+  thread->AddObserver(render_thread_observer_.get());
+
+#if BUILDFLAG(ENABLE_ELECTRON_EXTENSIONS)
   extensions_client_.reset(CreateExtensionsClient());
   extensions::ExtensionsClient::Set(extensions_client_.get());
 
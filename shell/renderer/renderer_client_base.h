@@ -38,6 +38,8 @@ class ExtensionsClient;
 
 namespace electron {
 
+class ElectronRenderThreadObserver;
+
 #if BUILDFLAG(ENABLE_ELECTRON_EXTENSIONS)
 class ElectronExtensionsRendererClient;
 #endif
@@ -154,6 +156,8 @@ class RendererClientBase : public content::ContentRendererClient
   std::unique_ptr<ElectronExtensionsRendererClient> extensions_renderer_client_;
 #endif
 
+  std::unique_ptr<ElectronRenderThreadObserver> render_thread_observer_;
+
   std::string renderer_client_id_;
   // An increasing ID used for identifying an V8 context in this process.
   int64_t next_context_id_ = 0;
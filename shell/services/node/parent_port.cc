@@ -5,13 +5,16 @@
 #include "shell/services/node/parent_port.h"
 
 #include <utility>
+#include <vector>
 
 #include "base/no_destructor.h"
 #include "gin/data_object_builder.h"
 #include "gin/handle.h"
 #include "shell/browser/api/message_port.h"
 #include "shell/common/gin_helper/dictionary.h"
+#include "shell/common/gin_helper/error_thrower.h"
 #include "shell/common/gin_helper/event_emitter_caller.h"
+#include "shell/common/gin_helper/function_template_extensions.h"
 #include "shell/common/node_includes.h"
 #include "shell/common/v8_value_serializer.h"
 #include "third_party/blink/public/common/messaging/transferable_message_mojom_traits.h"
@@ -40,15 +43,34 @@ void ParentPort::Initialize(blink::MessagePortDescriptor port) {
       base::BindOnce(&ParentPort::Close, base::Unretained(this)));
 }
 
-void ParentPort::PostMessage(v8::Local<v8::Value> message_value) {
+void ParentPort::PostMessage(v8::Isolate* isolate,
+                             v8::Local<v8::Value> message_value,
+                             absl::optional<v8::Local<v8::Value>> transfer) {
   if (!connector_closed_ && connector_ && connector_->is_valid()) {
-    v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+    // Only ArrayBuffers can be transferred to the parent process.
+    std::vector<gin::Handle<MessagePort>> wrapped_ports;
+    std::vector<v8::Local<v8::ArrayBuffer>> array_buffers;
+    if (transfer && !transfer.value()->IsUndefined()) {
+      if (!MessagePort::GetTransferables(isolate, *transfer, &wrapped_ports,
+                                         &array_buffers) ||
+          !wrapped_ports.empty()) {
+        gin_helper::ErrorThrower(isolate).ThrowTypeError(
+            "Invalid value for transfer");
+        return;
+      }
+    }
+
     blink::TransferableMessage transferable_message;
-    electron::SerializeV8Value(isolate, message_value, &transferable_message);
+    if (!electron::SerializeV8Value(isolate, message_value, array_buffers,
+                                    &transferable_message)) {
+      // SerializeV8Value sets an exception.
+      return;
+    }
     mojo::Message mojo_message =
         blink::mojom::TransferableMessage::WrapAsMessage(
             std::move(transferable_message));
     connector_->Accept(&mojo_message);
+    electron::DetachArrayBuffers(isolate, array_buffers);
   }
 }
 
@@ -11,6 +11,7 @@
 #include "mojo/public/cpp/bindings/connector.h"
 #include "mojo/public/cpp/bindings/message.h"
 #include "shell/browser/event_emitter_mixin.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace v8 {
 template <class T>
@@ -50,7 +51,9 @@ class ParentPort : public gin::Wrappable<ParentPort>,
   const char* GetTypeName() override;
 
  private:
-  void PostMessage(v8::Local<v8::Value> message_value);
+  void PostMessage(v8::Isolate* isolate,
+                   v8::Local<v8::Value> message_value,
+                   absl::optional<v8::Local<v8::Value>> transfer);
   void Close();
   void Start();
   void Pause();
@@ -4375,6 +4375,100 @@ describe('BrowserWindow module', () => {
       w.loadFile(path.join(fixtures, 'api', 'frame-subscriber.html'));
     });
 
+    it('subscribes to frame updates in I420', (done) => {
+      const w = new BrowserWindow({ show: false });
+      let called = false;
+      w.loadFile(path.join(fixtures, 'api', 'frame-subscriber.html'));
+      w.webContents.on('dom-ready', () => {
+        w.webContents.beginFrameSubscription({ pixelFormat: 'i420' }, (frame: any) => {
+          // This callback might be called twice.
+          if (called) return;
+          called = true;
+
+          try {
+            expect(frame.pixelFormat).to.equal('i420');
+            expect(frame.planes).to.have.lengthOf(3);
+            const chromaWidth = Math.ceil(frame.width / 2);
+            const chromaHeight = Math.ceil(frame.height / 2);
+            expect(frame.planes[0].stride).to.equal(frame.width);
+            expect(frame.planes[0].data).to.be.an.instanceOf(Buffer).with.lengthOf(frame.width * frame.height);
+            expect(frame.planes[1].data).to.have.lengthOf(chromaWidth * chromaHeight);
+            expect(frame.planes[2].data).to.have.lengthOf(chromaWidth * chromaHeight);
+            done();
+          } catch (e) {
+            done(e);
+          } finally {
+            w.webContents.endFrameSubscription();
+          }
+        });
+      });
+    });
+
+    it('subscribes to frame updates in NV12', (done) => {
+      const w = new BrowserWindow({ show: false });
+      let called = false;
+      w.loadFile(path.join(fixtures, 'api', 'frame-subscriber.html'));
+      w.webContents.on('dom-ready', () => {
+        w.webContents.beginFrameSubscription({ pixelFormat: 'nv12' }, (frame: any) => {
+          // This callback might be called twice.
+          if (called) return;
+          called = true;
+
+          try {
+            expect(frame.pixelFormat).to.equal('nv12');
+            expect(frame.planes).to.have.lengthOf(2);
+            const uvStride = Math.ceil(frame.width / 2) * 2;
+            expect(frame.planes[1].stride).to.equal(uvStride);
+            expect(frame.planes[1].data).to.have.lengthOf(uvStride * Math.ceil(frame.height / 2));
+            done();
+          } catch (e) {
+            done(e);
+          } finally {
+            w.webContents.endFrameSubscription();
+          }
+        });
+      });
+    });
+
+    it('subscribes to encoded frames', (done) => {
+      const w = new BrowserWindow({ show: false });
+      let called = false;
+      w.loadFile(path.join(fixtures, 'api', 'frame-subscriber.html'));
+      w.webContents.on('dom-ready', () => {
+        w.webContents.beginFrameSubscription({ codec: 'vp8' }, (frame: any) => {
+          // This callback might be called twice.
+          if (called) return;
+          called = true;
+
+          try {
+            expect(frame.keyFrame).to.be.true('first frame is not a key frame');
+            expect(frame.data).to.be.an.instanceOf(Buffer);
+            expect(frame.data.length).to.be.greaterThan(0);
+            expect(frame.timestamp).to.be.a('number');
+            done();
+          } catch (e) {
+            done(e);
+          } finally {
+            w.webContents.endFrameSubscription();
+          }
+        });
+      });
+    });
+
+    it('throws error when the codec is not supported', () => {
+      const w = new BrowserWindow({ show: false });
+      expect(() => {
+        w.webContents.beginFrameSubscription({ codec: 'h264' } as any, () => {});
+      }).to.throw(/Invalid codec: h264/);
+    });
+
+    it('throws error when the pixel format is not supported', () => {
+      const w = new BrowserWindow({ show: false });
+      expect(() => {
+        w.webContents.beginFrameSubscription({ pixelFormat: 'yuv444' } as any, () => {});
+      }).to.throw(/Invalid pixelFormat: yuv444/);
+    });
+
     it('throws error when subscriber is not well defined', () => {
       const w = new BrowserWindow({ show: false });
       expect(() => {
@@ -6115,6 +6209,31 @@ describe('BrowserWindow module', () => {
       });
     });
 
+    describe('offscreen options object', () => {
+      it('turns offscreen rendering on and creates a frameless window', async () => {
+        const c = new BrowserWindow({
+          width: 100,
+          height: 100,
+          show: false,
+          webPreferences: {
+            backgroundThrottling: false,
+            offscreen: { useSharedMemory: false }
+          }
+        });
+        expect(c.webContents.isOffscreen()).to.be.true('isOffscreen');
+        expect(c.getContentBounds()).to.deep.equal(c.getBounds());
+        const paint = once(c.webContents, 'paint');
+        c.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+        const [,, image] = await paint;
+        expect(image.isEmpty()).to.be.false('image is empty');
+        c.destroy();
+      });
+
+      it('is frameless like the boolean form', () => {
+        expect(w.getContentBounds()).to.deep.equal(w.getBounds());
+      });
+    });
+
     describe('window.webContents.isPainting()', () => {
       it('returns whether is currently painting', async () => {
         const paint = once(w.webContents, 'paint');
@@ -6184,6 +6303,135 @@ describe('BrowserWindow module', () => {
         expect(w.webContents.frameRate).to.equal(30);
       });
     });
+
+    describe('useSharedMemory option', () => {
+      let sw: BrowserWindow;
+      beforeEach(() => {
+        sw = new BrowserWindow({
+          width: 100,
+          height: 100,
+          show: false,
+          webPreferences: {
+            backgroundThrottling: false,
+            offscreen: { useSharedMemory: true }
+          }
+        });
+      });
+
+      it('passes frames as an OffscreenFrame', async () => {
+        const paint = once(sw.webContents, 'paint');
+        sw.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+        const [,, image, frame] = await paint;
+        expect(sw.webContents.isOffscreen()).to.be.true('isOffscreen');
+        expect(image.isEmpty()).to.be.true('image is empty');
+        const { scaleFactor } = screen.getPrimaryDisplay();
+        expect(frame.width).to.be.closeTo(100 * scaleFactor, 2);
+        expect(frame.height).to.be.closeTo(100 * scaleFactor, 2);
+        expect(frame.rowBytes).to.be.at.least(frame.width * 4);
+        expect(frame.pixelFormat).to.be.oneOf(['bgra', 'rgba']);
+        expect(frame.getNativeHandle()).to.be.an.instanceOf(Buffer);
+        const pixels = new Uint8Array(frame.rowBytes * frame.height);
+        frame.copyTo(pixels);
+        expect(pixels.some(byte => byte !== 0)).to.be.true('pixels are empty');
+        frame.release();
+      });
+
+      it('throws when a released frame is used', async () => {
+        const paint = once(sw.webContents, 'paint');
+        sw.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+        const [,,, frame] = await paint;
+        frame.release();
+        expect(() => frame.getNativeHandle()).to.throw(/The frame has been released/);
+        expect(() => frame.copyTo(new Uint8Array(frame.rowBytes * frame.height))).to.throw(/The frame has been released/);
+      });
+
+      it('throws when the target is too small', async () => {
+        const paint = once(sw.webContents, 'paint');
+        sw.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+        const [,,, frame] = await paint;
+        expect(() => frame.copyTo(new Uint8Array(16))).to.throw(/target is smaller than the frame/);
+        frame.release();
+      });
+
+      it('copies only the pixels of a rect', async () => {
+        const paint = once(sw.webContents, 'paint');
+        sw.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+        const [,,, frame] = await paint;
+        const rect = { x: 1, y: 1, width: 10, height: 10 };
+        const pixels = new Uint8Array(rect.width * rect.height * 4);
+        frame.copyTo(pixels, rect);
+        expect(pixels.some(byte => byte !== 0)).to.be.true('pixels are empty');
+        expect(() => frame.copyTo(new Uint8Array(16), rect)).to.throw(/target is smaller than rect/);
+        expect(() => frame.copyTo(pixels, { x: 0, y: 0, width: frame.width + 1, height: 1 })).to.throw(/within the frame/);
+        frame.release();
+      });
+    });
+
+    it('counts the frames painted', async () => {
+      const paint = once(w.webContents, 'paint');
+      w.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+      await paint;
+      const stats = w.webContents.getFrameStats()!;
+      expect(stats.framesDelivered).to.be.at.least(1);
+      expect(stats.framesCaptured).to.be.at.least(stats.framesDelivered);
+      expect(stats.framesDropped).to.be.at.least(0);
+      expect(stats.consumerLatency).to.be.at.least(0);
+      expect(stats.frameRate).to.be.greaterThan(0);
+      // The capture period is kept in whole microseconds.
+      expect(stats.frameRate).to.be.at.most(w.webContents.getFrameRate() + 1);
+    });
+
+    it('keeps the frame rate for handlers that release frames right away', async () => {
+      const aw = new BrowserWindow({
+        width: 100,
+        height: 100,
+        show: false,
+        webPreferences: {
+          backgroundThrottling: false,
+          offscreen: { useSharedMemory: true, adaptiveFrameRate: true }
+        }
+      });
+      let frames = 0;
+      const painted = new Promise<void>(resolve => {
+        aw.webContents.on('paint', (event, dirty, image, frame) => {
+          frame.release();
+          if (++frames === 30) resolve();
+        });
+      });
+      await aw.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+      aw.webContents.executeJavaScript(`(function animate (n) {
+        document.body.style.backgroundColor = n % 2 ? 'red' : 'blue';
+        requestAnimationFrame(() => animate(n + 1));
+      })(0)`);
+      await painted;
+      const stats = aw.webContents.getFrameStats()!;
+      expect(stats.frameRate).to.be.closeTo(aw.webContents.getFrameRate(), 1);
+      aw.destroy();
+    });
+
+    it('does not count frames of windows that are not offscreen', () => {
+      const ow = new BrowserWindow({ show: false });
+      expect(ow.webContents.getFrameStats()).to.be.null();
+    });
+
+    describe('dirtyRegionOnly option', () => {
+      it('passes an image of only the dirty rect', async () => {
+        const dw = new BrowserWindow({
+          width: 100,
+          height: 100,
+          show: false,
+          webPreferences: {
+            backgroundThrottling: false,
+            offscreen: { dirtyRegionOnly: true }
+          }
+        });
+        const paint = once(dw.webContents, 'paint');
+        dw.loadFile(path.join(fixtures, 'api', 'offscreen-rendering.html'));
+        const [, dirtyRect, image] = await paint;
+        expect(image.getSize()).to.deep.equal({ width: dirtyRect.width, height: dirtyRect.height });
+        expect(image.toBitmap().length).to.equal(dirtyRect.width * dirtyRect.height * 4);
+      });
+    });
   });
 
   describe('"transparent" option', () => {
@@ -428,6 +428,43 @@ describe('contextBridge', () => {
         expect(result).to.deep.equal([123, 123, 123]);
       });
 
+      it('should reuse the proxy of a function sent more than once', async () => {
+        await makeBindingWindow(() => {
+          const fn = () => 123;
+          const promise = Promise.resolve(456);
+          contextBridge.exposeInMainWorld('example', {
+            getFunction: () => fn,
+            getPromise: () => promise
+          });
+        });
+        const result = await callWithBindings(async (root: any) => {
+          const fn = root.example.getFunction();
+          const promise = root.example.getPromise();
+          return [fn === root.example.getFunction(), fn(), promise === root.example.getPromise(), await promise];
+        });
+        expect(result).to.deep.equal([true, 123, true, 456]);
+      });
+
+      it('should reuse the proxy of a function sent to more than one world', async () => {
+        await makeBindingWindow(() => {
+          const fn = () => 123;
+          const api = { getFunction: () => fn };
+          contextBridge.exposeInMainWorld('example', api);
+          contextBridge.exposeInIsolatedWorld(1004, 'example', api);
+        }, 1004);
+        await callWithBindings((root: any) => {
+          root.savedFunction = root.example.getFunction();
+        }, 1004);
+        await callWithBindings((root: any) => {
+          root.savedFunction = root.example.getFunction();
+        });
+        const result = await Promise.all([
+          callWithBindings((root: any) => root.savedFunction === root.example.getFunction(), 1004),
+          callWithBindings((root: any) => root.savedFunction === root.example.getFunction())
+        ]);
+        expect(result).to.deep.equal([true, true]);
+      });
+
       it('should proxy methods in the reverse direction', async () => {
         await makeBindingWindow(() => {
           contextBridge.exposeInMainWorld('example', {
@@ -581,6 +618,56 @@ describe('contextBridge', () => {
         expect(result).to.deep.equal([true, true]);
       });
 
+      it('should share the memory of typed arrays marked with shareArrayBuffer', async () => {
+        await makeBindingWindow(() => {
+          const buffer = new Uint8Array(4);
+          contextBridge.exposeInMainWorld('example', {
+            getBuffer: () => contextBridge.shareArrayBuffer(buffer),
+            read: () => Array.from(buffer)
+          });
+        });
+        const result = await callWithBindings((root: any) => {
+          const buffer = root.example.getBuffer();
+          buffer[1] = 42;
+          return [Object.getPrototypeOf(buffer) === Uint8Array.prototype, root.example.read()];
+        });
+        expect(result).to.deep.equal([true, [0, 42, 0, 0]]);
+      });
+
+      it('should move the memory of typed arrays marked with transferArrayBuffer', async () => {
+        await makeBindingWindow(() => {
+          const buffer = contextBridge.transferArrayBuffer(new Uint16Array([1, 2, 3, 4]));
+          const view = buffer.subarray(1);
+          contextBridge.exposeInMainWorld('example', {
+            getBuffer: () => view,
+            getSourceLength: () => view.length
+          });
+        });
+        const result = await callWithBindings((root: any) => {
+          const buffer = root.example.getBuffer();
+          return [Object.getPrototypeOf(buffer) === Uint16Array.prototype, Array.from(buffer), root.example.getSourceLength()];
+        });
+        expect(result).to.deep.equal([true, [2, 3, 4], 0]);
+      });
+
+      it('should not share or transfer views of part of a buffer', async () => {
+        await makeBindingWindow(() => {
+          const view = new Uint8Array(8).subarray(2, 4);
+          const errors = [];
+          for (const mark of [contextBridge.shareArrayBuffer, contextBridge.transferArrayBuffer]) {
+            try {
+              mark(view);
+            } catch (error) {
+              errors.push((error as Error).message);
+            }
+          }
+          contextBridge.exposeInMainWorld('example', { errors });
+        });
+        const result = await callWithBindings((root: any) => root.example.errors);
+        expect(result).to.have.lengthOf(2);
+        for (const message of result) expect(message).to.match(/Only views of a whole ArrayBuffer/);
+      });
+
       it('should handle recursive objects', async () => {
         await makeBindingWindow(() => {
           const o: any = { value: 135 };
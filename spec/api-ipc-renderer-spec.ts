@@ -1,7 +1,9 @@
 import { expect } from 'chai';
+import * as cp from 'node:child_process';
 import * as path from 'node:path';
 import { ipcMain, BrowserWindow, WebContents, WebPreferences, webContents } from 'electron/main';
 import { closeWindow } from './lib/window-helpers';
+import { repeatedly } from './lib/spec-helpers';
 import { once } from 'node:events';
 
 describe('ipcRenderer module', () => {
@@ -113,6 +115,89 @@ describe('ipcRenderer module', () => {
       expect(childValue.hello).to.equal('world');
       expect(childValue.child).to.equal(childValue);
     });
+
+    const collectMessages = (count: number) => new Promise<[Electron.IpcMainEvent, any][]>(resolve => {
+      const received: [Electron.IpcMainEvent, any][] = [];
+      const listener = (event: Electron.IpcMainEvent, value: any) => {
+        received.push([event, value]);
+        if (received.length === count) {
+          ipcMain.removeListener('message', listener);
+          resolve(received);
+        }
+      };
+      ipcMain.on('message', listener);
+    });
+
+    it('delivers messages sent in one task in order', async () => {
+      const received: any[] = [];
+      const listener = (event: Electron.IpcMainEvent, value: any) => {
+        received.push(value);
+      };
+      ipcMain.on('message', listener);
+      ipcMain.once('sync', (event) => {
+        received.push('sync');
+        event.returnValue = null;
+      });
+      const messages = collectMessages(2000);
+      w.webContents.executeJavaScript(`{
+        const { ipcRenderer } = require('electron')
+        for (let i = 0; i < 3; i++) ipcRenderer.send('message', i)
+        ipcRenderer.sendSync('sync')
+        for (let i = 3; i < 2000; i++) ipcRenderer.send('message', i)
+      }`);
+      await messages;
+      ipcMain.removeListener('message', listener);
+      expect(received).to.deep.equal([0, 1, 2, 'sync', ...Array.from({ length: 1997 }, (_, i) => i + 3)]);
+    });
+
+    it('delivers messages sent from different worlds in one task in order', async () => {
+      const isolated = new BrowserWindow({
+        show: false,
+        webPreferences: {
+          nodeIntegration: true,
+          contextIsolation: true,
+          preload: path.join(fixtures, 'module', 'preload-ipc-send.js')
+        }
+      });
+      try {
+        await isolated.loadURL('about:blank');
+        const messages = collectMessages(100);
+        isolated.webContents.executeJavaScript(`{
+          const { ipcRenderer } = require('electron')
+          for (let i = 0; i < 100; i += 2) {
+            ipcRenderer.send('message', i)
+            window.isolatedSend(i + 1)
+          }
+        }`);
+        const received = (await messages).map(([, value]) => value);
+        expect(received).to.deep.equal(Array.from({ length: 100 }, (_, i) => i));
+      } finally {
+        await closeWindow(isolated);
+      }
+    });
+
+    it('gives every message sent in one task an event of its own', async () => {
+      const messages = collectMessages(2);
+      w.webContents.executeJavaScript(`{
+        const { ipcRenderer } = require('electron')
+        ipcRenderer.send('message', 1)
+        ipcRenderer.send('message', 2)
+      }`);
+      const [[first], [second]] = await messages;
+      expect(first).to.not.equal(second);
+      expect(first.sender).to.equal(w.webContents);
+      expect(second.sender).to.equal(w.webContents);
+    });
+
+    it('reports the throughput of batched and unbatched messages', () => {
+      const appPath = path.join(fixtures, 'apps', 'ipc-throughput', 'main.js');
+      const { stdout } = cp.spawnSync(process.execPath, [appPath, '5000']);
+      const result = JSON.parse(stdout.toString());
+      for (const mode of ['unbatched', 'batched']) {
+        expect(result[mode].inOrder).to.be.true(`${mode} messages arrived out of order`);
+        expect(result[mode].messagesPerSecond).to.be.greaterThan(0);
+      }
+    });
   });
 
   describe('sendSync()', () => {
@@ -172,6 +257,101 @@ describe('ipcRenderer module', () => {
     generateSpecs('with sandbox', { sandbox: true });
     generateSpecs('with contextIsolation', { contextIsolation: true });
     generateSpecs('with contextIsolation + sandbox', { contextIsolation: true, sandbox: true });
+
+    describe('with directSendTo', () => {
+      let sender: BrowserWindow;
+      let target: WebContents;
+
+      before(async () => {
+        sender = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+        sender.webContents.directSendTo = true;
+        await sender.loadURL('about:blank');
+        target = (webContents as typeof ElectronInternal.WebContents).create({
+          preload: path.join(fixtures, 'module', 'preload-ipc-ping-pong.js')
+        });
+        target.directSendTo = true;
+        await target.loadURL('about:blank');
+      });
+
+      after(async () => {
+        target.destroy();
+        await closeWindow(sender);
+      });
+
+      it('delivers messages in order', async () => {
+        const data = await sender.webContents.executeJavaScript(`new Promise(resolve => {
+          const { ipcRenderer } = require('electron')
+          const received = []
+          ipcRenderer.on('pong', (event, i) => {
+            received.push(i)
+            if (received.length === 100) resolve(received)
+          })
+          for (let i = 0; i < 100; i++) ipcRenderer.sendTo(${target.id}, 'ping', i)
+        })`);
+        expect(data).to.deep.equal([...Array(100).keys()]);
+      });
+
+      it('delivers messages while the main process is busy', async () => {
+        await sender.webContents.executeJavaScript(`{
+          const { ipcRenderer } = require('electron')
+          window.roundTrip = new Promise(resolve => {
+            setTimeout(() => {
+              const start = performance.now()
+              ipcRenderer.once('pong', () => resolve(performance.now() - start))
+              ipcRenderer.sendTo(${target.id}, 'ping', null)
+            }, 100)
+          })
+        }`);
+        const end = Date.now() + 1000;
+        while (Date.now() < end);
+        const elapsed = await sender.webContents.executeJavaScript('window.roundTrip');
+        expect(elapsed).to.be.below(500);
+      });
+
+      const pingPong = (count: number) => sender.webContents.executeJavaScript(`new Promise(resolve => {
+        const { ipcRenderer } = require('electron')
+        const received = []
+        const onPong = (event, i) => {
+          received.push(i)
+          if (received.length === ${count}) {
+            ipcRenderer.removeListener('pong', onPong)
+            resolve(received)
+          }
+        }
+        ipcRenderer.on('pong', onPong)
+        for (let i = 0; i < ${count}; i++) ipcRenderer.sendTo(${target.id}, 'ping', i)
+      })`);
+
+      it('connects again after the target navigates', async () => {
+        expect(await pingPong(10)).to.deep.equal([...Array(10).keys()]);
+        await target.loadURL('data:text/html,<p>navigated</p>');
+        expect(await pingPong(10)).to.deep.equal([...Array(10).keys()]);
+      });
+
+      // Leaves the page unable to connect to |target| again, so it runs last.
+      it('sends through the main process in order once turned off', async () => {
+        await sender.webContents.executeJavaScript(`{
+          const { ipcRenderer } = require('electron')
+          window.received = []
+          ipcRenderer.on('pong', (event, i) => window.received.push(i))
+          for (let i = 0; i < 50; i++) ipcRenderer.sendTo(${target.id}, 'ping', i)
+        }`);
+        sender.webContents.directSendTo = false;
+        sender.webContents.clearIPCMetrics();
+        await sender.webContents.executeJavaScript(`new Promise(resolve => {
+          const { ipcRenderer } = require('electron')
+          ipcRenderer.on('pong', () => { if (window.received.length === 100) resolve() })
+          for (let i = 50; i < 100; i++) ipcRenderer.sendTo(${target.id}, 'ping', i)
+        })`);
+        expect(await sender.webContents.executeJavaScript('window.received')).to.deep.equal([...Array(100).keys()]);
+        // The renderer learns that the connection was closed asynchronously,
+        // so only the messages after that are counted.
+        await repeatedly(async () => {
+          await pingPong(1);
+          return sender.webContents.getIPCMetrics().some(({ channel }) => channel === 'ping');
+        });
+      });
+    });
   });
 
   describe('ipcRenderer.on', () => {
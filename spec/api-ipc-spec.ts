@@ -1,6 +1,6 @@
 import { EventEmitter, once } from 'node:events';
 import { expect } from 'chai';
-import { BrowserWindow, ipcMain, IpcMainInvokeEvent, MessageChannelMain, WebContents } from 'electron/main';
+import { BrowserWindow, ipcMain, IpcMainInvokeEvent, MessageChannelMain, nativeImage, WebContents } from 'electron/main';
 import { closeAllWindows } from './lib/window-helpers';
 import { defer, listen } from './lib/spec-helpers';
 import * as path from 'node:path';
@@ -103,6 +103,88 @@ describe('ipc module', () => {
       await done;
     });
 
+    it('answers invokes of channels without a handler without entering JavaScript', async () => {
+      let emitted = false;
+      const listener = () => { emitted = true; };
+      w.webContents.on('-ipc-invoke' as any, listener);
+      defer(() => w.webContents.removeListener('-ipc-invoke' as any, listener));
+      const done = once(ipcMain, 'result');
+      await w.webContents.executeJavaScript(`(${rendererInvoke})()`);
+      const [, { error }] = await done;
+      expect(error).to.match(/No handler registered for 'test'/);
+      expect(emitted).to.be.false();
+    });
+
+    it('passes the sender of the invoke to the handler', async () => {
+      const handled = new Promise<IpcMainInvokeEvent>(resolve => ipcMain.handleOnce('test', (e: IpcMainInvokeEvent) => {
+        resolve(e);
+        return 3;
+      }));
+      const done = once(ipcMain, 'result');
+      await w.webContents.executeJavaScript(`(${rendererInvoke})()`);
+      const [, arg] = await done;
+      expect(arg).to.deep.equal({ result: 3 });
+      const event = await handled;
+      expect(event.sender).to.equal(w.webContents);
+      expect(event.processId).to.equal(w.webContents.mainFrame.processId);
+      expect(event.frameId).to.equal(w.webContents.mainFrame.routingId);
+      expect(event.senderFrame).to.equal(w.webContents.mainFrame);
+    });
+
+    describe('in a worker', () => {
+      const modulePath = path.join(__dirname, 'fixtures', 'api', 'ipc-main-worker', 'handlers.js');
+
+      async function rendererInvokeChannel (channel: string, ...args: any[]) {
+        const { ipcRenderer } = require('electron');
+        try {
+          return { result: await ipcRenderer.invoke(channel, ...args) };
+        } catch (e) {
+          return { error: (e as Error).message };
+        }
+      }
+
+      it('runs the handler off the main thread', async () => {
+        ipcMain.handleInWorker('worker-info', modulePath);
+        defer(() => ipcMain.removeHandler('worker-info'));
+        const { result } = await w.webContents.executeJavaScript(`(${rendererInvokeChannel})('worker-info', { some: 'arg' })`);
+        expect(result.isMainThread).to.be.false();
+        expect(result.channel).to.equal('worker-info');
+        expect(result.senderId).to.equal(w.webContents.id);
+        expect(result.arg).to.deep.equal({ some: 'arg' });
+      });
+
+      it('does not block the main thread', async () => {
+        ipcMain.handleInWorker('worker-busy', modulePath);
+        defer(() => ipcMain.removeHandler('worker-busy'));
+        const invoked = w.webContents.executeJavaScript(`(${rendererInvokeChannel})('worker-busy', 1000)`);
+        let ticks = 0;
+        const interval = setInterval(() => { ticks++; }, 10);
+        defer(() => clearInterval(interval));
+        expect(await invoked).to.deep.equal({ result: 1000 });
+        expect(ticks).to.be.greaterThan(10);
+      });
+
+      it('receives an error from the handler', async () => {
+        ipcMain.handleInWorker('worker-error', modulePath);
+        defer(() => ipcMain.removeHandler('worker-error'));
+        const { error } = await w.webContents.executeJavaScript(`(${rendererInvokeChannel})('worker-error')`);
+        expect(error).to.match(/some worker error/);
+      });
+
+      it('stops handling the channel when the handler is removed', async () => {
+        ipcMain.handleInWorker('worker-info', modulePath);
+        ipcMain.removeHandler('worker-info');
+        const { error } = await w.webContents.executeJavaScript(`(${rendererInvokeChannel})('worker-info')`);
+        expect(error).to.match(/No handler registered for 'worker-info'/);
+      });
+
+      it('forbids a second handler', () => {
+        ipcMain.handle('worker-info', () => {});
+        defer(() => ipcMain.removeHandler('worker-info'));
+        expect(() => ipcMain.handleInWorker('worker-info', modulePath)).to.throw(/second handler/);
+      });
+    });
+
     it('forbids multiple handlers', async () => {
       ipcMain.handle('test', () => { });
       try {
@@ -200,6 +282,196 @@ describe('ipc module', () => {
     });
   });
 
+  describe('sendSyncWithOptions', () => {
+    let w: BrowserWindow;
+
+    before(async () => {
+      w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+    });
+    after(async () => {
+      w.destroy();
+    });
+    afterEach(() => {
+      ipcMain.removeAllListeners('test-sync');
+      ipcMain.removeAllListeners('test-async');
+    });
+
+    it('returns the reply sent before the timeout', async () => {
+      ipcMain.on('test-sync', (e, arg) => { e.returnValue = arg * 2; });
+      const result = await w.webContents.executeJavaScript('require(\'electron\').ipcRenderer.sendSyncWithOptions(\'test-sync\', { timeout: 10000 }, 21)');
+      expect(result).to.equal(42);
+    });
+
+    it('throws when the reply is not sent before the timeout', async () => {
+      ipcMain.on('test-sync', (e) => { setTimeout(() => { e.returnValue = 'late'; }, 1000); });
+      const error = await w.webContents.executeJavaScript(`(${function () {
+        try {
+          require('electron').ipcRenderer.sendSyncWithOptions('test-sync', { timeout: 100 });
+        } catch (error) {
+          return (error as Error).message;
+        }
+      }})()`);
+      expect(error).to.match(/sendSync for 'test-sync' timed out after 100 ms/);
+    });
+
+    it('times out while the main process is busy', async () => {
+      ipcMain.on('test-sync', (e) => {
+        const end = Date.now() + 1000;
+        while (Date.now() < end);
+        e.returnValue = 'late';
+      });
+      const blocked = await w.webContents.executeJavaScript(`(${function () {
+        const start = Date.now();
+        try {
+          require('electron').ipcRenderer.sendSyncWithOptions('test-sync', { timeout: 100 });
+        } catch {
+          return Date.now() - start;
+        }
+      }})()`);
+      expect(blocked).to.be.a('number').that.is.below(1000);
+    });
+
+    it('rejects invalid options', async () => {
+      const error = await w.webContents.executeJavaScript(`(${function () {
+        try {
+          require('electron').ipcRenderer.sendSyncWithOptions('test-sync', { priority: 'urgent' });
+        } catch (error) {
+          return (error as Error).message;
+        }
+      }})()`);
+      expect(error).to.match(/priority must be 'normal' or 'high'/);
+    });
+
+    it('emits ipc-message-sync-slow for calls over the threshold', async () => {
+      w.webContents.syncIPCWarningThreshold = 50;
+      ipcMain.on('test-sync', (e) => { setTimeout(() => { e.returnValue = null; }, 100); });
+      const slow = once(w.webContents, 'ipc-message-sync-slow');
+      await w.webContents.executeJavaScript('require(\'electron\').ipcRenderer.sendSync(\'test-sync\')');
+      const [, details] = await slow;
+      expect(details.channel).to.equal('test-sync');
+      expect(details.blockedTime).to.be.at.least(50);
+      expect(details.timedOut).to.be.false();
+      w.webContents.syncIPCWarningThreshold = 100;
+    });
+
+    it('handles high priority calls ahead of queued messages', async () => {
+      const received: number[] = [];
+      let receivedBeforeSync = -1;
+      ipcMain.on('test-async', (e, i) => { received.push(i); });
+      ipcMain.on('test-sync', (e) => { receivedBeforeSync = received.length; e.returnValue = null; });
+      const done = new Promise<void>(resolve => ipcMain.once('done', () => { resolve(); }));
+      w.webContents.executeJavaScript(`(${function () {
+        const { ipcRenderer } = require('electron');
+        for (let i = 0; i < 100; i++) ipcRenderer.send('test-async', i);
+        ipcRenderer.sendSyncWithOptions('test-sync', { priority: 'high' });
+        ipcRenderer.send('done');
+      }})()`);
+      await done;
+      expect(receivedBeforeSync).to.equal(0);
+      expect(received).to.deep.equal([...Array(100).keys()]);
+    });
+  });
+
+  describe('ipcMain.setLazyDeserialization', () => {
+    let w: BrowserWindow;
+
+    before(async () => {
+      w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+    });
+    after(async () => {
+      w.destroy();
+    });
+    afterEach(() => {
+      ipcMain.setLazyDeserialization('test-large', false);
+      ipcMain.removeAllListeners('test-large');
+      w.webContents.ipc.removeAllListeners('test-large');
+    });
+
+    const sendLarge = (size: number) => w.webContents.executeJavaScript(`require('electron').ipcRenderer.send('test-large', { data: 'x'.repeat(${size}) }, 42)`);
+
+    it('passes large messages as a SerializedMessage', async () => {
+      ipcMain.setLazyDeserialization('test-large', true);
+      const received = once(ipcMain, 'test-large');
+      sendLarge(128 * 1024);
+      const [, message, ...rest] = await received;
+      expect(rest).to.be.empty();
+      expect(message.byteLength).to.be.at.least(128 * 1024);
+      expect(message.args).to.have.lengthOf(2);
+      expect(message.args[0].data).to.have.lengthOf(128 * 1024);
+      expect(message.args[1]).to.equal(42);
+      expect(message.args).to.equal(message.args);
+    });
+
+    it('passes small messages as usual', async () => {
+      ipcMain.setLazyDeserialization('test-large', true);
+      const received = once(ipcMain, 'test-large');
+      sendLarge(16);
+      const [, arg, number] = await received;
+      expect(arg.data).to.have.lengthOf(16);
+      expect(number).to.equal(42);
+    });
+
+    it('decodes large messages for other listeners', async () => {
+      ipcMain.setLazyDeserialization('test-large', true);
+      const lazy = once(ipcMain, 'test-large');
+      const eager = once(w.webContents.ipc, 'test-large');
+      sendLarge(128 * 1024);
+      const [[, message], [, arg, number]] = await Promise.all([lazy, eager]);
+      expect(arg.data).to.have.lengthOf(128 * 1024);
+      expect(number).to.equal(42);
+      expect(message.args[0]).to.equal(arg);
+    });
+
+    it('forwards a SerializedMessage as the arguments it holds', async () => {
+      ipcMain.setLazyDeserialization('test-large', true);
+      ipcMain.once('test-large', (event, message) => {
+        w.webContents.forward('test-forwarded', message);
+      });
+      const forwarded = w.webContents.executeJavaScript(`new Promise(resolve => {
+        require('electron').ipcRenderer.once('test-forwarded', (event, arg, number) => resolve([arg.data.length, number]));
+      })`);
+      sendLarge(128 * 1024);
+      expect(await forwarded).to.deep.equal([128 * 1024, 42]);
+    });
+
+    it('does not forward a SerializedMessage passed to send', async () => {
+      ipcMain.setLazyDeserialization('test-large', true);
+      const received = once(ipcMain, 'test-large');
+      sendLarge(128 * 1024);
+      const [, message] = await received;
+      expect(() => (w.webContents.mainFrame as any)._send(false, 'test-forwarded', [message])).to.throw();
+    });
+
+    it('tells a SerializedMessage apart from other arguments', async () => {
+      ipcMain.setLazyDeserialization('test-large', true);
+      const received: any[] = [];
+      ipcMain.on('test-large', (event, ...args) => { received.push(args); });
+      const done = new Promise<void>(resolve => {
+        ipcMain.on('test-large', () => { if (received.length === 3) resolve(); });
+      });
+      w.webContents.executeJavaScript(`(${function () {
+        const { ipcRenderer } = require('electron');
+        ipcRenderer.send('test-large', 42);
+        ipcRenderer.send('test-large', new ArrayBuffer(16));
+        ipcRenderer.send('test-large', { data: 'x'.repeat(128 * 1024) });
+      }})()`);
+      await done;
+      const [[number], [buffer], [message]] = received;
+      expect(ipcMain.isSerializedMessage(number)).to.be.false();
+      expect(ipcMain.isSerializedMessage(buffer)).to.be.false();
+      expect(buffer.byteLength).to.equal(16);
+      expect(ipcMain.isSerializedMessage(message)).to.be.true();
+      expect(w.webContents.ipc.isSerializedMessage(message)).to.be.true();
+      expect(ipcMain.isSerializedMessage(undefined)).to.be.false();
+    });
+
+    it('only forwards a SerializedMessage', () => {
+      expect(() => w.webContents.forward('test-forwarded', [{ data: 'x' }] as any)).to.throw(/Expected a SerializedMessage/);
+    });
+  });
+
   describe('MessagePort', () => {
     afterEach(closeAllWindows);
 
@@ -358,8 +630,7 @@ describe('ipc module', () => {
         const { port1 } = new MessageChannelMain();
 
         expect(() => {
-          const buffer = new ArrayBuffer(10) as any;
-          port1.postMessage(null, [buffer]);
+          port1.postMessage(null, [{} as any]);
         }).to.throw(/Port at index 0 is not a valid port/);
 
         expect(() => {
@@ -387,6 +658,61 @@ describe('ipc module', () => {
         expect(ev.data).to.equal('hello');
       });
 
+      it('transfers ArrayBuffers', async () => {
+        const { port1, port2 } = new MessageChannelMain();
+        // Large enough to be passed in shared memory.
+        const buffer = new Uint8Array(1024 * 1024).map((_, i) => i % 251).buffer;
+        const expected = Buffer.from(buffer.slice(0));
+        port2.postMessage({ buffer }, [buffer as any]);
+        expect(buffer.byteLength).to.equal(0);
+        port1.start();
+        const [ev] = await once(port1, 'message');
+        expect(ev.data.buffer).to.be.an.instanceOf(ArrayBuffer);
+        expect(Buffer.from(ev.data.buffer).equals(expected)).to.be.true();
+      });
+
+      it('passes NativeImages', async () => {
+        const { port1, port2 } = new MessageChannelMain();
+        const bitmap = Buffer.alloc(512 * 512 * 4).map((_, i) => i % 251);
+        const image = nativeImage.createFromBitmap(bitmap, { width: 512, height: 512 });
+        port2.postMessage({ image });
+        port1.start();
+        const [ev] = await once(port1, 'message');
+        expect(ev.data.image.getSize()).to.deep.equal({ width: 512, height: 512 });
+        expect(ev.data.image.toBitmap().equals(image.toBitmap())).to.be.true();
+      });
+
+      it('passes every representation of NativeImages', async () => {
+        const { port1, port2 } = new MessageChannelMain();
+        const image = nativeImage.createEmpty();
+        image.addRepresentation({ scaleFactor: 1, width: 2, height: 2, buffer: Buffer.alloc(2 * 2 * 4, 0x40) });
+        image.addRepresentation({ scaleFactor: 2, width: 4, height: 4, buffer: Buffer.alloc(4 * 4 * 4, 0x80) });
+        port2.postMessage(image);
+        port1.start();
+        const [ev] = await once(port1, 'message');
+        expect(ev.data.getScaleFactors()).to.deep.equal([1, 2]);
+        expect(ev.data.toBitmap({ scaleFactor: 2 }).equals(image.toBitmap({ scaleFactor: 2 }))).to.be.true();
+      });
+
+      it('throws when transferring an ArrayBuffer twice', () => {
+        const { port1 } = new MessageChannelMain();
+        const buffer = new ArrayBuffer(8);
+        expect(() => {
+          port1.postMessage(null, [buffer as any, buffer as any]);
+        }).to.throw(/ArrayBuffer at index 1 is a duplicate/);
+        expect(buffer.byteLength).to.equal(8);
+      });
+
+      it('leaves ArrayBuffers attached when a port can not be transferred', () => {
+        const { port1 } = new MessageChannelMain();
+        const { port1: other } = new MessageChannelMain();
+        const buffer = new ArrayBuffer(8);
+        expect(() => {
+          port1.postMessage(null, [buffer as any, other, other]);
+        }).to.throw(/Port at index 1 is a duplicate/);
+        expect(buffer.byteLength).to.equal(8);
+      });
+
       it('can pass one end to a WebContents', async () => {
         const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
         w.loadURL('about:blank');
@@ -508,6 +834,38 @@ describe('ipc module', () => {
           expect(msg).to.deep.equal({ some: 'message' });
         });
 
+        it('transfers ArrayBuffers', async () => {
+          const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+          w.loadURL('about:blank');
+          await w.webContents.executeJavaScript(`(${function () {
+            const { ipcRenderer } = require('electron');
+            ipcRenderer.on('foo', (_e, msg) => {
+              ipcRenderer.send('bar', Array.from(new Uint8Array(msg)));
+            });
+          }})()`);
+          const buffer = new Uint8Array([1, 2, 3]).buffer;
+          postMessage(w.webContents)('foo', buffer, [buffer as any]);
+          expect(buffer.byteLength).to.equal(0);
+          const [, msg] = await once(ipcMain, 'bar');
+          expect(msg).to.deep.equal([1, 2, 3]);
+        });
+
+        it('passes NativeImages', async () => {
+          const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+          w.loadURL('about:blank');
+          await w.webContents.executeJavaScript(`(${function () {
+            const { ipcRenderer } = require('electron');
+            ipcRenderer.on('foo', (_e, image) => {
+              ipcRenderer.send('bar', image.getSize(), image.toDataURL());
+            });
+          }})()`);
+          const image = nativeImage.createFromBitmap(Buffer.alloc(256 * 256 * 4, 0xff), { width: 256, height: 256 });
+          postMessage(w.webContents)('foo', image);
+          const [, size, dataURL] = await once(ipcMain, 'bar');
+          expect(size).to.deep.equal({ width: 256, height: 256 });
+          expect(dataURL).to.equal(image.toDataURL());
+        });
+
         describe('error handling', () => {
           it('throws on missing channel', async () => {
             const w = new BrowserWindow({ show: false });
@@ -0,0 +1,152 @@
+import { expect } from 'chai';
+import { BrowserWindow, ipcMain, MessageChannelMain, sharedRingBuffer, utilityProcess } from 'electron/main';
+import { once } from 'node:events';
+import * as path from 'node:path';
+import { closeAllWindows } from './lib/window-helpers';
+
+describe('sharedRingBuffer module', () => {
+  describe('create()', () => {
+    it('rounds the capacity up to a power of two', () => {
+      expect(sharedRingBuffer.create(1).capacity).to.equal(4096);
+      expect(sharedRingBuffer.create(5000).capacity).to.equal(8192);
+      expect(sharedRingBuffer.create(65536).capacity).to.equal(65536);
+    });
+
+    it('throws on invalid capacities', () => {
+      expect(() => sharedRingBuffer.create(0)).to.throw(/capacity must be between/);
+      expect(() => sharedRingBuffer.create(128 * 1024 * 1024)).to.throw(/capacity must be between/);
+    });
+  });
+
+  describe('SharedRingBuffer', () => {
+    it('reads records in the order they were written', () => {
+      const ring = sharedRingBuffer.create(4096);
+      expect(ring.read()).to.be.null();
+      expect(ring.write(new Uint8Array([1, 2, 3]))).to.be.true();
+      expect(ring.write(new Uint16Array([4]).buffer)).to.be.true();
+      expect(ring.write(Buffer.alloc(0))).to.be.true();
+      expect([...ring.read()!]).to.deep.equal([1, 2, 3]);
+      expect(ring.read()!.byteLength).to.equal(2);
+      expect(ring.read()!.byteLength).to.equal(0);
+      expect(ring.read()).to.be.null();
+    });
+
+    it('returns false when full, and wraps around once read', () => {
+      const ring = sharedRingBuffer.create(4096);
+      const record = new Uint8Array(1000);
+      let written = 0;
+      while (ring.write(record.fill(written))) written++;
+      expect(written).to.equal(4);
+      expect(ring.read()![0]).to.equal(0);
+      expect(ring.write(record.fill(4))).to.be.true();
+      const rest = [];
+      for (let data = ring.read(); data; data = ring.read()) rest.push(data[999]);
+      expect(rest).to.deep.equal([1, 2, 3, 4]);
+    });
+
+    it('throws on records larger than the ring', () => {
+      const ring = sharedRingBuffer.create(4096);
+      expect(() => ring.write(new Uint8Array(4096))).to.throw(/larger than the ring buffer/);
+      expect(() => ring.write('hello' as any)).to.throw(/must be an ArrayBuffer/);
+    });
+
+    it('calls the wake up handler once the reader has drained the ring', () => {
+      const ring = sharedRingBuffer.create(4096);
+      let wakeUps = 0;
+      ring.setWakeUpHandler(() => { wakeUps++; });
+      ring.write(new Uint8Array([1]));
+      ring.write(new Uint8Array([2]));
+      expect(wakeUps).to.equal(1);
+      const records: number[] = [];
+      expect(ring.drain((record) => { records.push(record[0]); })).to.equal(2);
+      expect(records).to.deep.equal([1, 2]);
+      ring.write(new Uint8Array([3]));
+      expect(wakeUps).to.equal(2);
+    });
+
+    it('can only be sent with postMessage', async () => {
+      const w = new BrowserWindow({ show: false });
+      try {
+        expect(() => w.webContents.send('ring', sharedRingBuffer.create(4096))).to.throw(/An object could not be cloned/);
+      } finally {
+        w.destroy();
+      }
+    });
+  });
+
+  describe('across processes', () => {
+    afterEach(closeAllWindows);
+
+    it('streams records from a renderer', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+      await w.webContents.executeJavaScript(`(${function () {
+        const { ipcRenderer } = require('electron');
+        ipcRenderer.on('ring', (event, ring) => {
+          const [port] = event.ports;
+          ring.setWakeUpHandler(() => port.postMessage(null));
+          for (let i = 0; i < 100; i++) ring.write(new Uint32Array([i]));
+        });
+      }})()`);
+      const ring = sharedRingBuffer.create(4096);
+      const { port1, port2 } = new MessageChannelMain();
+      const received: number[] = [];
+      const done = new Promise<void>((resolve) => {
+        port1.on('message', () => {
+          ring.drain((record) => { received.push(new Uint32Array(record.buffer)[0]); });
+          if (received.length === 100) resolve();
+        });
+      });
+      port1.start();
+      w.webContents.postMessage('ring', ring, [port2]);
+      await done;
+      expect(received).to.deep.equal([...Array(100).keys()]);
+    });
+
+    it('streams records to a renderer', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+      await w.webContents.executeJavaScript(`(${function () {
+        const { ipcRenderer } = require('electron');
+        ipcRenderer.on('ring', (event, ring) => {
+          const [port] = event.ports;
+          const received: number[] = [];
+          port.onmessage = () => {
+            ring.drain((record: Uint8Array) => { received.push(record[0]); });
+            if (received.length === 10) ipcRenderer.send('received', received);
+          };
+        });
+      }})()`);
+      const ring = sharedRingBuffer.create(4096);
+      const { port1, port2 } = new MessageChannelMain();
+      ring.setWakeUpHandler(() => port1.postMessage(null));
+      w.webContents.postMessage('ring', ring, [port2]);
+      for (let i = 0; i < 10; i++) ring.write(new Uint8Array([i]));
+      const [, received] = await once(ipcMain, 'received');
+      expect(received).to.deep.equal([...Array(10).keys()]);
+    });
+
+    it('streams records from a utility process', async () => {
+      const child = utilityProcess.fork(path.join(__dirname, 'fixtures', 'api', 'utility-process', 'shared-ring-buffer.js'));
+      await once(child, 'spawn');
+      const ring = sharedRingBuffer.create(4096);
+      const { port1, port2 } = new MessageChannelMain();
+      const received: number[] = [];
+      const done = new Promise<void>((resolve) => {
+        port1.on('message', () => {
+          ring.drain((record) => { received.push(new Uint32Array(record.buffer)[0]); });
+          if (received.length === 100) resolve();
+        });
+      });
+      port1.start();
+      child.postMessage(ring, [port2]);
+      const [createType] = await once(child, 'message');
+      expect(createType).to.equal('function');
+      await done;
+      expect(received).to.deep.equal([...Array(100).keys()]);
+      const exit = once(child, 'exit');
+      child.kill();
+      await exit;
+    });
+  });
+});
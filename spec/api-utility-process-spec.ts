@@ -190,6 +190,22 @@ describe('utilityProcess module', () => {
       await exit;
     });
 
+    it('transfers ArrayBuffers in both directions', async () => {
+      const child = utilityProcess.fork(path.join(fixturesPath, 'transfer-array-buffer.js'));
+      await once(child, 'spawn');
+      const buffer = new Uint8Array(1024 * 1024).fill(7).buffer;
+      child.postMessage(buffer, [buffer]);
+      expect(buffer.byteLength).to.equal(0);
+      const [echo] = await once(child, 'message');
+      expect(echo.buffer).to.be.an.instanceOf(ArrayBuffer);
+      expect(new Uint8Array(echo.buffer).every(byte => byte === 7)).to.be.true();
+      const [{ detached }] = await once(child, 'message');
+      expect(detached).to.be.true();
+      const exit = once(child, 'exit');
+      expect(child.kill()).to.be.true();
+      await exit;
+    });
+
     it('supports queuing messages on the receiving end', async () => {
       const child = utilityProcess.fork(path.join(fixturesPath, 'post-message-queue.js'));
       const p = once(child, 'spawn');
@@ -3,6 +3,7 @@ import { AddressInfo } from 'node:net';
 import * as path from 'node:path';
 import * as fs from 'node:fs';
 import * as http from 'node:http';
+import { pathToFileURL } from 'node:url';
 import { BrowserWindow, ipcMain, webContents, session, app, BrowserView } from 'electron/main';
 import { closeAllWindows } from './lib/window-helpers';
 import { ifdescribe, defer, waitUntil, listen, ifit } from './lib/spec-helpers';
@@ -1632,6 +1633,36 @@ describe('webContents module', () => {
     });
   });
 
+  describe('getIPCMetrics()', () => {
+    afterEach(closeAllWindows);
+    it('counts messages and reply latency by channel', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.webContents.loadURL('about:blank');
+      w.webContents.ipc.handle('metrics-invoke', () => 'ok');
+      w.webContents.ipc.on('metrics-sync', (event) => { event.returnValue = 'ok'; });
+      await w.webContents.executeJavaScript(`(${async function () {
+        const { ipcRenderer } = require('electron');
+        for (let i = 0; i < 3; i++) ipcRenderer.send('metrics-send', 'x'.repeat(1000));
+        await ipcRenderer.invoke('metrics-invoke');
+        ipcRenderer.sendSync('metrics-sync');
+      }})()`);
+
+      const metrics = w.webContents.getIPCMetrics();
+      const byChannel = (channel: string) => metrics.find(m => m.channel === channel && !m.internal)!;
+      expect(byChannel('metrics-send').count).to.equal(3);
+      expect(byChannel('metrics-send').bytes).to.be.at.least(3000);
+      expect(byChannel('metrics-invoke').invoke.count).to.equal(1);
+      expect(byChannel('metrics-sync').sync.count).to.equal(1);
+      const { sync } = byChannel('metrics-sync');
+      expect(sync.buckets.reduce((sum, bucket) => sum + bucket.count, 0)).to.equal(1);
+      expect(sync.buckets[sync.buckets.length - 1].max).to.equal(Infinity);
+      expect(sync.max).to.be.at.most(sync.total);
+
+      w.webContents.clearIPCMetrics();
+      expect(w.webContents.getIPCMetrics().filter(m => m.channel.startsWith('metrics-'))).to.be.empty();
+    });
+  });
+
   describe('referrer', () => {
     afterEach(closeAllWindows);
     it('propagates referrer information to new target=_blank windows', (done) => {
@@ -1768,6 +1799,56 @@ describe('webContents module', () => {
     generateSpecs('with sandbox', true);
   });
 
+  describe('preload-code-cache event', () => {
+    const preload = path.join(fixturesPath, 'module', 'preload-eventemitter.js');
+    const pageUrl = pathToFileURL(path.join(fixturesPath, 'pages', 'blank.html')).href;
+    let ses: Electron.Session;
+    let cacheDir: string;
+
+    beforeEach(() => {
+      ses = session.fromPartition(`persist:preload-code-cache-${Math.random()}`);
+      const codeCachePath = fs.mkdtempSync(path.join(app.getPath('temp'), 'electron-preload-code-cache-'));
+      defer(() => fs.rmSync(codeCachePath, { recursive: true, force: true }));
+      ses.setCodeCachePath(codeCachePath);
+      cacheDir = path.join(codeCachePath, 'preload');
+    });
+    afterEach(closeAllWindows);
+
+    const loadPreload = async (loadUrl: string) => {
+      const w = new BrowserWindow({ show: false, webPreferences: { sandbox: true, session: ses, preload } });
+      const promise = once(w.webContents, 'preload-code-cache');
+      w.loadURL(loadUrl);
+      const [, preloadPath, result] = await promise;
+      expect(preloadPath).to.equal(preload);
+      return result;
+    };
+    const waitForCache = () => waitUntil(() => fs.existsSync(cacheDir) && fs.readdirSync(cacheDir).some(name => !name.endsWith('.tmp')));
+
+    it('reports a miss and then a hit for the same preload script', async () => {
+      expect(await loadPreload(pageUrl)).to.equal('miss');
+      await waitForCache();
+      expect(await loadPreload(pageUrl)).to.equal('hit');
+    });
+
+    it('does not share caches between sites', async () => {
+      const server = http.createServer((req, res) => { res.end('<html></html>'); });
+      defer(() => server.close());
+      const { port } = await listen(server);
+      expect(await loadPreload(`http://127.0.0.1:${port}`)).to.equal('miss');
+      await waitForCache();
+      expect(await loadPreload(`http://localhost:${port}`)).to.equal('miss');
+      expect(await loadPreload(`http://127.0.0.1:${port}`)).to.equal('hit');
+    });
+
+    it('is removed by ses.clearCodeCaches()', async () => {
+      expect(await loadPreload(pageUrl)).to.equal('miss');
+      await waitForCache();
+      await ses.clearCodeCaches({});
+      expect(fs.existsSync(cacheDir)).to.be.false('cache dir exists');
+      expect(await loadPreload(pageUrl)).to.equal('miss');
+    });
+  });
+
   describe('takeHeapSnapshot()', () => {
     afterEach(closeAllWindows);
 
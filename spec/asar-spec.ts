@@ -1,9 +1,12 @@
 import { expect } from 'chai';
+import * as cp from 'node:child_process';
+import * as os from 'node:os';
 import * as path from 'node:path';
 import * as url from 'node:url';
 import { Worker } from 'node:worker_threads';
-import { BrowserWindow, ipcMain } from 'electron/main';
+import { BrowserWindow, ipcMain, net, utilityProcess } from 'electron/main';
 import { closeAllWindows } from './lib/window-helpers';
+import { compileBinaryIndex, readAsarHeader, writeAsarWithBinaryIndex } from './lib/asar-helpers';
 import { getRemoteContext, ifdescribe, ifit, itremote, useRemoteContext } from './lib/spec-helpers';
 import * as importedFs from 'node:fs';
 import { once } from 'node:events';
@@ -82,6 +85,20 @@ describe('asar package', () => {
         throw new Error(error);
       }
     });
+
+    it('serves several byte ranges as multipart/byteranges', async () => {
+      const fileUrl = url.pathToFileURL(path.join(asarDir, 'a.asar', 'file3')).toString();
+      const response = await net.fetch(fileUrl, { headers: { Range: 'bytes=0-1,4-5' } });
+      expect(response.status).to.equal(206);
+      const contentType = response.headers.get('content-type')!;
+      expect(contentType).to.match(/^multipart\/byteranges; boundary=/);
+      const boundary = contentType.split('boundary=')[1];
+      const parts = (await response.text()).split(`--${boundary}`);
+      expect(parts).to.have.lengthOf(4);
+      expect(parts[1]).to.include('Content-Range: bytes 0-1/6').and.match(/\r\n\r\nfi\r\n$/);
+      expect(parts[2]).to.include('Content-Range: bytes 4-5/6').and.match(/\r\n\r\n3\n\r\n$/);
+      expect(parts[3]).to.equal('--\r\n');
+    });
   });
 
   describe('worker', () => {
@@ -127,6 +144,152 @@ describe('asar package', () => {
       });
     });
   });
+
+  describe('header index', () => {
+    const { Archive } = process._linkedBinding('electron_common_asar');
+
+    it('resolves files, links and directories', () => {
+      const archive = new Archive(path.join(asarDir, 'a.asar'));
+      expect(archive.getFileInfo('file1')).to.have.property('size').that.is.a('number');
+      expect(archive.stat('dir1')).to.have.property('isDirectory', true);
+      expect(archive.stat('link1')).to.have.property('isLink', true);
+      expect(archive.getFileInfo('link1')).to.deep.equal(archive.getFileInfo('file1'));
+      expect(archive.readdir('link2')).to.deep.equal(archive.readdir(archive.realpath('link2') as string));
+      expect(archive.getFileInfo('not-exist')).to.be.false();
+    });
+
+    it('serves packed files from a memory mapping with --asar-mmap', () => {
+      const appPath = path.join(fixtures, 'apps', 'asar-mmap', 'main.js');
+      const { stdout } = cp.spawnSync(process.execPath, [appPath, path.join(asarDir, 'a.asar'), '--asar-mmap']);
+      expect(JSON.parse(stdout.toString())).to.deep.equal({
+        utf8: 'file1',
+        buffer: 'file2',
+        mapped: 'file3\n'
+      });
+    });
+
+    it('does not map archives by default', () => {
+      const archive = new Archive(path.join(asarDir, 'a.asar'));
+      expect(archive.readMappedFile('file1', true)).to.be.false();
+    });
+
+    describe('binary index', () => {
+      const source = path.join(asarDir, 'a.asar');
+      let tmpDir: string;
+      let renamedHeader: any;
+
+      before(() => {
+        tmpDir = importedFs.mkdtempSync(path.join(os.tmpdir(), 'electron-asar-index-'));
+        // Compile the index from a header with a renamed file, to tell which
+        // of the two headers was read.
+        renamedHeader = readAsarHeader(source).header;
+        renamedHeader.files['binary-only'] = renamedHeader.files.file2;
+        delete renamedHeader.files.file2;
+      });
+
+      after(() => {
+        importedFs.rmSync(tmpDir, { recursive: true, force: true });
+      });
+
+      it('is used instead of the JSON header when present', () => {
+        const archivePath = path.join(tmpDir, 'valid.asar');
+        writeAsarWithBinaryIndex(source, archivePath, compileBinaryIndex(renamedHeader));
+
+        const archive = new Archive(archivePath);
+        expect(archive.getFileInfo('file2')).to.be.false();
+        expect(archive.getFileInfo('binary-only')).to.have.property('size', 6);
+        expect(archive.readdir('link2')).to.deep.equal(['file1', 'file2', 'file3', 'link1', 'link2']);
+        expect(importedFs.readFileSync(path.join(archivePath, 'binary-only'), 'utf8')).to.equal('file2\n');
+        expect(importedFs.readFileSync(path.join(archivePath, 'link2', 'file3'), 'utf8')).to.equal('file3\n');
+      });
+
+      it('falls back to the JSON header when the index is invalid', () => {
+        const archivePath = path.join(tmpDir, 'invalid.asar');
+        const index = compileBinaryIndex(renamedHeader);
+        // Point the root directory's children past the end of the node table.
+        index.writeUInt32LE(index.readUInt32LE(12), 32 + 24);
+        writeAsarWithBinaryIndex(source, archivePath, index);
+
+        const archive = new Archive(archivePath);
+        expect(archive.getFileInfo('binary-only')).to.be.false();
+        expect(importedFs.readFileSync(path.join(archivePath, 'file2'), 'utf8')).to.equal('file2\n');
+      });
+
+      it('falls back to the JSON header for unknown versions', () => {
+        const archivePath = path.join(tmpDir, 'future.asar');
+        const index = compileBinaryIndex(renamedHeader);
+        index.writeUInt32LE(2, 8);
+        writeAsarWithBinaryIndex(source, archivePath, index);
+
+        const archive = new Archive(archivePath);
+        expect(archive.getFileInfo('binary-only')).to.be.false();
+        expect(archive.getFileInfo('file2')).to.have.property('size', 6);
+      });
+    });
+
+    it('counts lookups and misses', () => {
+      const archive = new Archive(path.join(asarDir, 'a.asar'));
+      const before = archive.getLookupStats();
+      if (!before) throw new Error('archive has no index');
+      archive.getFileInfo('file1');
+      archive.getFileInfo('not-exist');
+      expect(archive.getLookupStats()).to.deep.equal({
+        lookups: before.lookups + 2,
+        misses: before.misses + 1
+      });
+    });
+
+    it('splits paths the same way when they are cached', () => {
+      const { splitPath } = process._linkedBinding('electron_common_asar');
+      const archivePath = path.join(asarDir, 'a.asar');
+      const cases = [
+        [path.join(archivePath, 'dir1', 'file1'), { isAsar: true, asarPath: archivePath, filePath: path.join('dir1', 'file1') }],
+        [archivePath, { isAsar: true, asarPath: archivePath, filePath: '' }],
+        [path.join(fixtures, 'module', 'asar.js'), { isAsar: false }],
+        [path.join(asarDir, 'unpack.asar.unpacked', 'a.txt'), { isAsar: false }]
+      ] as const;
+      for (let i = 0; i < 2; i++) {
+        for (const [fullPath, expected] of cases) {
+          expect(splitPath(fullPath)).to.deep.equal(expected);
+        }
+      }
+    });
+
+    describe('shared with child processes', () => {
+      const archivePath = path.join(asarDir, 'a.asar');
+
+      before(() => {
+        // Child processes are handed the archives the browser has opened.
+        expect(new Archive(archivePath).hasSharedIndex()).to.be.false();
+      });
+
+      it('is attached to by utility processes', async () => {
+        const child = utilityProcess.fork(path.join(fixtures, 'api', 'utility-process', 'asar-index.js'), [archivePath]);
+        const [data] = await once(child, 'message');
+        expect(data).to.deep.equal({
+          shared: true,
+          files: new Archive(archivePath).readdir('')
+        });
+      });
+
+      it('is attached to by renderer processes', async () => {
+        const w = new BrowserWindow({
+          show: false,
+          webPreferences: { nodeIntegration: true, contextIsolation: false }
+        });
+        await w.loadURL('about:blank');
+        const result = await w.webContents.executeJavaScript(`(() => {
+          const { Archive } = process._linkedBinding('electron_common_asar');
+          const archive = new Archive(${JSON.stringify(archivePath)});
+          return { shared: archive.hasSharedIndex(), files: archive.readdir('') };
+        })()`);
+        expect(result).to.deep.equal({
+          shared: true,
+          files: new Archive(archivePath).readdir('')
+        });
+      });
+    });
+  });
 });
 
 // eslint-disable-next-line @typescript-eslint/no-unused-vars
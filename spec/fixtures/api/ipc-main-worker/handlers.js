@@ -0,0 +1,13 @@
+const { isMainThread, threadId } = require('node:worker_threads');
+
+exports['worker-info'] = (event, arg) => ({ isMainThread, threadId, channel: event.channel, senderId: event.senderId, arg });
+
+exports['worker-busy'] = (event, ms) => {
+  const end = Date.now() + ms;
+  while (Date.now() < end);
+  return ms;
+};
+
+exports['worker-error'] = async () => {
+  throw new Error('some worker error');
+};
@@ -0,0 +1,7 @@
+const { Archive } = process._linkedBinding('electron_common_asar');
+
+const archive = new Archive(process.argv[2]);
+process.parentPort.postMessage({
+  shared: archive.hasSharedIndex(),
+  files: archive.readdir('')
+});
@@ -0,0 +1,11 @@
+const { sharedRingBuffer } = require('electron');
+
+process.parentPort.once('message', (e) => {
+  const ring = e.data;
+  const [port] = e.ports;
+  ring.setWakeUpHandler(() => port.postMessage(null));
+  for (let i = 0; i < 100; i++) {
+    ring.write(new Uint32Array([i]));
+  }
+  process.parentPort.postMessage(typeof sharedRingBuffer.create);
+});
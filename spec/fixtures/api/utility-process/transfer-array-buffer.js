@@ -0,0 +1,5 @@
+process.parentPort.on('message', (e) => {
+  const buffer = e.data;
+  process.parentPort.postMessage({ buffer }, [buffer]);
+  process.parentPort.postMessage({ detached: buffer.byteLength === 0 });
+});
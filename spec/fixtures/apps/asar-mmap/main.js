@@ -0,0 +1,15 @@
+const { app } = require('electron');
+const fs = require('node:fs');
+const path = require('node:path');
+
+const asarPath = process.argv[2];
+const { Archive } = process._linkedBinding('electron_common_asar');
+
+const result = {
+  utf8: fs.readFileSync(path.join(asarPath, 'file1'), 'utf8').trim(),
+  buffer: fs.readFileSync(path.join(asarPath, 'link2', 'file2')).toString().trim(),
+  mapped: new Archive(asarPath).readMappedFile('file3', true)
+};
+
+process.stdout.write(JSON.stringify(result));
+app.quit();
@@ -0,0 +1,65 @@
+// Measures how many ipcRenderer.send() messages the main process dispatches
+// per second when the renderer sends them all from one task, which coalesces
+// them into batches, and when it sends each from a task of its own.
+//
+// Usage: electron main.js [count]
+const { app, BrowserWindow, ipcMain } = require('electron');
+
+const count = Number(process.argv[2]) || 100000;
+
+const run = async (contents, mode) => {
+  let received = 0;
+  let inOrder = true;
+  const done = new Promise(resolve => {
+    const listener = (event, i) => {
+      if (i !== received) inOrder = false;
+      if (++received === count) {
+        ipcMain.removeListener('throughput', listener);
+        resolve();
+      }
+    };
+    ipcMain.on('throughput', listener);
+  });
+
+  const cpuUsage = process.cpuUsage();
+  const start = process.hrtime.bigint();
+  contents.executeJavaScript(`sendMessages(${JSON.stringify(mode)}, ${count})`);
+  await done;
+  const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+  const { user, system } = process.cpuUsage(cpuUsage);
+
+  return {
+    inOrder,
+    messagesPerSecond: Math.round(count / seconds),
+    mainCpuMicrosPerMessage: (user + system) / count
+  };
+};
+
+app.whenReady().then(async () => {
+  const w = new BrowserWindow({
+    show: false,
+    webPreferences: { nodeIntegration: true, contextIsolation: false }
+  });
+  await w.loadURL('about:blank');
+  await w.webContents.executeJavaScript(`{
+    const { ipcRenderer } = require('electron');
+    const nextTask = () => new Promise(resolve => {
+      const { port1, port2 } = new MessageChannel();
+      port1.onmessage = resolve;
+      port2.postMessage(null);
+    });
+    window.sendMessages = async (mode, count) => {
+      for (let i = 0; i < count; i++) {
+        ipcRenderer.send('throughput', i);
+        if (mode === 'unbatched') await nextTask();
+      }
+    };
+  }`);
+
+  const result = {
+    unbatched: await run(w.webContents, 'unbatched'),
+    batched: await run(w.webContents, 'batched')
+  };
+  process.stdout.write(JSON.stringify(result));
+  app.quit();
+});
@@ -0,0 +1,3 @@
+const { contextBridge, ipcRenderer } = require('electron');
+
+contextBridge.exposeInMainWorld('isolatedSend', (value) => ipcRenderer.send('message', value));
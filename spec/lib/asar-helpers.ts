@@ -0,0 +1,163 @@
+import * as fs from 'node:fs';
+
+const INVALID_NODE = 0xffffffff;
+
+enum NodeType {
+  File = 0,
+  Directory = 1,
+  Link = 2
+}
+
+type HeaderNode = {
+  files?: Record<string, HeaderNode>;
+  link?: string;
+  size?: number;
+  offset?: string;
+  unpacked?: boolean;
+  executable?: boolean;
+};
+
+type IndexNode = {
+  type: NodeType;
+  path: string;
+  name: string;
+  firstChild: number;
+  childCount: number;
+  link: string;
+  linkTarget: number;
+  dict: HeaderNode;
+};
+
+const align4 = (n: number) => (n + 3) & ~3;
+
+/**
+ * Reads the JSON header of an asar archive, along with the offset at which the
+ * file data starts.
+ */
+export const readAsarHeader = (archivePath: string) => {
+  const data = fs.readFileSync(archivePath);
+  const headerPickleSize = data.readUInt32LE(4);
+  const headerLength = data.readUInt32LE(12);
+  const header = JSON.parse(data.subarray(16, 16 + headerLength).toString('utf8'));
+  return { header, dataOffset: 8 + headerPickleSize, data };
+};
+
+/**
+ * Compiles a JSON asar header into the binary index format described in
+ * docs/tutorial/asar-archives.md, laid out the same way Electron does.
+ */
+export const compileBinaryIndex = (header: HeaderNode): Buffer => {
+  const nodes: IndexNode[] = [{
+    type: NodeType.Directory, path: '', name: '', firstChild: 0, childCount: 0, link: '', linkTarget: INVALID_NODE, dict: header
+  }];
+
+  const addChildren = (parent: number) => {
+    const files = nodes[parent].dict.files!;
+    const names = Object.keys(files).sort((a, b) => Buffer.compare(Buffer.from(a), Buffer.from(b)));
+    nodes[parent].firstChild = nodes.length;
+    nodes[parent].childCount = names.length;
+    for (const name of names) {
+      const dict = files[name];
+      const type = typeof dict.link === 'string' ? NodeType.Link : dict.files ? NodeType.Directory : NodeType.File;
+      const parentPath = nodes[parent].path;
+      nodes.push({
+        type, name, dict, firstChild: 0, childCount: 0, link: dict.link ?? '', linkTarget: INVALID_NODE,
+        path: parentPath ? `${parentPath}/${name}` : name
+      });
+    }
+    const { firstChild, childCount } = nodes[parent];
+    for (let i = firstChild; i < firstChild + childCount; i++) {
+      if (nodes[i].type === NodeType.Directory) addChildren(i);
+    }
+  };
+  if (header.files) addChildren(0);
+
+  const findChild = (dir: number, name: string): number => {
+    if (name === '') return 0;
+    if (nodes[dir].type === NodeType.Link) dir = nodes[dir].linkTarget;
+    if (dir === INVALID_NODE || nodes[dir].type !== NodeType.Directory) return INVALID_NODE;
+    const { firstChild, childCount } = nodes[dir];
+    for (let i = firstChild; i < firstChild + childCount; i++) {
+      if (nodes[i].name === name) return i;
+    }
+    return INVALID_NODE;
+  };
+  const walk = (p: string) => {
+    if (p === '') return 0;
+    let node = 0;
+    for (const component of p.split('/')) {
+      node = findChild(node, component);
+      if (node === INVALID_NODE) break;
+    }
+    return node;
+  };
+  // Resolved in node order, which is enough for links that do not go through
+  // other links.
+  for (const node of nodes) {
+    if (node.type === NodeType.Link) node.linkTarget = walk(node.link);
+  }
+
+  let strings = '';
+  const addString = (str: string) => {
+    const offset = Buffer.byteLength(strings);
+    strings += str;
+    return [offset, Buffer.byteLength(str)];
+  };
+
+  const records = Buffer.alloc(nodes.length * 56);
+  nodes.forEach((node, i) => {
+    const record = records.subarray(i * 56, (i + 1) * 56);
+    const [pathOffset, pathLength] = addString(node.path);
+    const nameOffset = pathLength - Buffer.byteLength(node.name);
+    const [linkOffset, linkLength] = node.type === NodeType.Link ? addString(node.link) : [0, 0];
+    const { dict } = node;
+    let flags = 0;
+    if (node.type === NodeType.File && typeof dict.size === 'number') {
+      if (dict.unpacked) flags |= 1 | 2;
+      else if (typeof dict.offset === 'string') flags |= 1;
+      if (dict.executable && !dict.unpacked) flags |= 4;
+    }
+    record.writeBigUInt64LE(BigInt(flags & 1 && !(flags & 2) ? dict.offset! : 0), 0);
+    record.writeUInt32LE(flags & 1 ? dict.size! : 0, 8);
+    [pathOffset, pathLength, nameOffset, node.firstChild, node.childCount, linkOffset, linkLength, node.linkTarget, INVALID_NODE]
+      .forEach((value, j) => record.writeUInt32LE(value, 12 + j * 4));
+    record.writeUInt8(node.type, 48);
+    record.writeUInt8(flags, 49);
+  });
+
+  const stringPool = Buffer.from(strings);
+  const indexHeader = Buffer.alloc(32);
+  indexHeader.write('ASARIDX\0', 0, 'latin1');
+  indexHeader.writeUInt32LE(1, 8);
+  indexHeader.writeUInt32LE(nodes.length, 12);
+  indexHeader.writeUInt32LE(0, 16);
+  indexHeader.writeUInt32LE(0, 20);
+  indexHeader.writeUInt32LE(stringPool.length, 24);
+  return Buffer.concat([indexHeader, records, stringPool]);
+};
+
+/**
+ * Writes a copy of |archivePath| to |outPath| whose header pickle carries
+ * |binaryIndex| after the JSON header.
+ */
+export const writeAsarWithBinaryIndex = (archivePath: string, outPath: string, binaryIndex: Buffer) => {
+  const { header, dataOffset, data } = readAsarHeader(archivePath);
+  const json = Buffer.from(JSON.stringify(header));
+
+  const payload = Buffer.alloc(4 + align4(json.length) + 4 + align4(binaryIndex.length));
+  payload.writeUInt32LE(json.length, 0);
+  json.copy(payload, 4);
+  const indexOffset = 4 + align4(json.length);
+  payload.writeUInt32LE(binaryIndex.length, indexOffset);
+  binaryIndex.copy(payload, indexOffset + 4);
+
+  const headerPickle = Buffer.alloc(4 + payload.length);
+  headerPickle.writeUInt32LE(payload.length, 0);
+  payload.copy(headerPickle, 4);
+
+  const sizePickle = Buffer.alloc(8);
+  sizePickle.writeUInt32LE(4, 0);
+  sizePickle.writeUInt32LE(headerPickle.length, 4);
+
+  fs.writeFileSync(outPath, Buffer.concat([sizePickle, headerPickle, data.subarray(dataOffset)]));
+};
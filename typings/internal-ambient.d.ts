@@ -15,7 +15,7 @@ declare namespace NodeJS {
 
   interface IpcRendererBinding {
     send(internal: boolean, channel: string, args: any[]): void;
-    sendSync(internal: boolean, channel: string, args: any[]): any;
+    sendSync(internal: boolean, channel: string, args: any[], options?: { timeout?: number, priority?: 'normal' | 'high' }): any;
     sendToHost(channel: string, args: any[]): void;
     sendTo(webContentsId: number, channel: string, args: any[]): void;
     invoke<T>(internal: boolean, channel: string, args: any[]): Promise<{ error: string, result: T }>;
@@ -74,6 +74,10 @@ declare namespace NodeJS {
     realpath(path: string): string | false;
     copyFileOut(path: string): string | false;
     getFdAndValidateIntegrityLater(): number | -1;
+    getLookupStats(): { lookups: number; misses: number } | false;
+    readMappedFile(path: string, asString: true): string | false;
+    readMappedFile(path: string, asString: false): Buffer | false;
+    hasSharedIndex(): boolean;
   }
 
   interface AsarBinding {
@@ -204,6 +208,7 @@ declare namespace NodeJS {
     _linkedBinding(name: 'electron_common_environment'): EnvironmentBinding;
     _linkedBinding(name: 'electron_common_features'): FeaturesBinding;
     _linkedBinding(name: 'electron_common_native_image'): { nativeImage: typeof Electron.NativeImage };
+    _linkedBinding(name: 'electron_common_shared_ring_buffer'): { sharedRingBuffer: typeof Electron.SharedRingBuffer };
     _linkedBinding(name: 'electron_common_shell'): Electron.Shell;
     _linkedBinding(name: 'electron_common_v8_util'): V8UtilBinding;
     _linkedBinding(name: 'electron_browser_app'): { app: Electron.App, App: Function };
@@ -55,12 +55,18 @@ declare namespace Electron {
     _removeFromWindow: (win: BrowserWindow) => void;
   }
 
+  interface Session {
+    _getCodeCachePath(): string | null;
+  }
+
   interface WebContents {
     _loadURL(url: string, options: ElectronInternal.LoadURLOptions): void;
     getOwnerBrowserWindow(): Electron.BrowserWindow | null;
     getLastWebPreferences(): Electron.WebPreferences | null;
     _getProcessMemoryInfo(): Electron.ProcessMemoryInfo;
     _getPreloadPaths(): string[];
+    _setInvokeHandlerRegistered(channel: string, registered: boolean): void;
+    _replyToInvoke(id: number, reply: { result: any } | { error: string }): boolean;
     equal(other: WebContents): boolean;
     browserWindowOptions: BrowserWindowConstructorOptions;
     _windowOpenHandler: ((details: Electron.HandlerDetails) => any) | null;
@@ -88,6 +94,8 @@ declare namespace Electron {
     _send(internal: boolean, channel: string, args: any): void;
     _sendInternal(channel: string, ...args: any[]): void;
     _postMessage(channel: string, message: any, transfer?: any[]): void;
+    _setInvokeHandlerRegistered(channel: string, registered: boolean): void;
+    _getProcessLock(): string | null;
   }
 
   interface WebFrame {